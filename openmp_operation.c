@@ -1,18 +1,745 @@
+#define _GNU_SOURCE
 #include <omp.h>
 #include <stdio.h>
 #include <hdf5.h>
 #include <stdlib.h>
 #include <time.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <zlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <getopt.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <linux/futex.h>
+#ifdef H5_HAVE_PARALLEL
+#include <mpi.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-// 配置参数
+// 进度输出开关：机器可读格式写到 stdout 时关闭
+static int verbose_progress = 1;
+#define progress_printf(...) do { if (verbose_progress) printf(__VA_ARGS__); } while (0)
+
+// 配置参数（默认值，可由命令行 --size/--chunk/--datasets 覆盖）
 #define MATRIX_SIZE 10000        // 矩阵大小 (2000x2000 = 400万个double元素，约32MB)
 #define CHUNK_SIZE 500          // 数据块大小
 #define NUM_DATASETS 10          // 数据集数量
+#define OOC_MEMORY_BUDGET_MB 256 // 核外矩阵乘法的分块内存预算 (MB)
+#define LAYOUT_CHUNK_ROWS 500    // 分块压缩布局的分块行数
+#define LAYOUT_CHUNK_COLS 500    // 分块压缩布局的分块列数
+#define TILE_ROWS 256            // tiled 布局（Z-order + 转置副本）的分块行数
+#define TILE_COLS 256            // tiled 布局的分块列数
+#define MANY_DATASET_COUNT 10000 // 海量小数据集模式的数据集数量
+#define MANY_DATASET_SIZE 16     // 海量小数据集模式下每个矩阵的维度
+#define DEFLATE_LEVEL 4          // deflate 压缩级别 (0-9)
+#define USE_SHUFFLE 1            // 压缩前是否做字节 shuffle
+#define PIPELINE_RING_SIZE 3     // 流水线写入的暂存缓冲区个数
+#define GEMM_CHECK_SIZE 1000     // GEMM 正确性校验使用的矩阵大小（与朴素串行乘法对比）
+
+// ===================== 热路径埋点与 trace 导出 =====================
+// 每个线程第一次记录时创建自己的环形缓冲区，并无锁地挂到全局链表上：
+// 只有所属线程写入自己的环与统计，导出/汇总在各线程静止后进行，因此记录路径不需要任何锁。
+// 环满后覆盖最旧的 span（统计直方图不受影响）。关闭时 trace_begin/trace_end 只是一次全局变量判断。
+// 导出格式为 Chrome trace event JSON，可在 chrome://tracing 或 ui.perfetto.dev 中打开。
+
+#define TRACE_RING_SPANS (1u << 16)      // 每线程保留的 span 个数（2 的幂）
+#define TRACE_HIST_BUCKETS 496           // 耗时直方图：每个二次幂区间 8 档
+
+typedef enum {
+    TRACE_H5_FILE_CREATE, TRACE_H5_FILE_OPEN, TRACE_H5_FILE_CLOSE,
+    TRACE_H5_DSET_CREATE, TRACE_H5_DSET_OPEN, TRACE_H5_DSET_CLOSE,
+    TRACE_H5_READ, TRACE_H5_WRITE, TRACE_H5_WRITE_CHUNK, TRACE_H5_READ_CHUNK, TRACE_H5_CALLBACK,
+    TRACE_IO_WAIT,          // 计算线程等待 I/O 线程完成请求
+    TRACE_INIT, TRACE_GEMM_BLOCK, TRACE_ENCODE, TRACE_DECODE, TRACE_CHECKSUM,
+    TRACE_PRODUCE, TRACE_REGION_READ, TRACE_TASK, TRACE_EXPR,
+    TRACE_OP_COUNT
+} trace_op_t;
+
+static const char *const trace_op_names[TRACE_OP_COUNT] = {
+    "H5Fcreate", "H5Fopen", "H5Fclose", "H5Dcreate", "H5Dopen", "H5Dclose",
+    "H5Dread", "H5Dwrite", "H5Dwrite_chunk", "H5Dread_chunk", "io_callback",
+    "io_wait", "init", "gemm_block", "encode_chunk", "decode_chunk", "checksum",
+    "produce_block", "region_read", "task", "expr_block"
+};
+
+typedef struct {
+    uint64_t t0, t1;        // 单调时钟 (ns)
+    uint64_t bytes;
+    uint32_t op;
+} trace_span_t;
+
+typedef struct {
+    uint64_t count, total_ns, min_ns, max_ns, bytes;
+    uint64_t hist[TRACE_HIST_BUCKETS];
+} trace_op_stats_t;
+
+typedef struct trace_ring {
+    struct trace_ring *next;            // 全局链表
+    int id;
+    char name[32];
+    atomic_uint_fast64_t head;          // 已写入的 span 总数
+    trace_span_t spans[TRACE_RING_SPANS];
+    trace_op_stats_t stats[TRACE_OP_COUNT];
+} trace_ring_t;
+
+static int trace_enabled = 0;
+static uint64_t trace_epoch;
+static trace_ring_t *_Atomic trace_rings = NULL;
+static atomic_int trace_ring_count = 0;
+static __thread trace_ring_t *trace_local = NULL;
+
+static inline uint64_t trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int trace_bucket(uint64_t ns) {
+    if (ns < 8)
+        return (int)ns;
+    int lg = 63 - __builtin_clzll(ns);
+    return 8 * (lg - 2) + (int)((ns >> (lg - 3)) & 7);
+}
+
+static uint64_t trace_bucket_floor(int b) {
+    if (b < 8)
+        return (uint64_t)b;
+    int lg = b / 8 + 2;
+    return (uint64_t)(8 + b % 8) << (lg - 3);
+}
+
+static trace_ring_t *trace_ring_get(void) {
+    trace_ring_t *ring = trace_local;
+    if (ring)
+        return ring;
+    ring = (trace_ring_t*)calloc(1, sizeof(trace_ring_t));
+    if (!ring)
+        return NULL;
+    ring->id = atomic_fetch_add(&trace_ring_count, 1);
+    // 未命名的线程（OpenMP 工作线程）按创建顺序编号
+    snprintf(ring->name, sizeof(ring->name), "worker-%d", ring->id);
+    for (int op = 0; op < TRACE_OP_COUNT; op++)
+        ring->stats[op].min_ns = UINT64_MAX;
+    ring->next = atomic_load(&trace_rings);
+    while (!atomic_compare_exchange_weak(&trace_rings, &ring->next, ring))
+        ;
+    trace_local = ring;
+    return ring;
+}
+
+/**
+ * 为当前线程命名（显示在 trace 的线程轨道上）
+ */
+void trace_set_thread_name(const char *name) {
+    trace_ring_t *ring;
+    if (trace_enabled && (ring = trace_ring_get()))
+        snprintf(ring->name, sizeof(ring->name), "%s", name);
+}
+
+static void trace_record(trace_op_t op, uint64_t t0, uint64_t t1, uint64_t bytes) {
+    trace_ring_t *ring = trace_ring_get();
+    if (!ring)
+        return;
+    uint64_t h = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    trace_span_t *sp = &ring->spans[h & (TRACE_RING_SPANS - 1)];
+    sp->t0 = t0;
+    sp->t1 = t1;
+    sp->bytes = bytes;
+    sp->op = op;
+    atomic_store_explicit(&ring->head, h + 1, memory_order_release);
+
+    uint64_t d = t1 - t0;
+    trace_op_stats_t *st = &ring->stats[op];
+    st->count++;
+    st->total_ns += d;
+    st->bytes += bytes;
+    if (d < st->min_ns) st->min_ns = d;
+    if (d > st->max_ns) st->max_ns = d;
+    st->hist[trace_bucket(d)]++;
+}
+
+// 开始一个 span：关闭时返回 0，不读时钟
+static inline uint64_t trace_begin(void) {
+    return __builtin_expect(trace_enabled, 0) ? trace_now() : 0;
+}
+
+// 结束一个 span，bytes 为该操作搬运的字节数
+static inline void trace_end(trace_op_t op, uint64_t t0, uint64_t bytes) {
+    if (__builtin_expect(trace_enabled, 0))
+        trace_record(op, t0, trace_now(), bytes);
+}
+
+void trace_start(void) {
+    trace_epoch = trace_now();
+    trace_enabled = 1;
+}
+
+static uint64_t trace_hist_percentile(const uint64_t *hist, uint64_t count, double q) {
+    uint64_t target = (uint64_t)ceil(q * count), seen = 0;
+    for (int b = 0; b < TRACE_HIST_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen >= target && hist[b])
+            return trace_bucket_floor(b);
+    }
+    return 0;
+}
+
+/**
+ * 汇总所有线程的统计并打印每种操作的耗时分布与吞吐
+ * 需在所有被埋点的线程静止后调用
+ */
+void trace_report(void) {
+    trace_op_stats_t total[TRACE_OP_COUNT];
+    memset(total, 0, sizeof(total));
+    for (int op = 0; op < TRACE_OP_COUNT; op++)
+        total[op].min_ns = UINT64_MAX;
+    for (trace_ring_t *r = atomic_load(&trace_rings); r; r = r->next) {
+        for (int op = 0; op < TRACE_OP_COUNT; op++) {
+            const trace_op_stats_t *s = &r->stats[op];
+            total[op].count += s->count;
+            total[op].total_ns += s->total_ns;
+            total[op].bytes += s->bytes;
+            if (s->min_ns < total[op].min_ns) total[op].min_ns = s->min_ns;
+            if (s->max_ns > total[op].max_ns) total[op].max_ns = s->max_ns;
+            for (int b = 0; b < TRACE_HIST_BUCKETS; b++)
+                total[op].hist[b] += s->hist[b];
+        }
+    }
+
+    printf("\n=== 热路径剖析 (%d 个线程) ===\n", atomic_load(&trace_ring_count));
+    printf("%-15s %9s %11s %10s %10s %10s %10s %10s\n", "操作", "次数", "总耗时(ms)",
+           "均值(us)", "p50(us)", "p99(us)", "最大(us)", "MB/s");
+    for (int op = 0; op < TRACE_OP_COUNT; op++) {
+        const trace_op_stats_t *s = &total[op];
+        if (!s->count)
+            continue;
+        printf("%-15s %9llu %11.3f %10.2f %10.2f %10.2f %10.2f", trace_op_names[op],
+               (unsigned long long)s->count, s->total_ns / 1e6, s->total_ns / 1e3 / s->count,
+               trace_hist_percentile(s->hist, s->count, 0.50) / 1e3,
+               trace_hist_percentile(s->hist, s->count, 0.99) / 1e3, s->max_ns / 1e3);
+        if (s->bytes)
+            printf(" %10.2f\n", s->bytes / (1024.0 * 1024.0) / (s->total_ns / 1e9));
+        else
+            printf(" %10s\n", "-");
+    }
+    printf("=============================\n\n");
+}
+
+/**
+ * 导出 Chrome/Perfetto trace JSON（每个线程一条轨道，span 为 "X" 完整事件）
+ * 需在所有被埋点的线程静止后调用
+ *
+ * @return 0 成功，-1 失败
+ */
+int trace_export(const char *filename) {
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        printf("Error: Failed to open trace file %s\n", filename);
+        return -1;
+    }
+    int first = 1;
+    uint64_t dropped = 0;
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (trace_ring_t *r = atomic_load(&trace_rings); r; r = r->next) {
+        fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                     "\"args\": {\"name\": \"%s\"}}", first ? "" : ",\n", r->id, r->name);
+        first = 0;
+        uint64_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+        uint64_t begin = head > TRACE_RING_SPANS ? head - TRACE_RING_SPANS : 0;
+        dropped += begin;
+        for (uint64_t k = begin; k < head; k++) {
+            const trace_span_t *sp = &r->spans[k & (TRACE_RING_SPANS - 1)];
+            fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                         "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"bytes\": %llu}}",
+                    trace_op_names[sp->op], r->id, (sp->t0 - trace_epoch) / 1e3,
+                    (sp->t1 - sp->t0) / 1e3, (unsigned long long)sp->bytes);
+        }
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    progress_printf("Trace 已写入 %s%s\n", filename, dropped ? "（部分线程的环已回绕，最早的 span 被覆盖）" : "");
+    return 0;
+}
+
+// ===================== 缓冲池 =====================
+// 矩阵缓冲区与各阶段的暂存缓冲区（GEMM 打包、压缩/解压、流水线环形缓冲、核外分块）统一从这里申请。
+// 释放的块按大小档缓存，后续阶段申请同一档时直接复用，省去 mmap/munmap 与重新缺页的开销。
+// 小块用 64 字节对齐的 posix_memalign，不小于 POOL_MMAP_THRESHOLD 的块用匿名 mmap（页对齐）。
+// 惰性清零：需要清零的大块不做 memset，而是用 MADV_DONTNEED 交还物理页，下次触碰时由内核提供全零页。
+
+#define POOL_MMAP_THRESHOLD (256u << 10)  // 不小于该大小的块用 mmap 分配
+#define POOL_MAX_CACHED 64                 // 缓存的空闲块个数上限
+#define POOL_CACHE_LIMIT_MB 2048           // 缓存的空闲块总大小上限 (MB)
+
+typedef struct {
+    void *ptr;
+    size_t size;                 // 所属大小档（实际分配的字节数）
+} pool_block_t;
+
+typedef struct {
+    size_t requests;             // 申请次数
+    size_t reuses;               // 命中缓存的次数
+    size_t mapped_bytes;         // 当前从系统申请的总字节数（含缓存）
+    size_t peak_mapped_bytes;    // mapped_bytes 的峰值
+    size_t cached_bytes;         // 当前缓存的空闲块总字节数
+} pool_stats_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pool_block_t cached[POOL_MAX_CACHED];
+    int ncached;
+    pool_stats_t stats;
+} buffer_pool = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// 惰性清零开关（--lazy-zero）
+static int pool_lazy_zero = 0;
+
+/**
+ * 计算大小档：64 字节以内为一档，之后每个二次幂区间分 4 档；mmap 档再向上取整到页
+ */
+static size_t pool_class_size(size_t bytes) {
+    if (bytes <= 64)
+        return 64;
+    int lg = 63 - __builtin_clzll((unsigned long long)(bytes - 1));
+    size_t step = (size_t)1 << (lg - 2);
+    size_t size = (bytes + step - 1) & ~(step - 1);
+    if (size >= POOL_MMAP_THRESHOLD) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size = (size + page - 1) & ~(page - 1);
+    }
+    return size;
+}
+
+static void pool_release_block(void *ptr, size_t size) {
+    if (size >= POOL_MMAP_THRESHOLD)
+        munmap(ptr, size);
+    else
+        free(ptr);
+}
+
+/**
+ * 从缓冲池申请至少 bytes 字节、64 字节对齐的缓冲区
+ * 复用的块内容未定义；新映射的 mmap 块为全零
+ * 用 pool_free 归还（需传入相同的 bytes）
+ *
+ * @return 缓冲区指针，失败返回 NULL
+ */
+void *pool_alloc(size_t bytes) {
+    size_t size = pool_class_size(bytes);
+    void *ptr = NULL;
+
+    pthread_mutex_lock(&buffer_pool.lock);
+    buffer_pool.stats.requests++;
+    for (int i = buffer_pool.ncached - 1; i >= 0; i--) {
+        if (buffer_pool.cached[i].size == size) {
+            ptr = buffer_pool.cached[i].ptr;
+            buffer_pool.cached[i] = buffer_pool.cached[--buffer_pool.ncached];
+            buffer_pool.stats.cached_bytes -= size;
+            buffer_pool.stats.reuses++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&buffer_pool.lock);
+    if (ptr)
+        return ptr;
+
+    if (size >= POOL_MMAP_THRESHOLD) {
+        ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED)
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        if (size >= (2u << 20))
+            madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    } else if (posix_memalign(&ptr, 64, size) != 0) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&buffer_pool.lock);
+    buffer_pool.stats.mapped_bytes += size;
+    if (buffer_pool.stats.mapped_bytes > buffer_pool.stats.peak_mapped_bytes)
+        buffer_pool.stats.peak_mapped_bytes = buffer_pool.stats.mapped_bytes;
+    pthread_mutex_unlock(&buffer_pool.lock);
+    return ptr;
+}
+
+/**
+ * 归还缓冲区；缓存已满或超过 POOL_CACHE_LIMIT_MB 时直接还给系统
+ */
+void pool_free(void *ptr, size_t bytes) {
+    if (!ptr)
+        return;
+    size_t size = pool_class_size(bytes);
+    int cached = 0;
+
+    pthread_mutex_lock(&buffer_pool.lock);
+    if (buffer_pool.ncached < POOL_MAX_CACHED &&
+        buffer_pool.stats.cached_bytes + size <= (size_t)POOL_CACHE_LIMIT_MB << 20) {
+        buffer_pool.cached[buffer_pool.ncached].ptr = ptr;
+        buffer_pool.cached[buffer_pool.ncached].size = size;
+        buffer_pool.ncached++;
+        buffer_pool.stats.cached_bytes += size;
+        cached = 1;
+    } else {
+        buffer_pool.stats.mapped_bytes -= size;
+    }
+    pthread_mutex_unlock(&buffer_pool.lock);
+
+    if (!cached)
+        pool_release_block(ptr, size);
+}
+
+/**
+ * 惰性清零：mmap 块交还物理页（下次触碰得到全零页），小块直接 memset
+ */
+void pool_discard(void *ptr, size_t bytes) {
+    size_t size = pool_class_size(bytes);
+    if (size >= POOL_MMAP_THRESHOLD)
+        madvise(ptr, size, MADV_DONTNEED);
+    else
+        memset(ptr, 0, bytes);
+}
+
+/**
+ * 把缓存的空闲块全部还给系统
+ */
+void pool_trim(void) {
+    pthread_mutex_lock(&buffer_pool.lock);
+    for (int i = 0; i < buffer_pool.ncached; i++) {
+        pool_release_block(buffer_pool.cached[i].ptr, buffer_pool.cached[i].size);
+        buffer_pool.stats.mapped_bytes -= buffer_pool.cached[i].size;
+    }
+    buffer_pool.ncached = 0;
+    buffer_pool.stats.cached_bytes = 0;
+    pthread_mutex_unlock(&buffer_pool.lock);
+}
+
+// 进程内存占用：峰值常驻集 (KB) 与累计缺页次数
+typedef struct {
+    long peak_rss_kb;
+    long minor_faults, major_faults;
+} mem_usage_t;
+
+static void get_mem_usage(mem_usage_t *u) {
+    struct rusage ru;
+    memset(u, 0, sizeof(*u));
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        u->peak_rss_kb = ru.ru_maxrss;
+        u->minor_faults = ru.ru_minflt;
+        u->major_faults = ru.ru_majflt;
+    }
+}
+
+void print_pool_stats(void) {
+    mem_usage_t u;
+    pool_stats_t s;
+    get_mem_usage(&u);
+    pthread_mutex_lock(&buffer_pool.lock);
+    s = buffer_pool.stats;
+    pthread_mutex_unlock(&buffer_pool.lock);
+    printf("缓冲池统计：\n");
+    printf("  申请次数: %zu (复用 %zu 次, %.1f%%)\n", s.requests, s.reuses,
+           s.requests ? 100.0 * s.reuses / s.requests : 0.0);
+    printf("  映射内存峰值: %.2f MB (当前 %.2f MB, 其中缓存 %.2f MB)\n",
+           s.peak_mapped_bytes / (1024.0 * 1024.0), s.mapped_bytes / (1024.0 * 1024.0),
+           s.cached_bytes / (1024.0 * 1024.0));
+    printf("  峰值常驻内存: %.2f MB\n", u.peak_rss_kb / 1024.0);
+    printf("  缺页次数: minor %ld, major %ld\n", u.minor_faults, u.major_faults);
+    printf("  惰性清零: %s\n", pool_lazy_zero ? "开启" : "关闭");
+}
+
+// ===================== GEMM 计算引擎 =====================
+// 分块结构参考 BLIS/GotoBLAS：
+//   jc 循环按 NC 切分 B 的列面板（L3 驻留），pc 循环按 KC 切分公共维度，
+//   B[pc:pc+KC, jc:jc+NC] 打包成 NR 宽的列条（L2/L3），
+//   ic 循环按 MC 切分 A 的行面板并打包成 MR 高的行条（L2），
+//   最内层由 MR x NR 的寄存器分块微内核完成（L1）。
+// 微内核在运行时根据 CPU 指令集选择 AVX-512 / AVX2+FMA / 标量实现。
+
+typedef void (*gemm_ukernel_fn)(int kc, const double *Ap, const double *Bp,
+                                double *C, int ldc, int mr_eff, int nr_eff);
+
+typedef struct {
+    const char *name;     // 内核名称
+    int mr, nr;           // 寄存器分块大小
+    int mc, kc, nc;       // 缓存分块大小
+    int flops_per_cycle;  // 单核每周期双精度浮点运算数（FMA 计为 2 次）
+    gemm_ukernel_fn ukernel;
+} gemm_kernel_t;
+
+// 将微内核计算结果（MR x NR 的临时块）累加回 C 的有效区域
+static void gemm_store_edge(const double *tmp, int nr, double *C, int ldc,
+                            int mr_eff, int nr_eff) {
+    for (int i = 0; i < mr_eff; i++)
+        for (int j = 0; j < nr_eff; j++)
+            C[i*ldc + j] += tmp[i*nr + j];
+}
+
+// 标量微内核 4x4：任何 CPU 上都可用
+#define GEMM_SCALAR_MR 4
+#define GEMM_SCALAR_NR 4
+static void gemm_ukernel_scalar(int kc, const double *Ap, const double *Bp,
+                                double *C, int ldc, int mr_eff, int nr_eff) {
+    double c[GEMM_SCALAR_MR * GEMM_SCALAR_NR] = {0.0};
+    for (int p = 0; p < kc; p++) {
+        const double *a = Ap + p * GEMM_SCALAR_MR;
+        const double *b = Bp + p * GEMM_SCALAR_NR;
+        for (int i = 0; i < GEMM_SCALAR_MR; i++)
+            for (int j = 0; j < GEMM_SCALAR_NR; j++)
+                c[i*GEMM_SCALAR_NR + j] += a[i] * b[j];
+    }
+    gemm_store_edge(c, GEMM_SCALAR_NR, C, ldc, mr_eff, nr_eff);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 + FMA 微内核 6x8：12 个 ymm 累加器
+__attribute__((target("avx2,fma")))
+static void gemm_ukernel_avx2(int kc, const double *Ap, const double *Bp,
+                              double *C, int ldc, int mr_eff, int nr_eff) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for (int p = 0; p < kc; p++) {
+        __m256d b0 = _mm256_load_pd(Bp + p*8);
+        __m256d b1 = _mm256_load_pd(Bp + p*8 + 4);
+        const double *a = Ap + p*6;
+        __m256d a0 = _mm256_broadcast_sd(a + 0);
+        c00 = _mm256_fmadd_pd(a0, b0, c00); c01 = _mm256_fmadd_pd(a0, b1, c01);
+        __m256d a1 = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(a1, b0, c10); c11 = _mm256_fmadd_pd(a1, b1, c11);
+        __m256d a2 = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(a2, b0, c20); c21 = _mm256_fmadd_pd(a2, b1, c21);
+        __m256d a3 = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(a3, b0, c30); c31 = _mm256_fmadd_pd(a3, b1, c31);
+        __m256d a4 = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(a4, b0, c40); c41 = _mm256_fmadd_pd(a4, b1, c41);
+        __m256d a5 = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(a5, b0, c50); c51 = _mm256_fmadd_pd(a5, b1, c51);
+    }
+    __m256d acc[12] = {c00, c01, c10, c11, c20, c21, c30, c31, c40, c41, c50, c51};
+    if (mr_eff == 6 && nr_eff == 8) {
+        for (int i = 0; i < 6; i++) {
+            double *c = C + i*ldc;
+            _mm256_storeu_pd(c,     _mm256_add_pd(_mm256_loadu_pd(c),     acc[2*i]));
+            _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), acc[2*i + 1]));
+        }
+    } else {
+        double tmp[6*8];
+        for (int i = 0; i < 6; i++) {
+            _mm256_storeu_pd(tmp + i*8,     acc[2*i]);
+            _mm256_storeu_pd(tmp + i*8 + 4, acc[2*i + 1]);
+        }
+        gemm_store_edge(tmp, 8, C, ldc, mr_eff, nr_eff);
+    }
+}
+
+// AVX-512 微内核 8x16：16 个 zmm 累加器
+__attribute__((target("avx512f")))
+static void gemm_ukernel_avx512(int kc, const double *Ap, const double *Bp,
+                                double *C, int ldc, int mr_eff, int nr_eff) {
+    __m512d c[8][2];
+    #pragma GCC unroll 8
+    for (int i = 0; i < 8; i++) {
+        c[i][0] = _mm512_setzero_pd();
+        c[i][1] = _mm512_setzero_pd();
+    }
+    for (int p = 0; p < kc; p++) {
+        __m512d b0 = _mm512_load_pd(Bp + p*16);
+        __m512d b1 = _mm512_load_pd(Bp + p*16 + 8);
+        const double *a = Ap + p*8;
+        #pragma GCC unroll 8
+        for (int i = 0; i < 8; i++) {
+            __m512d ai = _mm512_set1_pd(a[i]);
+            c[i][0] = _mm512_fmadd_pd(ai, b0, c[i][0]);
+            c[i][1] = _mm512_fmadd_pd(ai, b1, c[i][1]);
+        }
+    }
+    if (mr_eff == 8 && nr_eff == 16) {
+        #pragma GCC unroll 8
+        for (int i = 0; i < 8; i++) {
+            double *ci = C + i*ldc;
+            _mm512_storeu_pd(ci,     _mm512_add_pd(_mm512_loadu_pd(ci),     c[i][0]));
+            _mm512_storeu_pd(ci + 8, _mm512_add_pd(_mm512_loadu_pd(ci + 8), c[i][1]));
+        }
+    } else {
+        double tmp[8*16];
+        for (int i = 0; i < 8; i++) {
+            _mm512_storeu_pd(tmp + i*16,     c[i][0]);
+            _mm512_storeu_pd(tmp + i*16 + 8, c[i][1]);
+        }
+        gemm_store_edge(tmp, 16, C, ldc, mr_eff, nr_eff);
+    }
+}
+#endif
+
+static const gemm_kernel_t gemm_kernels[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    {"avx512", 8, 16,  96, 256, 2048, 32, gemm_ukernel_avx512},
+    {"avx2",   6,  8,  72, 256, 4080, 16, gemm_ukernel_avx2},
+#endif
+    {"scalar", GEMM_SCALAR_MR, GEMM_SCALAR_NR, 64, 256, 2048, 2, gemm_ukernel_scalar},
+};
+
+/**
+ * 运行时选择 GEMM 微内核
+ * 环境变量 GEMM_KERNEL=avx512|avx2|scalar 可强制指定（用于对比测试）
+ */
+const gemm_kernel_t *gemm_select_kernel(void) {
+    static const gemm_kernel_t *selected = NULL;
+    if (selected)
+        return selected;
+
+    int nk = (int)(sizeof(gemm_kernels) / sizeof(gemm_kernels[0]));
+    const char *forced = getenv("GEMM_KERNEL");
+    const gemm_kernel_t *k = &gemm_kernels[nk - 1];
+    for (int i = 0; i < nk; i++) {
+        int supported = 1;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (strcmp(gemm_kernels[i].name, "avx512") == 0)
+            supported = __builtin_cpu_supports("avx512f");
+        else if (strcmp(gemm_kernels[i].name, "avx2") == 0)
+            supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        if (!supported)
+            continue;
+        if (forced ? strcmp(forced, gemm_kernels[i].name) == 0 : 1) {
+            k = &gemm_kernels[i];
+            break;
+        }
+    }
+    selected = k;
+    return selected;
+}
+
+// 打包 A[ic:ic+mc, pc:pc+kc]：每 MR 行一个条带，条带内按列连续存放，不足 MR 的行补零
+static void gemm_pack_A(const double *A, int lda, int mc, int kc, int mr, double *Ap) {
+    for (int ir = 0; ir < mc; ir += mr) {
+        int rows = mc - ir < mr ? mc - ir : mr;
+        for (int p = 0; p < kc; p++) {
+            for (int i = 0; i < rows; i++)
+                Ap[p*mr + i] = A[(ir + i)*lda + p];
+            for (int i = rows; i < mr; i++)
+                Ap[p*mr + i] = 0.0;
+        }
+        Ap += (size_t)mr * kc;
+    }
+}
+
+// 打包 B[pc:pc+kc, jc+jr:jc+jr+nr] 的一个列条，不足 NR 的列补零
+static void gemm_pack_B_strip(const double *B, int ldb, int kc, int cols, int nr, double *Bp) {
+    for (int p = 0; p < kc; p++) {
+        const double *b = B + (size_t)p * ldb;
+        for (int j = 0; j < cols; j++)
+            Bp[p*nr + j] = b[j];
+        for (int j = cols; j < nr; j++)
+            Bp[p*nr + j] = 0.0;
+    }
+}
+
+/**
+ * 分块 GEMM：C += A * B（行主序）
+ * A 为 m x k，B 为 k x n，C 为 m x n；lda/ldb/ldc 为行跨度
+ * 在 OpenMP 并行区内按 MC x NC 的宏块划分任务
+ *
+ * @return 0 成功，-1 内存分配失败
+ */
+int gemm_blocked(int m, int n, int k, const double *A, int lda,
+                 const double *B, int ldb, double *C, int ldc) {
+    const gemm_kernel_t *kern = gemm_select_kernel();
+    const int mr = kern->mr, nr = kern->nr;
+    const int MC = kern->mc, KC = kern->kc, NC = kern->nc;
+
+    int nc_max = n < NC ? n : NC;
+    int kc_max = k < KC ? k : KC;
+    size_t bp_elems = (size_t)((nc_max + nr - 1) / nr) * nr * kc_max;
+    double *Bp = (double*)pool_alloc(bp_elems * sizeof(double));
+    if (!Bp)
+        return -1;
+    int failed = 0;
+
+    #pragma omp parallel
+    {
+        size_t ap_bytes = (size_t)(MC + mr) * kc_max * sizeof(double);
+        double *Ap = (double*)pool_alloc(ap_bytes);
+        if (!Ap) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+
+        for (int jc = 0; jc < n; jc += NC) {
+            int nc = n - jc < NC ? n - jc : NC;
+            int n_strips = (nc + nr - 1) / nr;
+            for (int pc = 0; pc < k; pc += KC) {
+                int kc = k - pc < KC ? k - pc : KC;
+
+                // 所有线程协作打包共享的 B 面板
+                #pragma omp for schedule(static)
+                for (int s = 0; s < n_strips; s++) {
+                    int cols = nc - s*nr < nr ? nc - s*nr : nr;
+                    gemm_pack_B_strip(B + (size_t)pc*ldb + jc + s*nr, ldb, kc, cols, nr,
+                                      Bp + (size_t)s * nr * kc);
+                }
+
+                // 按 MC 行宏块划分，每个线程打包自己的 A 面板
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += MC) {
+                    if (!Ap)
+                        continue;
+                    uint64_t t0 = trace_begin();
+                    int mc = m - ic < MC ? m - ic : MC;
+                    gemm_pack_A(A + (size_t)ic*lda + pc, lda, mc, kc, mr, Ap);
+                    for (int s = 0; s < n_strips; s++) {
+                        int nr_eff = nc - s*nr < nr ? nc - s*nr : nr;
+                        const double *bp = Bp + (size_t)s * nr * kc;
+                        for (int ir = 0; ir < mc; ir += mr) {
+                            int mr_eff = mc - ir < mr ? mc - ir : mr;
+                            kern->ukernel(kc, Ap + (size_t)ir * kc, bp,
+                                          C + (size_t)(ic + ir)*ldc + jc + s*nr, ldc,
+                                          mr_eff, nr_eff);
+                        }
+                    }
+                    trace_end(TRACE_GEMM_BLOCK, t0, (uint64_t)mc * kc * sizeof(double));
+                }
+            }
+        }
+        pool_free(Ap, ap_bytes);
+    }
+
+    pool_free(Bp, bp_elems * sizeof(double));
+    return failed ? -1 : 0;
+}
 
 // matrix calculation(matrix multiplication)
 void matrix_multiply_parallel(double *A, double *B, double *C, int n) {
-    printf("  [Parallel] Matrix Multiplication...\n");
-    #pragma omp parallel for collapse(2)
+    progress_printf("  [Parallel] Matrix Multiplication (%s kernel)...\n", gemm_select_kernel()->name);
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++)
+        memset(C + (size_t)i*n, 0, (size_t)n * sizeof(double));
+    if (gemm_blocked(n, n, n, A, n, B, n, C, n) < 0)
+        printf("Error: Failed to allocate GEMM packing buffers\n");
+}
+void matrix_multiply_serial(double *A, double *B, double *C, int n) {
+    progress_printf("  [Serial] Matrix Multiplication...\n");
     for (int i = 0; i < n; i++) {
         for (int j = 0; j < n; j++) {
             C[i*n + j] = 0.0;
@@ -21,358 +748,9511 @@ void matrix_multiply_parallel(double *A, double *B, double *C, int n) {
         }
     }
 }
-void matrix_multiply_serial(double *A, double *B, double *C, int n) {
-    printf("  [Serial] Matrix Multiplication...\n");
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            C[i*n + j] = 0.0;
-            for (int k = 0; k < n; k++)
-                C[i*n + j] += A[i*n + k] * B[k*n + j];
+
+// ===================== 计数器型随机数生成器 (Philox4x32-10) =====================
+// 每个元素的值只由 (种子, 数据集, 行, 列) 决定，与线程数和调度方式无关，
+// 因此并行与串行初始化逐位一致。每次 Philox 调用产生 128 位，对应两个相邻列的 double。
+
+#define RNG_SEED 0x5EED0F4D5ULL     // 矩阵初始化使用的默认种子
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+// 在支持 ifunc 的 x86 GCC 上为批量生成函数编译 AVX-512/AVX2/默认三个版本，运行时自动选择
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define RNG_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define RNG_TARGET_CLONES
+#endif
+
+static inline void philox4x32_10(uint32_t c[4], uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < 10; r++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c[0];
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c[2];
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c[1] ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c[3] ^ k1;
+        c[1] = (uint32_t)p1;
+        c[3] = (uint32_t)p0;
+        c[0] = n0;
+        c[2] = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+// 取 64 位随机数的高 52 位作为尾数，构造 [1, 2) 的 double 再减 1，全程可向量化
+static inline double rng_bits_to_unit(uint64_t u) {
+    uint64_t bits = (u >> 12) | 0x3FF0000000000000ULL;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d - 1.0;
+}
+
+/**
+ * 生成矩阵一行的 [0, 1) 均匀随机数
+ * 计数器 = (列对编号, 行, 数据集, 0)，密钥 = 种子
+ *
+ * @param dst 输出行（n 个元素）
+ * @param seed 种子
+ * @param stream 数据集编号
+ * @param row 行号
+ * @param n 行长度
+ */
+RNG_TARGET_CLONES
+void philox_fill_row(double *restrict dst, uint64_t seed, uint32_t stream, uint32_t row, int n) {
+    const uint32_t key0 = (uint32_t)seed, key1 = (uint32_t)(seed >> 32);
+    const int pairs = n / 2;
+
+    // 各列对相互独立，内层 10 轮完全展开后整体向量化
+    #pragma omp simd
+    for (int q = 0; q < pairs; q++) {
+        uint32_t c0 = (uint32_t)q, c1 = row, c2 = stream, c3 = 0;
+        uint32_t k0 = key0, k1 = key1;
+        for (int r = 0; r < 10; r++) {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c1 = (uint32_t)p1;
+            c3 = (uint32_t)p0;
+            c0 = n0;
+            c2 = n2;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
         }
+        dst[2*q]     = rng_bits_to_unit((uint64_t)c1 << 32 | c0);
+        dst[2*q + 1] = rng_bits_to_unit((uint64_t)c3 << 32 | c2);
+    }
+    if (n & 1) {
+        uint32_t c[4] = {(uint32_t)pairs, row, stream, 0};
+        philox4x32_10(c, key0, key1);
+        dst[n - 1] = rng_bits_to_unit((uint64_t)c[1] << 32 | c[0]);
     }
 }
 
 //matrix data init
-void init_matrix_parallel(double *matrix, int n) {
-    #pragma omp parallel for
-    for (int i = 0; i < n; i++) {
-        unsigned int seed = i + omp_get_thread_num();
-        for (int j = 0; j < n; j++) {
-            matrix[i*n + j] = (double)rand_r(&seed) / RAND_MAX;
+void init_matrix_parallel(double *matrix, int n, int matrix_id) {
+    #pragma omp parallel
+    {
+        uint64_t t0 = trace_begin();
+        int rows = 0;
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < n; i++) {
+            philox_fill_row(matrix + (size_t)i*n, RNG_SEED, (uint32_t)matrix_id, (uint32_t)i, n);
+            rows++;
         }
+        trace_end(TRACE_INIT, t0, (uint64_t)rows * n * sizeof(double));
     }
 }
-void init_matrix_serial(double *matrix, int n) {
+void init_matrix_serial(double *matrix, int n, int matrix_id) {
     for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            matrix[i*n + j] = (double)rand() / RAND_MAX;
-        }
+        philox_fill_row(matrix + (size_t)i*n, RNG_SEED, (uint32_t)matrix_id, (uint32_t)i, n);
     }
 }
 
-void parallel_write_hdf5(const char* filename, double **matrices, int n, int num_matrices) {
+// ===================== NUMA 感知的矩阵缓冲区 =====================
+// Linux 按“首次触碰”把物理页分配到触碰它的线程所在的 NUMA 节点。
+// matrix_alloc 从缓冲池申请后，按与计算内核相同的 schedule(static) 行划分并行触碰，
+// 使每个线程后续访问的行都位于本地节点；大缓冲区由缓冲池申请透明大页。
+
+#define NUMA_MAX_NODES 64
+#define NUMA_SAMPLE_PAGES 4096      // 统计页面分布时最多采样的页数
+
+// 绑定前进程可用的 CPU 集合；之后创建的辅助线程（如 I/O 线程）恢复到该集合，不与主线程挤在同一个 CPU 上
+static cpu_set_t process_cpus;
+static int process_cpus_saved = 0;
+
 /**
- * 并行写入HDF5文件
- * 演示：将大型矩阵数据并行写入多个数据集
- * 
- * @param filename 文件名
- * @param matrices 矩阵数组指针
- * @param n 矩阵维度
- * @param num_matrices 矩阵数量
+ * 并行清零（同时作为首次触碰），行划分与计算内核的 schedule(static) 一致
  */
-    printf("  [Parallel] Create HDF5 file and write %d %dx%d matrices...\n", num_matrices, n, n);
-    
-    hid_t file_id, dataspace_id, dataset_ids[num_matrices];
-    herr_t status;
-    hsize_t dims[2] = {n, n};
-    char dataset_names[num_matrices][50];
-    
-    // 创建HDF5文件
-    file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-    if (file_id < 0) {
-        printf("Error: Failed to create HDF5 file\n");
+void matrix_zero(double *matrix, size_t rows, size_t n) {
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < rows; i++)
+        memset(matrix + i * n, 0, n * sizeof(double));
+}
+
+/**
+ * 清空矩阵以便下一阶段使用：开启惰性清零时交还物理页，由下一阶段的写入者首次触碰；
+ * 否则按行并行清零
+ */
+void matrix_clear(double *matrix, size_t rows, size_t n) {
+    if (pool_lazy_zero)
+        pool_discard(matrix, rows * n * sizeof(double));
+    else
+        matrix_zero(matrix, rows, n);
+}
+
+/**
+ * 从缓冲池分配 rows x n 的 double 矩阵（内容为 0）
+ * 未开启惰性清零时按行并行首次触碰；用 matrix_free 归还
+ */
+double *matrix_alloc(size_t rows, size_t n) {
+    size_t bytes = rows * n * sizeof(double);
+    double *matrix = (double*)pool_alloc(bytes ? bytes : sizeof(double));
+    if (matrix && bytes)
+        matrix_clear(matrix, rows, n);
+    return matrix;
+}
+
+void matrix_free(double *matrix, size_t rows, size_t n) {
+    size_t bytes = rows * n * sizeof(double);
+    pool_free(matrix, bytes ? bytes : sizeof(double));
+}
+
+/**
+ * 将 OpenMP 线程绑定到进程可用的 CPU 上
+ * spread = 0: 相邻线程绑定相邻 CPU（close）；spread = 1: 线程均匀分散到所有 CPU（spread）
+ * 与 OMP_PROC_BIND 不同，它可以在程序运行中按命令行选项生效
+ */
+void pin_omp_threads(int spread) {
+    cpu_set_t allowed;
+    int cpus[CPU_SETSIZE], ncpus = 0;
+    if (!process_cpus_saved) {
+        if (sched_getaffinity(0, sizeof(process_cpus), &process_cpus) != 0)
+            return;
+        process_cpus_saved = 1;
+    }
+    allowed = process_cpus;
+    for (int c = 0; c < CPU_SETSIZE; c++)
+        if (CPU_ISSET(c, &allowed))
+            cpus[ncpus++] = c;
+    if (ncpus == 0)
         return;
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        int slot = spread ? (int)((long)tid * ncpus / nthreads) : tid % ncpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[slot], &set);
+        sched_setaffinity(0, sizeof(set), &set);
     }
-    
-    // 创建数据空间（所有数据集共享相同的数据空间）
-    dataspace_id = H5Screate_simple(2, dims, NULL);
-    for (int i = 0; i < num_matrices; i++)
-        sprintf(dataset_names[i], "/matrix_%d", i);// 准备数据集名称
-    #pragma omp parallel for
-    for (int i = 0; i < num_matrices; i++) {
-        dataset_ids[i] = H5Dcreate(file_id, dataset_names[i], H5T_IEEE_F64LE, 
-                                  dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-        
-        if (dataset_ids[i] >= 0) {
-            // 并行写入数据
-            status = H5Dwrite(dataset_ids[i], H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, 
-                             H5P_DEFAULT, matrices[i]);
-            printf("    Thread %d: completed matrix %d\n", omp_get_thread_num(), i);
-            H5Dclose(dataset_ids[i]);
+}
+
+/**
+ * 打印缓冲区物理页在各 NUMA 节点上的分布（采样 move_pages 查询）
+ */
+void report_numa_placement(const char *label, const void *buf, size_t bytes) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t npages = (bytes + page - 1) / page;
+    size_t samples = npages < NUMA_SAMPLE_PAGES ? npages : NUMA_SAMPLE_PAGES;
+    void *pages[NUMA_SAMPLE_PAGES];
+    int status[NUMA_SAMPLE_PAGES];
+    long counts[NUMA_MAX_NODES] = {0}, unknown = 0;
+
+    if (samples == 0)
+        return;
+    for (size_t i = 0; i < samples; i++)
+        pages[i] = (char*)buf + (npages * i / samples) * page;
+    if (syscall(SYS_move_pages, 0, (unsigned long)samples, pages, NULL, status, 0) != 0) {
+        printf("  %s: NUMA 页面分布不可用\n", label);
+        return;
+    }
+    for (size_t i = 0; i < samples; i++) {
+        if (status[i] >= 0 && status[i] < NUMA_MAX_NODES)
+            counts[status[i]]++;
+        else
+            unknown++;
+    }
+    printf("  %s 页面分布 (采样 %zu 页):", label, samples);
+    for (int node = 0; node < NUMA_MAX_NODES; node++)
+        if (counts[node] > 0)
+            printf(" node%d %.1f%%", node, 100.0 * counts[node] / samples);
+    if (unknown > 0)
+        printf(" 未分配 %.1f%%", 100.0 * unknown / samples);
+    printf("\n");
+}
+
+// 按 hyperslab 读写 2D 数据集中的 [row, col] 起始、rows x cols 大小的矩形块
+// 内存中块以 ld 为行跨度、mem_type 为元素类型存放
+static herr_t hdf5_tile_io_typed(hid_t dataset_id, int write, hsize_t row, hsize_t col,
+                                 hsize_t rows, hsize_t cols, void *buf, hsize_t ld, hid_t mem_type) {
+    hsize_t offset[2] = {row, col};
+    hsize_t count[2] = {rows, cols};
+    hsize_t mem_dims[2] = {rows, ld};
+    hsize_t mem_offset[2] = {0, 0};
+    hid_t file_space = H5Dget_space(dataset_id);
+    hid_t mem_space = H5Screate_simple(2, mem_dims, NULL);
+    herr_t status = -1;
+    uint64_t t0 = trace_begin();
+
+    if (file_space >= 0 && mem_space >= 0 &&
+        H5Sselect_hyperslab(file_space, H5S_SELECT_SET, offset, NULL, count, NULL) >= 0 &&
+        H5Sselect_hyperslab(mem_space, H5S_SELECT_SET, mem_offset, NULL, count, NULL) >= 0) {
+        if (write)
+            status = H5Dwrite(dataset_id, mem_type, mem_space, file_space, H5P_DEFAULT, buf);
+        else
+            status = H5Dread(dataset_id, mem_type, mem_space, file_space, H5P_DEFAULT, buf);
+    }
+    if (mem_space >= 0) H5Sclose(mem_space);
+    if (file_space >= 0) H5Sclose(file_space);
+    trace_end(write ? TRACE_H5_WRITE : TRACE_H5_READ, t0, rows * cols * H5Tget_size(mem_type));
+    return status;
+}
+
+static herr_t hdf5_tile_io(hid_t dataset_id, int write, hsize_t row, hsize_t col,
+                           hsize_t rows, hsize_t cols, double *buf, hsize_t ld) {
+    return hdf5_tile_io_typed(dataset_id, write, row, col, rows, cols, buf, ld, H5T_NATIVE_DOUBLE);
+}
+
+// ===================== HDF5 库访问锁 =====================
+// 所有 HDF5 句柄由 I/O 服务线程持有（见下文）。少数代码（串行基线、属性列表/类型的创建与释放、核外乘法）
+// 在调用线程上直接调用 libhdf5，这些代码段用 hdf5_direct_begin/hdf5_direct_end 包围：
+// I/O 线程执行每个请求时也持有同一把（可重入的）锁，二者互斥，非线程安全的库也不会被两个线程同时进入。
+// 代码段内不能提交或等待 I/O 请求（I/O 线程拿不到锁），hdf5_io_submit/hdf5_io_wait 会检查并中止。
+
+static pthread_mutex_t hdf5_lib_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread int hdf5_direct_depth = 0;
+
+void hdf5_direct_begin(void) {
+    pthread_mutex_lock(&hdf5_lib_lock);
+    hdf5_direct_depth++;
+}
+
+void hdf5_direct_end(void) {
+    hdf5_direct_depth--;
+    pthread_mutex_unlock(&hdf5_lib_lock);
+}
+
+// ===================== io_uring / O_DIRECT 虚拟文件驱动 =====================
+// 默认的 sec2 驱动把每次读写变成一次同步 pread/pwrite：大矩阵先进入页缓存再复制到用户缓冲区（内存里存两份），
+// 设备上同一时刻也只有一个请求（队列深度 1）。uring 驱动把一次 HDF5 读写拆成 URING_SEGMENT 大小的段，
+// 通过 io_uring 同时保持 queue_depth 个请求在途；direct 模式以 O_DIRECT 打开文件、绕过页缓存，
+// 地址/长度/缓冲区不满足 URING_ALIGN 对齐的首尾块经对齐的中转缓冲区传输（写入时先读回再合并）。
+// 直接使用 io_uring_setup/io_uring_enter 系统调用和共享环，不依赖 liburing；
+// 内核不支持 io_uring 时退化为 pread/pwrite，文件系统不支持 O_DIRECT 时退化为带缓存模式。
+// 驱动回调只在持有库全局锁的 HDF5 调用中执行，因此文件状态和统计不需要再加锁。
+// H5FD_class_t 的布局随版本变化：1.10/1.12 与 1.14（增加 version/value 与向量读写等回调）分别支持，
+// 其他版本（如 1.13 开发版）不编译驱动，选择 uring 时 set_file_driver 报错并保持 sec2。
+
+#define URING_ALIGN 4096                // O_DIRECT 要求的偏移、长度和缓冲区对齐（字节）
+#define URING_SEGMENT (1u << 20)        // 单个 SQE 的最大传输字节数
+#define URING_QUEUE_DEPTH 32            // 默认在途请求数
+#define URING_MAX_QUEUE_DEPTH 256
+#define URING_BOUNCE_BYTES (4u << 20)   // direct 模式下不对齐传输的中转缓冲区大小
+#define URING_VFD_VALUE 300             // 1.14 驱动标识，取自未注册驱动可用的 256-511 区段
+
+#if H5_VERSION_GE(1, 14, 0) || (H5_VERSION_GE(1, 10, 0) && !H5_VERSION_GE(1, 13, 0))
+#define URING_VFD_SUPPORTED 1
+#else
+#define URING_VFD_SUPPORTED 0
+#endif
+
+typedef enum { VFD_SEC2, VFD_URING, VFD_URING_DIRECT, VFD_COUNT } vfd_mode_t;
+static const char *vfd_names[VFD_COUNT] = {"sec2", "uring", "uring-direct"};
+
+// 驱动的文件访问属性（H5Pset_driver 的 driver info）
+typedef struct {
+    int direct;                 // 1 = 以 O_DIRECT 打开
+    unsigned queue_depth;       // 在途请求数上限
+} uring_fapl_t;
+
+// 与内核共享的提交/完成环
+typedef struct {
+    int fd;                     // <0 表示未启用，读写退化为 pread/pwrite
+    unsigned sq_mask, cq_mask;
+    _Atomic unsigned *sq_tail, *cq_head, *cq_tail;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map, *cq_map;
+    size_t sq_map_len, cq_map_len, sqes_len;
+    unsigned to_submit;         // 已填写、尚未提交的 SQE 数
+} uring_ring_t;
+
+// 驱动打开的文件；pub 必须是第一个成员
+typedef struct {
+    H5FD_t pub;
+    int fd;
+    haddr_t eoa;                // HDF5 分配到的地址上限
+    haddr_t eof;                // 逻辑文件末尾（HDF5 写到的最大地址）
+    haddr_t phys;               // 物理文件大小；direct 模式按整块写入，可能超过 eof
+    uring_fapl_t fa;
+    int direct;                 // 实际是否以 O_DIRECT 打开
+    dev_t device;
+    ino_t inode;
+    uring_ring_t ring;
+    char *bounce;               // URING_ALIGN 对齐的中转缓冲区（首次需要时分配）
+} uring_file_t;
+
+// 一个在途的段
+typedef struct {
+    uint64_t off;
+    char *buf;
+    size_t len;
+} uring_seg_t;
+
+// 进程内累计的驱动统计（uring_stats_reset 清零）
+typedef struct {
+    long files;                 // 打开的文件数
+    long requests;              // 提交的读写 SQE 数（含短读写后的重新提交）
+    long enters;                // io_uring_enter 调用次数
+    long sync_ops;              // 未启用 io_uring 时的 pread/pwrite 次数
+    unsigned max_inflight;      // 观察到的最大在途请求数
+    double bytes_read, bytes_written;   // 实际传输字节（含块对齐带来的放大）
+    double bounce_bytes;        // 经中转缓冲区复制的字节
+} uring_stats_t;
+
+static uring_stats_t uring_stats;
+
+void uring_stats_reset(void) {
+    memset(&uring_stats, 0, sizeof(uring_stats));
+}
+
+#if URING_VFD_SUPPORTED
+static hid_t uring_driver_id = -1;
+
+static void uring_ring_destroy(uring_ring_t *r) {
+    if (r->sqes)
+        munmap(r->sqes, r->sqes_len);
+    if (r->cq_map && r->cq_map != r->sq_map)
+        munmap(r->cq_map, r->cq_map_len);
+    if (r->sq_map)
+        munmap(r->sq_map, r->sq_map_len);
+    if (r->fd >= 0)
+        close(r->fd);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+}
+
+static void *uring_map(size_t len, int fd, off_t offset) {
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+/**
+ * 创建至少 entries 项的 io_uring 并映射提交环、完成环和 SQE 数组
+ *
+ * @return 0 成功，-1 失败（r->fd 为 -1，errno 为失败原因）
+ */
+static int uring_ring_init(uring_ring_t *r, unsigned entries) {
+    struct io_uring_params p;
+    memset(r, 0, sizeof(*r));
+    memset(&p, 0, sizeof(p));
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) {
+        r->fd = -1;
+        return -1;
+    }
+    r->sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    // 5.4 起提交环和完成环可以共用一次映射
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        r->sq_map_len = r->cq_map_len = r->sq_map_len > r->cq_map_len ? r->sq_map_len : r->cq_map_len;
+    r->sq_map = uring_map(r->sq_map_len, r->fd, IORING_OFF_SQ_RING);
+    r->cq_map = (p.features & IORING_FEAT_SINGLE_MMAP) ? r->sq_map : uring_map(r->cq_map_len, r->fd, IORING_OFF_CQ_RING);
+    r->sqes = (struct io_uring_sqe*)uring_map(r->sqes_len, r->fd, IORING_OFF_SQES);
+    if (!r->sq_map || !r->cq_map || !r->sqes) {
+        int err = errno;
+        uring_ring_destroy(r);
+        errno = err;
+        return -1;
+    }
+    char *sq = (char*)r->sq_map, *cq = (char*)r->cq_map;
+    r->sq_tail = (_Atomic unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = *(unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head = (_Atomic unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (_Atomic unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = *(unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+// 填写一个读/写 SQE，user_data 为段下标；在下一次 io_uring_enter 时提交
+static void uring_prep(uring_ring_t *r, int write, int fd, const uring_seg_t *seg, int slot) {
+    unsigned tail = atomic_load_explicit(r->sq_tail, memory_order_relaxed);
+    unsigned idx = tail & r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->off = seg->off;
+    sqe->addr = (uint64_t)(uintptr_t)seg->buf;
+    sqe->len = (unsigned)seg->len;
+    sqe->user_data = (uint64_t)slot;
+    r->sq_array[idx] = idx;
+    atomic_store_explicit(r->sq_tail, tail + 1, memory_order_release);
+    r->to_submit++;
+}
+
+/**
+ * 未启用 io_uring 时的同步读写；读到物理文件末尾之后的部分补零
+ */
+static int uring_transfer_sync(uring_file_t *f, int write, uint64_t off, char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write ? pwrite(f->fd, buf, len, (off_t)off) : pread(f->fd, buf, len, (off_t)off);
+        uring_stats.sync_ops++;
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 || (n == 0 && write))
+            return -1;
+        if (n == 0) {
+            memset(buf, 0, len);
+            break;
+        }
+        if (write)
+            uring_stats.bytes_written += n;
+        else
+            uring_stats.bytes_read += n;
+        off += n;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * 把 [off, off + len) 的读或写按 URING_SEGMENT 拆段，通过 io_uring 保持最多 queue_depth 个段在途；
+ * 短读写把剩余部分重新提交，读到物理文件末尾之后的部分补零。
+ * direct 模式下由调用者保证 off、len 和 buf 都按 URING_ALIGN 对齐
+ *
+ * @return 0 成功，-1 失败（errno 为第一个失败段的错误码；返回前等待所有在途段完成）
+ */
+static int uring_transfer(uring_file_t *f, int write, uint64_t off, char *buf, size_t len) {
+    if (f->ring.fd < 0) {
+        if (uring_transfer_sync(f, write, off, buf, len) < 0)
+            return -1;
+    } else {
+        uring_ring_t *r = &f->ring;
+        uring_seg_t segs[URING_MAX_QUEUE_DEPTH];
+        int free_slots[URING_MAX_QUEUE_DEPTH], nfree = 0, err = 0;
+        unsigned inflight = 0;
+        size_t next = 0;
+        for (int s = (int)f->fa.queue_depth - 1; s >= 0; s--)
+            free_slots[nfree++] = s;
+
+        while ((next < len && !err) || inflight || r->to_submit) {
+            while (next < len && !err && nfree > 0) {
+                int s = free_slots[--nfree];
+                size_t n = len - next < URING_SEGMENT ? len - next : URING_SEGMENT;
+                segs[s] = (uring_seg_t){off + next, buf + next, n};
+                uring_prep(r, write, f->fd, &segs[s], s);
+                next += n;
+            }
+            unsigned submit = r->to_submit;
+            int ret = (int)syscall(__NR_io_uring_enter, r->fd, submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+            uring_stats.enters++;
+            if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                // 环本身出错：撤回未提交的 SQE，等已在途的段完成后返回
+                if (!err)
+                    err = errno;
+                atomic_store_explicit(r->sq_tail, atomic_load(r->sq_tail) - r->to_submit, memory_order_release);
+                r->to_submit = 0;
+                if (!inflight)
+                    break;
+            } else if (ret > 0) {
+                r->to_submit -= (unsigned)ret;
+                inflight += (unsigned)ret;
+                uring_stats.requests += ret;
+                if (inflight > uring_stats.max_inflight)
+                    uring_stats.max_inflight = inflight;
+            }
+
+            unsigned head = atomic_load_explicit(r->cq_head, memory_order_relaxed);
+            unsigned tail = atomic_load_explicit(r->cq_tail, memory_order_acquire);
+            for (; head != tail; head++) {
+                const struct io_uring_cqe *cqe = &r->cqes[head & r->cq_mask];
+                int s = (int)cqe->user_data, res = cqe->res;
+                uring_seg_t *g = &segs[s];
+                inflight--;
+                if ((res == -EINTR || res == -EAGAIN) && !err) {
+                    uring_prep(r, write, f->fd, g, s);
+                    continue;
+                }
+                if (res < 0 || (res == 0 && write)) {
+                    if (!err)
+                        err = res < 0 ? -res : EIO;
+                    free_slots[nfree++] = s;
+                    continue;
+                }
+                if (write)
+                    uring_stats.bytes_written += res;
+                else
+                    uring_stats.bytes_read += res;
+                if ((size_t)res < g->len) {
+                    if (!write && g->off + (uint64_t)res >= f->phys) {
+                        memset(g->buf + res, 0, g->len - res);
+                    } else if (!err) {
+                        g->off += res;
+                        g->buf += res;
+                        g->len -= res;
+                        uring_prep(r, write, f->fd, g, s);
+                        continue;
+                    }
+                }
+                free_slots[nfree++] = s;
+            }
+            atomic_store_explicit(r->cq_head, head, memory_order_release);
+        }
+        if (err) {
+            errno = err;
+            return -1;
+        }
+    }
+    if (write && off + len > f->phys)
+        f->phys = off + len;
+    return 0;
+}
+
+/**
+ * direct 模式下经中转缓冲区传输 [addr, addr + size)：按 URING_BOUNCE_BYTES 的对齐窗口读写整块，
+ * 写入时先读回不完整的首尾块再合并
+ */
+static int uring_bounce_io(uring_file_t *f, int write, uint64_t addr, char *buf, size_t size) {
+    const uint64_t A = URING_ALIGN;
+    uint64_t end = addr + size;
+    if (!f->bounce && posix_memalign((void**)&f->bounce, URING_ALIGN, URING_BOUNCE_BYTES) != 0) {
+        f->bounce = NULL;
+        errno = ENOMEM;
+        return -1;
+    }
+    for (uint64_t win = addr & ~(A - 1); win < end; win += URING_BOUNCE_BYTES) {
+        uint64_t s = addr > win ? addr : win;
+        uint64_t e = end < win + URING_BOUNCE_BYTES ? end : win + URING_BOUNCE_BYTES;
+        size_t wlen = (size_t)(((e - win) + A - 1) & ~(A - 1));
+        if (write) {
+            uint64_t last = (e - 1) & ~(A - 1);
+            if (s > win && uring_transfer(f, 0, win, f->bounce, A) < 0)
+                return -1;
+            if ((e & (A - 1)) && !(s > win && last == win) &&
+                uring_transfer(f, 0, last, f->bounce + (last - win), A) < 0)
+                return -1;
+            memcpy(f->bounce + (s - win), buf + (s - addr), e - s);
+            if (uring_transfer(f, 1, win, f->bounce, wlen) < 0)
+                return -1;
+        } else {
+            if (uring_transfer(f, 0, win, f->bounce, wlen) < 0)
+                return -1;
+            memcpy(buf + (s - addr), f->bounce + (s - win), e - s);
+        }
+        uring_stats.bounce_bytes += e - s;
+    }
+    return 0;
+}
+
+/**
+ * 驱动读写入口：带缓存模式直接传输；direct 模式下缓冲区与文件地址对 URING_ALIGN 同余时，
+ * 中间的整块直接在用户缓冲区上传输，只有不完整的首尾块经中转缓冲区，否则全部经中转缓冲区
+ */
+static int uring_io(uring_file_t *f, int write, uint64_t addr, char *buf, size_t size) {
+    const uint64_t A = URING_ALIGN;
+    if (!f->direct)
+        return uring_transfer(f, write, addr, buf, size);
+    if (((uintptr_t)buf & (A - 1)) == (addr & (A - 1))) {
+        uint64_t end = addr + size, lo = (addr + A - 1) & ~(A - 1), hi = end & ~(A - 1);
+        if (lo < hi) {
+            if (lo > addr && uring_bounce_io(f, write, addr, buf, lo - addr) < 0)
+                return -1;
+            if (uring_transfer(f, write, lo, buf + (lo - addr), hi - lo) < 0)
+                return -1;
+            return hi < end ? uring_bounce_io(f, write, hi, buf + (hi - addr), end - hi) : 0;
+        }
+    }
+    return uring_bounce_io(f, write, addr, buf, size);
+}
+
+static void *uring_fapl_copy(const void *info) {
+    uring_fapl_t *fa = (uring_fapl_t*)malloc(sizeof(uring_fapl_t));
+    if (fa)
+        memcpy(fa, info, sizeof(*fa));
+    return fa;
+}
+
+static herr_t uring_fapl_free(void *info) {
+    free(info);
+    return 0;
+}
+
+static void *uring_fapl_get(H5FD_t *file) {
+    return uring_fapl_copy(&((uring_file_t*)file)->fa);
+}
+
+static H5FD_t *uring_open(const char *name, unsigned flags, hid_t fapl, haddr_t maxaddr) {
+    static int direct_warned = 0, ring_warned = 0;
+    (void)maxaddr;
+    const uring_fapl_t *info = (const uring_fapl_t*)H5Pget_driver_info(fapl);
+    uring_fapl_t fa = info ? *info : (uring_fapl_t){0, URING_QUEUE_DEPTH};
+    int oflags = (flags & H5F_ACC_RDWR) ? O_RDWR : O_RDONLY;
+    struct stat sb;
+
+    if (flags & H5F_ACC_TRUNC) oflags |= O_TRUNC;
+    if (flags & H5F_ACC_CREAT) oflags |= O_CREAT;
+    if (flags & H5F_ACC_EXCL) oflags |= O_EXCL;
+    if (fa.queue_depth < 1) fa.queue_depth = 1;
+    if (fa.queue_depth > URING_MAX_QUEUE_DEPTH) fa.queue_depth = URING_MAX_QUEUE_DEPTH;
+
+    int direct = fa.direct;
+    int fd = open(name, oflags | (direct ? O_DIRECT : 0), 0666);
+    if (fd < 0 && direct && errno == EINVAL) {
+        if (!direct_warned++)
+            progress_printf("  [VFD] O_DIRECT is not supported for %s, falling back to buffered I/O\n", name);
+        direct = 0;
+        fd = open(name, oflags & ~O_EXCL, 0666);
+    }
+    if (fd < 0)
+        return NULL;
+    uring_file_t *f = (uring_file_t*)calloc(1, sizeof(uring_file_t));
+    if (!f || fstat(fd, &sb) < 0) {
+        free(f);
+        close(fd);
+        return NULL;
+    }
+    f->fd = fd;
+    f->eof = f->phys = (haddr_t)sb.st_size;
+    f->fa = fa;
+    f->direct = direct;
+    f->device = sb.st_dev;
+    f->inode = sb.st_ino;
+    if (uring_ring_init(&f->ring, fa.queue_depth) < 0 && !ring_warned++)
+        progress_printf("  [VFD] io_uring is unavailable (%s), falling back to pread/pwrite\n", strerror(errno));
+    uring_stats.files++;
+    return &f->pub;
+}
+
+static herr_t uring_close(H5FD_t *file) {
+    uring_file_t *f = (uring_file_t*)file;
+    uring_ring_destroy(&f->ring);
+    free(f->bounce);
+    int ret = close(f->fd);
+    free(f);
+    return ret < 0 ? -1 : 0;
+}
+
+static int uring_cmp(const H5FD_t *a, const H5FD_t *b) {
+    const uring_file_t *f1 = (const uring_file_t*)a, *f2 = (const uring_file_t*)b;
+    if (f1->device != f2->device)
+        return f1->device < f2->device ? -1 : 1;
+    return f1->inode < f2->inode ? -1 : f1->inode > f2->inode;
+}
+
+// 与 sec2 相同：由库聚合元数据与小块原始数据、缓存元数据、对连续数据集做数据筛选，
+// direct 模式下这些小块读写都会被合并成较少的整块传输；
+// O_DIRECT 描述符不能用普通的不对齐 read/write 访问，因此 direct 模式不声明 POSIX 兼容句柄
+static herr_t uring_query(const H5FD_t *file, unsigned long *flags) {
+    *flags = H5FD_FEAT_AGGREGATE_METADATA | H5FD_FEAT_ACCUMULATE_METADATA | H5FD_FEAT_DATA_SIEVE |
+             H5FD_FEAT_AGGREGATE_SMALLDATA;
+    if (!file || !((const uring_file_t*)file)->direct)
+        *flags |= H5FD_FEAT_POSIX_COMPAT_HANDLE;
+    return 0;
+}
+
+static haddr_t uring_get_eoa(const H5FD_t *file, H5FD_mem_t type) {
+    (void)type;
+    return ((const uring_file_t*)file)->eoa;
+}
+
+static herr_t uring_set_eoa(H5FD_t *file, H5FD_mem_t type, haddr_t addr) {
+    (void)type;
+    ((uring_file_t*)file)->eoa = addr;
+    return 0;
+}
+
+static haddr_t uring_get_eof(const H5FD_t *file, H5FD_mem_t type) {
+    (void)type;
+    return ((const uring_file_t*)file)->eof;
+}
+
+static herr_t uring_get_handle(H5FD_t *file, hid_t fapl, void **handle) {
+    (void)fapl;
+    *handle = &((uring_file_t*)file)->fd;
+    return 0;
+}
+
+static herr_t uring_read(H5FD_t *file, H5FD_mem_t type, hid_t dxpl, haddr_t addr, size_t size, void *buf) {
+    (void)type;
+    (void)dxpl;
+    if (uring_io((uring_file_t*)file, 0, addr, (char*)buf, size) < 0) {
+        printf("Error: uring read of %zu bytes at offset %llu failed: %s\n", size, (unsigned long long)addr,
+               strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static herr_t uring_write(H5FD_t *file, H5FD_mem_t type, hid_t dxpl, haddr_t addr, size_t size, const void *buf) {
+    uring_file_t *f = (uring_file_t*)file;
+    (void)type;
+    (void)dxpl;
+    if (uring_io(f, 1, addr, (char*)buf, size) < 0) {
+        printf("Error: uring write of %zu bytes at offset %llu failed: %s\n", size, (unsigned long long)addr,
+               strerror(errno));
+        return -1;
+    }
+    if (addr + size > f->eof)
+        f->eof = addr + size;
+    return 0;
+}
+
+// 把物理文件截到 eoa：去掉 direct 模式整块写入留下的尾部填充
+static herr_t uring_truncate(H5FD_t *file, hid_t dxpl, hbool_t closing) {
+    uring_file_t *f = (uring_file_t*)file;
+    (void)dxpl;
+    (void)closing;
+    if (f->phys != f->eoa) {
+        if (ftruncate(f->fd, (off_t)f->eoa) < 0)
+            return -1;
+        f->phys = f->eof = f->eoa;
+    }
+    return 0;
+}
+
+static herr_t uring_lock(H5FD_t *file, hbool_t rw) {
+    if (flock(((uring_file_t*)file)->fd, (rw ? LOCK_EX : LOCK_SH) | LOCK_NB) < 0 && errno != ENOSYS)
+        return -1;
+    return 0;
+}
+
+static herr_t uring_unlock(H5FD_t *file) {
+    if (flock(((uring_file_t*)file)->fd, LOCK_UN) < 0 && errno != ENOSYS)
+        return -1;
+    return 0;
+}
+
+// 未列出的回调（terminate、超级块、dxpl、alloc/free、flush 等）为 NULL，flush 与 sec2 一样无需操作
+static const H5FD_class_t uring_class = {
+#if H5_VERSION_GE(1, 14, 0)
+    .version = H5FD_CLASS_VERSION,
+    .value = URING_VFD_VALUE,
+#endif
+    .name = "uring",
+    .maxaddr = (haddr_t)INT64_MAX,
+    .fc_degree = H5F_CLOSE_WEAK,
+    .fapl_size = sizeof(uring_fapl_t),
+    .fapl_get = uring_fapl_get,
+    .fapl_copy = uring_fapl_copy,
+    .fapl_free = uring_fapl_free,
+    .open = uring_open,
+    .close = uring_close,
+    .cmp = uring_cmp,
+    .query = uring_query,
+    .get_eoa = uring_get_eoa,
+    .set_eoa = uring_set_eoa,
+    .get_eof = uring_get_eof,
+    .get_handle = uring_get_handle,
+    .read = uring_read,
+    .write = uring_write,
+    .truncate = uring_truncate,
+    .lock = uring_lock,
+    .unlock = uring_unlock,
+    .fl_map = H5FD_FLMAP_DICHOTOMY
+};
+#endif
+
+/**
+ * 生成使用 uring 驱动的文件访问属性列表（首次调用时注册驱动）
+ * 不小于一块的对象按 URING_ALIGN 对齐，使连续数据集的数据起点落在块边界上，direct 模式下可整块直接传输
+ *
+ * @param direct 1 = O_DIRECT 绕过页缓存，0 = 经过页缓存
+ * @param queue_depth 在途请求数上限，0 表示 URING_QUEUE_DEPTH
+ * @return fapl，失败返回 -1；用 H5Pclose 释放
+ */
+hid_t make_uring_fapl(int direct, unsigned queue_depth) {
+#if URING_VFD_SUPPORTED
+    if (uring_driver_id < 0 && (uring_driver_id = H5FDregister(&uring_class)) < 0)
+        return -1;
+    uring_fapl_t fa = {direct, queue_depth ? queue_depth : URING_QUEUE_DEPTH};
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    if (fapl < 0 || H5Pset_driver(fapl, uring_driver_id, &fa) < 0 ||
+        H5Pset_alignment(fapl, URING_ALIGN, URING_ALIGN) < 0) {
+        if (fapl >= 0)
+            H5Pclose(fapl);
+        return -1;
+    }
+    return fapl;
+#else
+    (void)direct;
+    (void)queue_depth;
+    printf("Error: The uring file driver is not built for HDF5 %d.%d.%d\n", H5_VERS_MAJOR, H5_VERS_MINOR,
+           H5_VERS_RELEASE);
+    return -1;
+#endif
+}
+
+// 工程中使用默认文件访问属性的 H5Fcreate/H5Fopen 共用的驱动与属性列表
+static vfd_mode_t file_vfd = VFD_SEC2;
+static hid_t file_fapl = H5P_DEFAULT;
+
+/**
+ * 切换默认文件驱动；在库访问锁内替换 file_fapl，不会与 I/O 线程上正在打开文件的请求交错
+ *
+ * @param queue_depth uring 驱动的在途请求数上限，0 表示 URING_QUEUE_DEPTH
+ * @return 0 成功，-1 失败（保持原驱动）
+ */
+int set_file_driver(vfd_mode_t mode, unsigned queue_depth) {
+    hdf5_direct_begin();
+    hid_t fapl = mode == VFD_SEC2 ? H5P_DEFAULT : make_uring_fapl(mode == VFD_URING_DIRECT, queue_depth);
+    if (fapl >= 0) {
+        if (file_fapl != H5P_DEFAULT)
+            H5Pclose(file_fapl);
+        file_fapl = fapl;
+        file_vfd = mode;
+    }
+    hdf5_direct_end();
+    if (fapl < 0) {
+        printf("Error: Failed to set up the %s file driver\n", vfd_names[mode]);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 文件当前驻留在页缓存中的比例（对只读映射做 mincore 查询）
+ *
+ * @return 0..1，失败返回 -1
+ */
+double file_cached_fraction(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    struct stat sb;
+    double fraction = -1.0;
+    if (fd < 0)
+        return -1.0;
+    if (fstat(fd, &sb) == 0 && sb.st_size > 0) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE), pages = ((size_t)sb.st_size + page - 1) / page, cached = 0;
+        void *map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        unsigned char *vec = (unsigned char*)malloc(pages);
+        if (map != MAP_FAILED && vec && mincore(map, (size_t)sb.st_size, vec) == 0) {
+            for (size_t i = 0; i < pages; i++)
+                cached += vec[i] & 1;
+            fraction = (double)cached / pages;
+        }
+        if (map != MAP_FAILED)
+            munmap(map, (size_t)sb.st_size);
+        free(vec);
+    } else if (sb.st_size == 0) {
+        fraction = 0.0;
+    }
+    close(fd);
+    return fraction;
+}
+
+/**
+ * 把文件落盘并逐出页缓存，使之后的读取从设备读
+ *
+ * @return 0 成功，-1 失败
+ */
+int file_drop_cache(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    int ret = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0 ? 0 : -1;
+    close(fd);
+    return ret;
+}
+
+// ===================== HDF5 I/O 服务线程 =====================
+// 非线程安全的 libhdf5 不允许多个线程同时调用；线程安全版本内部也只有一把全局锁。
+// 因此所有 HDF5 句柄都由一个专用 I/O 线程持有，计算线程只提交请求：
+// 请求通过无锁 MPSC 队列（Vyukov 侵入式链表）入队，信号量唤醒 I/O 线程，
+// 完成后由请求内的 done 标志通知提交者。计算线程可以继续计算，实现计算与 I/O 重叠。
+
+typedef enum {
+    IO_FILE_CREATE,     // name, plist = fapl, fcpl -> result = file_id
+    IO_FILE_OPEN,       // name, flags, plist = fapl -> result = file_id
+    IO_FILE_CLOSE,      // obj = file_id
+    IO_DATASET_CREATE,  // obj = file_id, name, rows x cols, type = 文件类型 -> result = dataset_id
+    IO_DATASET_OPEN,    // obj = file_id, name -> result = dataset_id
+    IO_DATASET_CLOSE,   // obj = dataset_id
+    IO_READ,            // obj = dataset_id, [row, col] + rows x cols -> buf (行跨度 ld)
+    IO_WRITE,           // obj = dataset_id, buf -> [row, col] + rows x cols
+    IO_WRITE_CHUNK,     // obj = dataset_id, 分块起点 [row, col], data/data_size/filter_mask
+    IO_READ_CHUNK,      // obj = dataset_id, 分块起点 [row, col] -> raw (容量 data_size), filter_mask
+    IO_CALLBACK,        // 在 I/O 线程上执行 callback(req)，用于组合多个 HDF5 调用
+    IO_SHUTDOWN
+} hdf5_io_op_t;
+
+// 请求完成状态 (hdf5_io_req_t.done)：等待方自旋 IO_SPIN_LIMIT 次后置为 IO_REQ_WAITING 并在 futex 上阻塞，
+// I/O 线程完成请求时只在看到 IO_REQ_WAITING 时才调用 futex 唤醒
+enum { IO_REQ_PENDING, IO_REQ_DONE, IO_REQ_WAITING };
+#define IO_SPIN_LIMIT 256
+
+static void futex_wait(atomic_int *word, int value) {
+    syscall(SYS_futex, (int*)word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static void futex_wake_all(atomic_int *word) {
+    syscall(SYS_futex, (int*)word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * 等待 *word 不再等于 value：先自旋（让出 CPU）IO_SPIN_LIMIT 次，之后在 futex 上阻塞，
+ * 修改 *word 的一方需要随后调用 futex_wake_all
+ */
+static void futex_wait_while(atomic_int *word, int value) {
+    for (int spin = 0; atomic_load_explicit(word, memory_order_acquire) == value; spin++) {
+        if (spin < IO_SPIN_LIMIT)
+            sched_yield();
+        else
+            futex_wait(word, value);
+    }
+}
+
+typedef struct hdf5_io_req {
+    struct hdf5_io_req *_Atomic next;   // MPSC 队列链接（由队列使用）
+    hdf5_io_op_t op;
+    hid_t obj;
+    const char *name;
+    unsigned flags;
+    hid_t plist;                        // 数据集创建 / 文件访问属性列表，0 表示 H5P_DEFAULT（文件访问为 file_fapl）
+    hid_t fcpl;                         // 文件创建属性列表（IO_FILE_CREATE），0 表示 H5P_DEFAULT
+    hid_t type;                         // 数据集文件类型 / 读写内存类型，0 表示 double（此时读写 buf，否则 raw）
+    hsize_t row, col, rows, cols, ld;
+    double *buf;
+    const void *data;                   // 直接分块写入的已编码数据
+    size_t data_size;
+    uint32_t filter_mask;
+    void *raw;                          // 直接分块读取的目标缓冲区 / 按 type 读写的缓冲区
+    void (*callback)(struct hdf5_io_req *req);
+    void *arg;
+    hid_t result;                       // 句柄或 herr_t 状态，<0 表示失败
+    atomic_int done;                    // IO_REQ_PENDING / IO_REQ_DONE / IO_REQ_WAITING
+} hdf5_io_req_t;
+
+typedef struct {
+    hdf5_io_req_t *_Atomic head;        // 生产者端
+    hdf5_io_req_t *tail;                // 消费者端（仅 I/O 线程访问）
+    hdf5_io_req_t stub;
+    sem_t pending;
+    pthread_t thread;
+    int running;
+    long completed;
+} hdf5_io_service_t;
+
+static hdf5_io_service_t io_service;
+
+static void io_queue_push(hdf5_io_service_t *q, hdf5_io_req_t *req) {
+    atomic_store_explicit(&req->next, NULL, memory_order_relaxed);
+    hdf5_io_req_t *prev = atomic_exchange_explicit(&q->head, req, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, req, memory_order_release);
+}
+
+// 仅由 I/O 线程调用；生产者入队尚未完成链接时返回 NULL
+static hdf5_io_req_t *io_queue_pop(hdf5_io_service_t *q) {
+    hdf5_io_req_t *tail = q->tail;
+    hdf5_io_req_t *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &q->stub) {
+        if (!next)
+            return NULL;
+        q->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    if (tail != atomic_load_explicit(&q->head, memory_order_acquire))
+        return NULL;
+    io_queue_push(q, &q->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+// 各请求类型对应的埋点操作；IO_READ/IO_WRITE 由 hdf5_tile_io 记录
+static const int io_trace_ops[] = {
+    [IO_FILE_CREATE] = TRACE_H5_FILE_CREATE, [IO_FILE_OPEN] = TRACE_H5_FILE_OPEN,
+    [IO_FILE_CLOSE] = TRACE_H5_FILE_CLOSE, [IO_DATASET_CREATE] = TRACE_H5_DSET_CREATE,
+    [IO_DATASET_OPEN] = TRACE_H5_DSET_OPEN, [IO_DATASET_CLOSE] = TRACE_H5_DSET_CLOSE,
+    [IO_READ] = -1, [IO_WRITE] = -1, [IO_WRITE_CHUNK] = TRACE_H5_WRITE_CHUNK,
+    [IO_READ_CHUNK] = TRACE_H5_READ_CHUNK, [IO_CALLBACK] = TRACE_H5_CALLBACK, [IO_SHUTDOWN] = -1
+};
+
+static void io_execute(hdf5_io_req_t *req) {
+    hid_t space_id;
+    hsize_t dims[2];
+    uint64_t bytes = 0, t0 = trace_begin();
+
+    switch (req->op) {
+    case IO_FILE_CREATE:
+        req->result = H5Fcreate(req->name, H5F_ACC_TRUNC, req->fcpl > 0 ? req->fcpl : H5P_DEFAULT,
+                                req->plist > 0 ? req->plist : file_fapl);
+        break;
+    case IO_FILE_OPEN:
+        req->result = H5Fopen(req->name, req->flags, req->plist > 0 ? req->plist : file_fapl);
+        break;
+    case IO_FILE_CLOSE:
+        req->result = H5Fclose(req->obj);
+        break;
+    case IO_DATASET_CREATE:
+        dims[0] = req->rows;
+        dims[1] = req->cols;
+        space_id = H5Screate_simple(2, dims, NULL);
+        req->result = H5Dcreate(req->obj, req->name, req->type > 0 ? req->type : H5T_IEEE_F64LE, space_id,
+                                H5P_DEFAULT, req->plist > 0 ? req->plist : H5P_DEFAULT, H5P_DEFAULT);
+        H5Sclose(space_id);
+        break;
+    case IO_DATASET_OPEN:
+        req->result = H5Dopen(req->obj, req->name, H5P_DEFAULT);
+        break;
+    case IO_DATASET_CLOSE:
+        req->result = H5Dclose(req->obj);
+        break;
+    case IO_READ:
+    case IO_WRITE:
+        if (req->type > 0)
+            req->result = hdf5_tile_io_typed(req->obj, req->op == IO_WRITE, req->row, req->col,
+                                             req->rows, req->cols, req->raw, req->ld, req->type);
+        else
+            req->result = hdf5_tile_io(req->obj, req->op == IO_WRITE, req->row, req->col,
+                                       req->rows, req->cols, req->buf, req->ld);
+        break;
+    case IO_WRITE_CHUNK:
+        dims[0] = req->row;
+        dims[1] = req->col;
+        req->result = H5Dwrite_chunk(req->obj, H5P_DEFAULT, req->filter_mask, dims,
+                                     req->data_size, req->data);
+        bytes = req->data_size;
+        break;
+    case IO_READ_CHUNK: {
+        hsize_t stored = 0;
+        dims[0] = req->row;
+        dims[1] = req->col;
+        if (H5Dget_chunk_storage_size(req->obj, dims, &stored) < 0 || stored > req->data_size) {
+            req->result = -1;
+            break;
+        }
+        req->result = H5Dread_chunk(req->obj, H5P_DEFAULT, dims, &req->filter_mask, req->raw);
+        bytes = stored;
+        break;
+    }
+    case IO_CALLBACK:
+        req->result = 0;        // 回调可以写入 <0 表示失败
+        req->callback(req);
+        break;
+    case IO_SHUTDOWN:
+        req->result = 0;
+        break;
+    }
+    if (io_trace_ops[req->op] >= 0)
+        trace_end((trace_op_t)io_trace_ops[req->op], t0, bytes);
+}
+
+static void *io_thread_main(void *arg) {
+    hdf5_io_service_t *svc = (hdf5_io_service_t*)arg;
+    if (process_cpus_saved)
+        sched_setaffinity(0, sizeof(process_cpus), &process_cpus);
+    trace_set_thread_name("hdf5-io");
+    for (;;) {
+        while (sem_wait(&svc->pending) != 0)
+            ;
+        // 信号量已计数但生产者还没链接好节点：窗口只有两条指令，生产者被抢占时才会退化为短暂休眠
+        hdf5_io_req_t *req;
+        for (int spin = 0; !(req = io_queue_pop(svc)); spin++) {
+            if (spin < IO_SPIN_LIMIT)
+                sched_yield();
+            else
+                nanosleep(&(struct timespec){0, 50000}, NULL);
+        }
+        hdf5_io_op_t op = req->op;
+        pthread_mutex_lock(&hdf5_lib_lock);
+        io_execute(req);
+        pthread_mutex_unlock(&hdf5_lib_lock);
+        svc->completed++;
+        // 置为完成之后不能再访问 req（等待方可能已经返回并释放它），futex 唤醒只使用地址
+        atomic_int *done = &req->done;
+        if (atomic_exchange_explicit(done, IO_REQ_DONE, memory_order_acq_rel) == IO_REQ_WAITING)
+            futex_wake_all(done);
+        if (op == IO_SHUTDOWN)
+            break;
+    }
+    return NULL;
+}
+
+/**
+ * 启动 HDF5 I/O 服务线程
+ * 服务运行期间，只有在没有未完成请求时，主线程才可以直接调用 HDF5 函数
+ */
+int hdf5_io_start(void) {
+    hdf5_io_service_t *svc = &io_service;
+    if (svc->running)
+        return 0;
+    atomic_store(&svc->stub.next, NULL);
+    atomic_store(&svc->head, &svc->stub);
+    svc->tail = &svc->stub;
+    svc->completed = 0;
+    if (sem_init(&svc->pending, 0, 0) != 0)
+        return -1;
+    if (pthread_create(&svc->thread, NULL, io_thread_main, svc) != 0) {
+        sem_destroy(&svc->pending);
+        return -1;
+    }
+    svc->running = 1;
+    return 0;
+}
+
+/**
+ * 异步提交 I/O 请求（任意线程可调用，无锁）
+ */
+void hdf5_io_submit(hdf5_io_req_t *req) {
+    if (hdf5_direct_depth) {
+        printf("Error: HDF5 request submitted inside a direct HDF5 section\n");
+        abort();
+    }
+    atomic_store_explicit(&req->done, IO_REQ_PENDING, memory_order_relaxed);
+    io_queue_push(&io_service, req);
+    sem_post(&io_service.pending);
+}
+
+/**
+ * 等待请求完成，返回结果句柄/状态
+ * 先自旋 IO_SPIN_LIMIT 次，仍未完成时在请求的 futex 上阻塞，不与 I/O 线程争抢 CPU
+ */
+hid_t hdf5_io_wait(hdf5_io_req_t *req) {
+    if (atomic_load_explicit(&req->done, memory_order_acquire) != IO_REQ_DONE) {
+        uint64_t t0 = trace_begin();
+        if (hdf5_direct_depth) {
+            printf("Error: HDF5 request awaited inside a direct HDF5 section\n");
+            abort();
+        }
+        for (int spin = 0; atomic_load_explicit(&req->done, memory_order_acquire) != IO_REQ_DONE; spin++) {
+            int expected = IO_REQ_PENDING;
+            if (spin < IO_SPIN_LIMIT)
+                sched_yield();
+            else if (atomic_compare_exchange_strong(&req->done, &expected, IO_REQ_WAITING) ||
+                     expected == IO_REQ_WAITING)
+                futex_wait(&req->done, IO_REQ_WAITING);
+        }
+        trace_end(TRACE_IO_WAIT, t0, 0);
+    }
+    return req->result;
+}
+
+// 同步调用：提交并等待
+static hid_t hdf5_io_call(hdf5_io_op_t op, hid_t obj, const char *name,
+                          hsize_t rows, hsize_t cols) {
+    hdf5_io_req_t req = {0};
+    req.op = op;
+    req.obj = obj;
+    req.name = name;
+    req.flags = H5F_ACC_RDONLY;
+    req.rows = rows;
+    req.cols = cols;
+    hdf5_io_submit(&req);
+    return hdf5_io_wait(&req);
+}
+
+// 填充一个行块读写请求
+static void hdf5_io_rows(hdf5_io_req_t *req, hdf5_io_op_t op, hid_t dataset_id,
+                         hsize_t row, hsize_t rows, hsize_t n, double *buf) {
+    memset(req, 0, sizeof(*req));
+    req->op = op;
+    req->obj = dataset_id;
+    req->row = row;
+    req->rows = rows;
+    req->cols = n;
+    req->ld = n;
+    req->buf = buf;
+}
+
+/**
+ * 停止 I/O 服务线程（等待队列中已提交的请求全部完成）
+ */
+void hdf5_io_stop(void) {
+    hdf5_io_service_t *svc = &io_service;
+    if (!svc->running)
+        return;
+    hdf5_io_call(IO_SHUTDOWN, -1, NULL, 0, 0);
+    pthread_join(svc->thread, NULL);
+    sem_destroy(&svc->pending);
+    svc->running = 0;
+}
+
+// ===================== 流式校验 =====================
+// 校验结果与线程数、读取方式、块大小无关：
+//   - CRC32C 覆盖原始字节：逐行计算（x86 上用 SSE4.2 crc32 指令），再按行序用 GF(2) 移位算子合并，
+//     结果等于对整个矩阵字节流的 CRC32C；
+//   - 求和对每行使用 8 路向量化的 Kahan 补偿求和，行间按行序做 Neumaier 补偿合并；
+//   - 同时统计 min/max（忽略 NaN）与 NaN 个数。
+// 行是最小计算单元，因此内存中整矩阵、文件中流式读取的任意行块得到完全相同的结果。
+// 写入时把校验和存为数据集的 "checksum" 属性，读取后只需重算一遍即可比对。
+
+#define CHECKSUM_LANES 8
+#define CRC32C_POLY 0x82F63B78u      // CRC32C (Castagnoli) 反射多项式
+#define CHECKSUM_ATTR "checksum"
+
+// 矩阵校验和（也是 "checksum" 属性的内存布局）
+typedef struct {
+    uint32_t crc32c;        // 原始字节的 CRC32C
+    uint64_t count;         // 元素个数
+    uint64_t nan_count;     // NaN 个数
+    double sum;             // 补偿求和（不含 NaN）
+    double min, max;        // 忽略 NaN
+} matrix_checksum_t;
+
+// 单行的部分结果
+typedef struct {
+    uint32_t crc;
+    uint64_t nan_count;
+    double sum, min, max;
+} row_checksum_t;
+
+// 按行序累积的校验状态
+typedef struct {
+    matrix_checksum_t cs;
+    double comp;                // 行间 Neumaier 补偿项
+    uint32_t row_shift[32];     // “追加一行字节”的 CRC 移位算子
+} checksum_acc_t;
+
+static uint32_t crc32c_table[256];
+static int crc32c_hw = -1;
+
+static void crc32c_init(void) {
+    if (crc32c_hw >= 0)
+        return;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = c & 1 ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        crc32c_table[i] = c;
+    }
+#if defined(__x86_64__) && defined(__GNUC__)
+    crc32c_hw = __builtin_cpu_supports("sse4.2");
+#else
+    crc32c_hw = 0;
+#endif
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_update_hw(uint32_t crc, const unsigned char *p, size_t len) {
+    uint64_t c = ~crc;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    uint32_t c32 = (uint32_t)c;
+    while (len--)
+        c32 = _mm_crc32_u8(c32, *p++);
+    return ~c32;
+}
+#endif
+
+/**
+ * 在 crc 后继续计算 len 字节的 CRC32C（crc 初值为 0）
+ */
+uint32_t crc32c_update(uint32_t crc, const void *buf, size_t len) {
+    const unsigned char *p = (const unsigned char*)buf;
+    crc32c_init();
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (crc32c_hw)
+        return crc32c_update_hw(crc, p, len);
+#endif
+    crc = ~crc;
+    while (len--)
+        crc = crc32c_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec) {
+    uint32_t sum = 0;
+    for (; vec; vec >>= 1, mat++)
+        if (vec & 1)
+            sum ^= *mat;
+    return sum;
+}
+
+static void gf2_matrix_square(uint32_t *square, const uint32_t *mat) {
+    for (int k = 0; k < 32; k++)
+        square[k] = gf2_matrix_times(mat, mat[k]);
+}
+
+/**
+ * 计算 CRC 移位算子：crc(A || B) = op(crc(A)) ^ crc(B)，其中 len = |B|
+ */
+static void crc32c_shift_operator(size_t len, uint32_t op[32]) {
+    uint32_t odd[32], even[32], tmp[32];
+    odd[0] = CRC32C_POLY;                   // 一个零比特的算子
+    for (int k = 1; k < 32; k++)
+        odd[k] = 1u << (k - 1);
+    gf2_matrix_square(even, odd);           // 两个零比特
+    gf2_matrix_square(odd, even);           // 四个零比特
+    for (int k = 0; k < 32; k++)
+        op[k] = 1u << k;
+
+    // 依次得到 1, 2, 4, ... 字节的算子，按 len 的二进制位组合
+    while (len) {
+        gf2_matrix_square(even, odd);
+        if (len & 1) {
+            for (int k = 0; k < 32; k++)
+                tmp[k] = gf2_matrix_times(even, op[k]);
+            memcpy(op, tmp, sizeof(tmp));
+        }
+        len >>= 1;
+        if (!len)
+            break;
+        gf2_matrix_square(odd, even);
+        if (len & 1) {
+            for (int k = 0; k < 32; k++)
+                tmp[k] = gf2_matrix_times(odd, op[k]);
+            memcpy(op, tmp, sizeof(tmp));
+        }
+        len >>= 1;
+    }
+}
+
+// Neumaier 补偿加法：(*sum, *comp) += v
+static inline void neumaier_add(double *sum, double *comp, double v) {
+    double t = *sum + v;
+    if (fabs(*sum) >= fabs(v))
+        *comp += (*sum - t) + v;
+    else
+        *comp += (v - t) + *sum;
+    *sum = t;
+}
+
+/**
+ * 单行的求和/极值/NaN 统计：8 路独立的 Kahan 累加器，各路运算相同，向量化后结果不变
+ */
+RNG_TARGET_CLONES
+static void checksum_row_stats(const double *restrict x, int n, row_checksum_t *r) {
+    double s[CHECKSUM_LANES], c[CHECKSUM_LANES], lo[CHECKSUM_LANES], hi[CHECKSUM_LANES];
+    uint64_t nans[CHECKSUM_LANES];
+    for (int l = 0; l < CHECKSUM_LANES; l++) {
+        s[l] = c[l] = 0.0;
+        lo[l] = INFINITY;
+        hi[l] = -INFINITY;
+        nans[l] = 0;
+    }
+    int full = n - n % CHECKSUM_LANES;
+    for (int j = 0; j <= n - CHECKSUM_LANES; j += CHECKSUM_LANES) {
+        #pragma omp simd
+        for (int l = 0; l < CHECKSUM_LANES; l++) {
+            double v = x[j + l];
+            int is_nan = v != v;
+            double y = (is_nan ? 0.0 : v) - c[l];
+            double t = s[l] + y;
+            c[l] = (t - s[l]) - y;
+            s[l] = t;
+            lo[l] = v < lo[l] ? v : lo[l];
+            hi[l] = v > hi[l] ? v : hi[l];
+            nans[l] += is_nan;
+        }
+    }
+    for (int j = full; j < n; j++) {
+        int l = j - full;
+        double v = x[j];
+        if (v != v) {
+            nans[l]++;
+            continue;
+        }
+        double y = v - c[l];
+        double t = s[l] + y;
+        c[l] = (t - s[l]) - y;
+        s[l] = t;
+        lo[l] = v < lo[l] ? v : lo[l];
+        hi[l] = v > hi[l] ? v : hi[l];
+    }
+
+    double sum = 0.0, comp = 0.0;
+    r->min = INFINITY;
+    r->max = -INFINITY;
+    r->nan_count = 0;
+    for (int l = 0; l < CHECKSUM_LANES; l++) {
+        neumaier_add(&sum, &comp, s[l]);
+        neumaier_add(&sum, &comp, -c[l]);
+        r->min = lo[l] < r->min ? lo[l] : r->min;
+        r->max = hi[l] > r->max ? hi[l] : r->max;
+        r->nan_count += nans[l];
+    }
+    r->sum = sum + comp;
+}
+
+void checksum_init(checksum_acc_t *acc, int n) {
+    crc32c_init();
+    memset(acc, 0, sizeof(*acc));
+    acc->cs.min = INFINITY;
+    acc->cs.max = -INFINITY;
+    crc32c_shift_operator((size_t)n * sizeof(double), acc->row_shift);
+}
+
+// 单行的部分结果（可在任意线程、以任意顺序计算）
+static void checksum_row(const double *row, int n, row_checksum_t *r) {
+    r->crc = crc32c_update(0, row, (size_t)n * sizeof(double));
+    checksum_row_stats(row, n, r);
+}
+
+/**
+ * 把 rows 个已算好的单行部分结果按行序合并进 acc
+ */
+void checksum_merge_rows(checksum_acc_t *acc, const row_checksum_t *partial, int rows, int n) {
+    for (int i = 0; i < rows; i++) {
+        acc->cs.crc32c = gf2_matrix_times(acc->row_shift, acc->cs.crc32c) ^ partial[i].crc;
+        neumaier_add(&acc->cs.sum, &acc->comp, partial[i].sum);
+        acc->cs.min = partial[i].min < acc->cs.min ? partial[i].min : acc->cs.min;
+        acc->cs.max = partial[i].max > acc->cs.max ? partial[i].max : acc->cs.max;
+        acc->cs.nan_count += partial[i].nan_count;
+    }
+    acc->cs.count += (uint64_t)rows * n;
+}
+
+/**
+ * 计算一个行块（rows x n，行跨度 n）的校验并按行序合并进 acc
+ * 行内计算在 OpenMP 线程间并行，合并顺序固定
+ *
+ * @param partial 至少 rows 个元素的临时数组
+ */
+void checksum_rows(checksum_acc_t *acc, const double *block, int rows, int n, row_checksum_t *partial) {
+    size_t row_bytes = (size_t)n * sizeof(double);
+    #pragma omp parallel
+    {
+        uint64_t t0 = trace_begin();
+        int my_rows = 0;
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < rows; i++) {
+            checksum_row(block + (size_t)i * n, n, &partial[i]);
+            my_rows++;
+        }
+        trace_end(TRACE_CHECKSUM, t0, (uint64_t)my_rows * row_bytes);
+    }
+    checksum_merge_rows(acc, partial, rows, n);
+}
+
+void checksum_final(const checksum_acc_t *acc, matrix_checksum_t *cs) {
+    *cs = acc->cs;
+    cs->sum = acc->cs.sum + acc->comp;
+}
+
+/**
+ * 计算内存中 rows x n 矩阵的校验和
+ *
+ * @return 0 成功，-1 内存分配失败
+ */
+int checksum_matrix(const double *matrix, int rows, int n, matrix_checksum_t *cs) {
+    checksum_acc_t acc;
+    size_t partial_bytes = (size_t)(rows > 0 ? rows : 1) * sizeof(row_checksum_t);
+    row_checksum_t *partial = (row_checksum_t*)pool_alloc(partial_bytes);
+    if (!partial)
+        return -1;
+    checksum_init(&acc, n);
+    checksum_rows(&acc, matrix, rows, n, partial);
+    checksum_final(&acc, cs);
+    pool_free(partial, partial_bytes);
+    return 0;
+}
+
+int checksum_equal(const matrix_checksum_t *a, const matrix_checksum_t *b) {
+    return a->crc32c == b->crc32c && a->count == b->count && a->nan_count == b->nan_count &&
+           memcmp(&a->sum, &b->sum, sizeof(double)) == 0 &&
+           memcmp(&a->min, &b->min, sizeof(double)) == 0 &&
+           memcmp(&a->max, &b->max, sizeof(double)) == 0;
+}
+
+static hid_t checksum_h5type(void) {
+    hid_t type_id = H5Tcreate(H5T_COMPOUND, sizeof(matrix_checksum_t));
+    H5Tinsert(type_id, "crc32c", HOFFSET(matrix_checksum_t, crc32c), H5T_NATIVE_UINT32);
+    H5Tinsert(type_id, "count", HOFFSET(matrix_checksum_t, count), H5T_NATIVE_UINT64);
+    H5Tinsert(type_id, "nan_count", HOFFSET(matrix_checksum_t, nan_count), H5T_NATIVE_UINT64);
+    H5Tinsert(type_id, "sum", HOFFSET(matrix_checksum_t, sum), H5T_NATIVE_DOUBLE);
+    H5Tinsert(type_id, "min", HOFFSET(matrix_checksum_t, min), H5T_NATIVE_DOUBLE);
+    H5Tinsert(type_id, "max", HOFFSET(matrix_checksum_t, max), H5T_NATIVE_DOUBLE);
+    return type_id;
+}
+
+/**
+ * 将校验和写为数据集的 "checksum" 属性（已存在时覆盖）
+ */
+herr_t write_checksum_attr(hid_t dataset_id, const matrix_checksum_t *cs) {
+    herr_t status = -1;
+    hid_t type_id = checksum_h5type();
+    hid_t space_id = H5Screate(H5S_SCALAR);
+    if (H5Aexists(dataset_id, CHECKSUM_ATTR) > 0)
+        H5Adelete(dataset_id, CHECKSUM_ATTR);
+    hid_t attr_id = H5Acreate(dataset_id, CHECKSUM_ATTR, type_id, space_id, H5P_DEFAULT, H5P_DEFAULT);
+    if (attr_id >= 0) {
+        status = H5Awrite(attr_id, type_id, cs);
+        H5Aclose(attr_id);
+    }
+    H5Sclose(space_id);
+    H5Tclose(type_id);
+    return status;
+}
+
+/**
+ * 读取数据集的 "checksum" 属性
+ *
+ * @return 0 成功，-1 属性不存在或读取失败
+ */
+herr_t read_checksum_attr(hid_t dataset_id, matrix_checksum_t *cs) {
+    herr_t status = -1;
+    if (H5Aexists(dataset_id, CHECKSUM_ATTR) <= 0)
+        return -1;
+    hid_t type_id = checksum_h5type();
+    hid_t attr_id = H5Aopen(dataset_id, CHECKSUM_ATTR, H5P_DEFAULT);
+    if (attr_id >= 0) {
+        status = H5Aread(attr_id, type_id, cs);
+        H5Aclose(attr_id);
+    }
+    H5Tclose(type_id);
+    return status;
+}
+
+// 在 I/O 线程上读写校验和属性：obj = dataset_id，arg = matrix_checksum_t*
+static void io_write_checksum_callback(hdf5_io_req_t *req) {
+    req->result = write_checksum_attr(req->obj, (const matrix_checksum_t*)req->arg);
+}
+
+static void io_read_checksum_callback(hdf5_io_req_t *req) {
+    req->result = read_checksum_attr(req->obj, (matrix_checksum_t*)req->arg);
+}
+
+static hid_t hdf5_io_checksum(hid_t dataset_id, matrix_checksum_t *cs, int write) {
+    hdf5_io_req_t req = {0};
+    req.op = IO_CALLBACK;
+    req.obj = dataset_id;
+    req.callback = write ? io_write_checksum_callback : io_read_checksum_callback;
+    req.arg = cs;
+    hdf5_io_submit(&req);
+    return hdf5_io_wait(&req);
+}
+
+/**
+ * 直接从文件流式校验数据集，不需要整矩阵驻留内存
+ * I/O 线程读取第 k+1 个行块的同时，计算线程校验第 k 个行块
+ *
+ * @param filename 文件名
+ * @param dataset_name 数据集名称（n x n）
+ * @param n 矩阵维度
+ * @param block_rows 每块行数
+ * @param computed 输出：重新计算的校验和
+ * @param stored 输出：写入时保存的校验和，属性不存在时 count 为 0；可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int checksum_dataset_hdf5(const char *filename, const char *dataset_name, int n, int block_rows,
+                          matrix_checksum_t *computed, matrix_checksum_t *stored) {
+    if (block_rows <= 0 || block_rows > n)
+        block_rows = n;
+    hid_t file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    if (file_id < 0) {
+        printf("Error: Failed to open HDF5 file %s\n", filename);
+        return -1;
+    }
+    hid_t dataset_id = hdf5_io_call(IO_DATASET_OPEN, file_id, dataset_name, 0, 0);
+    if (dataset_id < 0) {
+        printf("Error: Failed to open dataset %s\n", dataset_name);
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+        return -1;
+    }
+    if (stored && hdf5_io_checksum(dataset_id, stored, 0) < 0)
+        memset(stored, 0, sizeof(*stored));
+
+    int ret = 0;
+    size_t block_bytes = (size_t)block_rows * n * sizeof(double);
+    size_t partial_bytes = (size_t)block_rows * sizeof(row_checksum_t);
+    double *buf[2] = {(double*)pool_alloc(block_bytes), (double*)pool_alloc(block_bytes)};
+    row_checksum_t *partial = (row_checksum_t*)pool_alloc(partial_bytes);
+    hdf5_io_req_t reqs[2];
+    checksum_acc_t acc;
+    checksum_init(&acc, n);
+
+    if (!buf[0] || !buf[1] || !partial) {
+        printf("Error: Failed to allocate checksum buffers\n");
+        ret = -1;
+    } else {
+        int cur = 0;
+        hdf5_io_rows(&reqs[0], IO_READ, dataset_id, 0, block_rows, n, buf[0]);
+        hdf5_io_submit(&reqs[0]);
+        for (int row = 0; row < n; row += block_rows, cur ^= 1) {
+            int rows = n - row < block_rows ? n - row : block_rows;
+            int next = row + block_rows;
+            if (hdf5_io_wait(&reqs[cur]) < 0)
+                ret = -1;
+            if (next < n) {
+                int next_rows = n - next < block_rows ? n - next : block_rows;
+                hdf5_io_rows(&reqs[cur ^ 1], IO_READ, dataset_id, next, next_rows, n, buf[cur ^ 1]);
+                hdf5_io_submit(&reqs[cur ^ 1]);
+            }
+            if (ret == 0)
+                checksum_rows(&acc, buf[cur], rows, n, partial);
+        }
+        if (ret < 0)
+            printf("Error: Failed to read dataset %s\n", dataset_name);
+    }
+    checksum_final(&acc, computed);
+
+    pool_free(buf[0], block_bytes);
+    pool_free(buf[1], block_bytes);
+    pool_free(partial, partial_bytes);
+    hdf5_io_call(IO_DATASET_CLOSE, dataset_id, NULL, 0, 0);
+    hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    return ret;
+}
+
+void print_checksum(const char *label, const matrix_checksum_t *cs) {
+    printf("%s: crc32c=%08x sum=%.10e min=%.6f max=%.6f NaN=%llu\n", label, cs->crc32c, cs->sum,
+           cs->min, cs->max, (unsigned long long)cs->nan_count);
+}
+
+// ===================== 分块压缩存储布局 =====================
+
+// 数据集存储布局配置
+typedef struct {
+    int chunked;            // 0 = 连续存储，1 = 分块存储
+    hsize_t chunk_dims[2];  // 分块形状（行 x 列）
+    int shuffle;            // 是否启用 shuffle 过滤器
+    int deflate_level;      // deflate 压缩级别，0 表示不压缩
+    int transposed;         // 同一遍写入中额外写出转置副本 <name>_T（仅分块布局）
+    int morton;             // 按 Morton (Z-order) 顺序写分块，并生成分块索引数据集 <name>_tile_index
+} hdf5_layout_t;
+
+// 压缩写入统计
+typedef struct {
+    double raw_bytes;         // 原始数据字节数（不含边缘分块的填充）
+    double compressed_bytes;  // 压缩后字节数
+    double compress_time;     // 所有线程压缩耗时之和（秒）
+    long chunks;              // 写入的分块数
+} compress_stats_t;
+
+/**
+ * 根据布局配置创建数据集创建属性列表 (dcpl)
+ * 连续布局返回 H5P_DEFAULT，否则调用者负责 H5Pclose
+ *
+ * @param transposed 1 表示为转置副本创建（分块形状行列互换）
+ */
+hid_t make_layout_dcpl_ex(const hdf5_layout_t *layout, int transposed) {
+    if (!layout || !layout->chunked)
+        return H5P_DEFAULT;
+    hsize_t dims[2] = {layout->chunk_dims[transposed ? 1 : 0], layout->chunk_dims[transposed ? 0 : 1]};
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, 2, dims);
+    if (layout->shuffle)
+        H5Pset_shuffle(dcpl);
+    if (layout->deflate_level > 0)
+        H5Pset_deflate(dcpl, layout->deflate_level);
+    return dcpl;
+}
+
+hid_t make_layout_dcpl(const hdf5_layout_t *layout) {
+    return make_layout_dcpl_ex(layout, 0);
+}
+
+// 与 HDF5 shuffle 过滤器相同的字节重排：第 i 个元素的第 j 个字节放到 j*count + i
+static void shuffle_bytes(const unsigned char *src, unsigned char *dst,
+                          size_t count, size_t elem_size) {
+    for (size_t i = 0; i < count; i++)
+        for (size_t j = 0; j < elem_size; j++)
+            dst[j*count + i] = src[i*elem_size + j];
+}
+
+/**
+ * 把矩阵从 (row, col) 开始的 cr x cc 分块拷贝到 chunk，越过矩阵边界的部分补零
+ * （HDF5 分块总是完整大小）
+ */
+static void stage_chunk(const double *matrix, int n, hsize_t row, hsize_t col,
+                        hsize_t cr, hsize_t cc, double *chunk) {
+    for (hsize_t i = 0; i < cr; i++) {
+        double *dst = chunk + i * cc;
+        if (row + i >= (hsize_t)n) {
+            memset(dst, 0, cc * sizeof(double));
+            continue;
+        }
+        hsize_t valid = col + cc <= (hsize_t)n ? cc : n - col;
+        memcpy(dst, matrix + (row + i) * n + col, valid * sizeof(double));
+        if (valid < cc)
+            memset(dst + valid, 0, (cc - valid) * sizeof(double));
+    }
+}
+
+#define TRANSPOSE_BLOCK 8
+
+/**
+ * 分块转置：src 为 rows x cols（行跨度 cols），dst 为 cols x rows
+ * 按 8x8 小块访问，读写两侧都保持缓存行局部性
+ */
+static void transpose_chunk(const double *restrict src, hsize_t rows, hsize_t cols, double *restrict dst) {
+    for (hsize_t i0 = 0; i0 < rows; i0 += TRANSPOSE_BLOCK)
+        for (hsize_t j0 = 0; j0 < cols; j0 += TRANSPOSE_BLOCK) {
+            hsize_t i1 = i0 + TRANSPOSE_BLOCK < rows ? i0 + TRANSPOSE_BLOCK : rows;
+            hsize_t j1 = j0 + TRANSPOSE_BLOCK < cols ? j0 + TRANSPOSE_BLOCK : cols;
+            for (hsize_t i = i0; i < i1; i++)
+                for (hsize_t j = j0; j < j1; j++)
+                    dst[j * rows + i] = src[i * cols + j];
+        }
+}
+
+/**
+ * 将已暂存的分块按照 HDF5 过滤器管线（shuffle -> deflate）编码
+ *
+ * @param count 分块元素数
+ * @param stage 临时缓冲区，count * sizeof(double) 字节
+ * @param out 输出缓冲区，至少 compressBound(chunk_bytes) 字节
+ * @return 编码后的字节数，失败返回 0
+ */
+static size_t encode_chunk(const double *chunk, size_t count, const hdf5_layout_t *layout,
+                           unsigned char *stage, unsigned char *out, size_t out_capacity) {
+    size_t bytes = count * sizeof(double);
+    const unsigned char *payload = (const unsigned char*)chunk;
+    if (layout->shuffle) {
+        shuffle_bytes(payload, stage, count, sizeof(double));
+        payload = stage;
+    }
+    if (layout->deflate_level <= 0) {
+        memcpy(out, payload, bytes);
+        return bytes;
+    }
+    uLongf out_len = (uLongf)out_capacity;
+    if (compress2(out, &out_len, payload, (uLong)bytes, layout->deflate_level) != Z_OK)
+        return 0;
+    return (size_t)out_len;
+}
+
+// ---------- Morton (Z-order) 分块顺序与分块索引 ----------
+
+// 分块坐标（以分块为单位）及其 Morton 码
+typedef struct {
+    uint64_t morton;
+    uint32_t tile_row, tile_col;
+} tile_coord_t;
+
+// 分块索引数据集的一项
+typedef struct {
+    uint64_t morton;
+    uint32_t tile_row, tile_col;
+    uint64_t addr;              // 分块在文件中的字节偏移
+    uint64_t size;              // 存储字节数
+} tile_index_entry_t;
+
+// 把 32 位整数的各位间隔一位展开
+static uint64_t morton_spread(uint32_t v) {
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8))  & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2))  & 0x3333333333333333ull;
+    x = (x | (x << 1))  & 0x5555555555555555ull;
+    return x;
+}
+
+static uint64_t morton_encode(uint32_t tile_row, uint32_t tile_col) {
+    return morton_spread(tile_row) << 1 | morton_spread(tile_col);
+}
+
+static int compare_tile_morton(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;   // 两种结构体的首字段都是 morton
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * 生成 grid_rows x grid_cols 个分块的写入顺序：morton = 1 时按 Z-order，否则按行主序
+ * 调用者负责 free
+ */
+tile_coord_t *make_tile_order(long grid_rows, long grid_cols, int morton) {
+    size_t count = (size_t)(grid_rows * grid_cols);
+    tile_coord_t *order = (tile_coord_t*)malloc((count ? count : 1) * sizeof(tile_coord_t));
+    if (!order)
+        return NULL;
+    for (long r = 0; r < grid_rows; r++)
+        for (long c = 0; c < grid_cols; c++) {
+            tile_coord_t *t = &order[r * grid_cols + c];
+            t->tile_row = (uint32_t)r;
+            t->tile_col = (uint32_t)c;
+            t->morton = morton_encode((uint32_t)r, (uint32_t)c);
+        }
+    if (morton)
+        qsort(order, count, sizeof(tile_coord_t), compare_tile_morton);
+    return order;
+}
+
+static hid_t tile_index_h5type(void) {
+    hid_t type_id = H5Tcreate(H5T_COMPOUND, sizeof(tile_index_entry_t));
+    H5Tinsert(type_id, "morton", HOFFSET(tile_index_entry_t, morton), H5T_NATIVE_UINT64);
+    H5Tinsert(type_id, "tile_row", HOFFSET(tile_index_entry_t, tile_row), H5T_NATIVE_UINT32);
+    H5Tinsert(type_id, "tile_col", HOFFSET(tile_index_entry_t, tile_col), H5T_NATIVE_UINT32);
+    H5Tinsert(type_id, "addr", HOFFSET(tile_index_entry_t, addr), H5T_NATIVE_UINT64);
+    H5Tinsert(type_id, "size", HOFFSET(tile_index_entry_t, size), H5T_NATIVE_UINT64);
+    return type_id;
+}
+
+/**
+ * 为分块数据集生成按 Morton 码排序的分块索引数据集 <dataset_name>_tile_index
+ * 每项记录分块坐标、文件地址与存储大小，读取区域时可据此把地址相邻的分块合并成一次 I/O
+ */
+herr_t write_tile_index(hid_t file_id, const char *dataset_name) {
+    herr_t status = -1;
+    hid_t dataset_id = H5Dopen(file_id, dataset_name, H5P_DEFAULT);
+    if (dataset_id < 0)
+        return -1;
+    hid_t dcpl = H5Dget_create_plist(dataset_id);
+    hid_t space_id = H5Dget_space(dataset_id);
+    hsize_t chunk_dims[2], nchunks = 0;
+    tile_index_entry_t *entries = NULL;
+
+    if (H5Pget_layout(dcpl) == H5D_CHUNKED && H5Pget_chunk(dcpl, 2, chunk_dims) == 2 &&
+        H5Dget_num_chunks(dataset_id, space_id, &nchunks) >= 0 &&
+        (entries = (tile_index_entry_t*)malloc((nchunks ? nchunks : 1) * sizeof(tile_index_entry_t)))) {
+        status = 0;
+        for (hsize_t k = 0; k < nchunks && status == 0; k++) {
+            hsize_t offset[2], size;
+            unsigned mask;
+            haddr_t addr;
+            if (H5Dget_chunk_info(dataset_id, space_id, k, offset, &mask, &addr, &size) < 0) {
+                status = -1;
+                break;
+            }
+            entries[k].tile_row = (uint32_t)(offset[0] / chunk_dims[0]);
+            entries[k].tile_col = (uint32_t)(offset[1] / chunk_dims[1]);
+            entries[k].morton = morton_encode(entries[k].tile_row, entries[k].tile_col);
+            entries[k].addr = addr;
+            entries[k].size = size;
+        }
+        if (status == 0) {
+            char index_name[80];
+            hsize_t dims[1] = {nchunks};
+            qsort(entries, nchunks, sizeof(tile_index_entry_t), compare_tile_morton);
+            snprintf(index_name, sizeof(index_name), "%s_tile_index", dataset_name);
+            if (H5Lexists(file_id, index_name, H5P_DEFAULT) > 0)
+                H5Ldelete(file_id, index_name, H5P_DEFAULT);
+            hid_t type_id = tile_index_h5type();
+            hid_t index_space = H5Screate_simple(1, dims, NULL);
+            hid_t index_id = H5Dcreate(file_id, index_name, type_id, index_space,
+                                       H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+            status = index_id < 0 ? -1 : H5Dwrite(index_id, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, entries);
+            if (index_id >= 0) H5Dclose(index_id);
+            H5Sclose(index_space);
+            H5Tclose(type_id);
+        }
+    }
+    free(entries);
+    if (space_id >= 0) H5Sclose(space_id);
+    if (dcpl >= 0) H5Pclose(dcpl);
+    H5Dclose(dataset_id);
+    return status;
+}
+
+/**
+ * 读取 <dataset_name>_tile_index，调用者负责 free(*entries)
+ *
+ * @return 0 成功，-1 失败
+ */
+int read_tile_index(hid_t file_id, const char *dataset_name, tile_index_entry_t **entries, size_t *count) {
+    char index_name[80];
+    snprintf(index_name, sizeof(index_name), "%s_tile_index", dataset_name);
+    *entries = NULL;
+    *count = 0;
+    hid_t index_id = H5Dopen(file_id, index_name, H5P_DEFAULT);
+    if (index_id < 0)
+        return -1;
+    hid_t space_id = H5Dget_space(index_id);
+    hid_t type_id = tile_index_h5type();
+    hssize_t npoints = H5Sget_simple_extent_npoints(space_id);
+    int ret = -1;
+    if (npoints >= 0 && (*entries = (tile_index_entry_t*)malloc(((size_t)npoints ? (size_t)npoints : 1) *
+                                                                sizeof(tile_index_entry_t)))) {
+        ret = H5Dread(index_id, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, *entries) < 0 ? -1 : 0;
+        *count = (size_t)npoints;
+    }
+    H5Tclose(type_id);
+    H5Sclose(space_id);
+    H5Dclose(index_id);
+    return ret;
+}
+
+static int compare_tile_addr(const void *a, const void *b) {
+    const tile_index_entry_t *x = (const tile_index_entry_t*)a, *y = (const tile_index_entry_t*)b;
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+/**
+ * 统计读取 [row, row+rows) x [col, col+cols) 区域所需的文件 I/O 次数：
+ * 覆盖区域的分块按地址排序后，首尾相接的分块合并为一次连续读取
+ */
+long tile_index_io_runs(const tile_index_entry_t *entries, size_t count, const hsize_t tile[2],
+                        hsize_t row, hsize_t col, hsize_t rows, hsize_t cols) {
+    tile_index_entry_t *hit = (tile_index_entry_t*)malloc((count ? count : 1) * sizeof(tile_index_entry_t));
+    size_t nhit = 0;
+    long runs = 0;
+    if (!hit)
+        return -1;
+    for (size_t k = 0; k < count; k++) {
+        hsize_t r0 = (hsize_t)entries[k].tile_row * tile[0], c0 = (hsize_t)entries[k].tile_col * tile[1];
+        if (r0 < row + rows && r0 + tile[0] > row && c0 < col + cols && c0 + tile[1] > col)
+            hit[nhit++] = entries[k];
+    }
+    qsort(hit, nhit, sizeof(tile_index_entry_t), compare_tile_addr);
+    for (size_t k = 0; k < nhit; k++)
+        if (k == 0 || hit[k - 1].addr + hit[k - 1].size != hit[k].addr)
+            runs++;
+    free(hit);
+    return runs;
+}
+
+// 在 I/O 线程上生成分块索引：obj = file_id，name = 数据集名称
+static void io_tile_index_callback(hdf5_io_req_t *req) {
+    req->result = write_tile_index(req->obj, req->name);
+}
+
+#define COMPRESS_INFLIGHT 4     // 每个压缩线程最多同时挂起的直接写分块数
+
+/**
+ * 并行压缩 + 直接分块写入
+ * OpenMP 线程各自压缩分块，I/O 线程作为唯一写者用 H5Dwrite_chunk 提交压缩后的分块，
+ * 压缩不再被 HDF5 过滤器管线串行化。
+ * layout->transposed 时，每个分块暂存后就地转置，同一遍写出 /matrix_i_T 的对应分块；
+ * layout->morton 时按 Z-order 提交分块（分块文件空间按写入顺序分配），并写出分块索引。
+ *
+ * @param filename 文件名
+ * @param matrices 矩阵数组指针
+ * @param n 矩阵维度
+ * @param num_matrices 矩阵数量
+ * @param layout 分块布局（必须为分块存储）
+ * @param stats 输出压缩统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int parallel_write_hdf5_compressed(const char* filename, double **matrices, int n, int num_matrices,
+                                   const hdf5_layout_t *layout, compress_stats_t *stats) {
+    progress_printf("  [Parallel] Compress and write %d %dx%d matrices (chunk %llux%llu, shuffle=%d, deflate=%d%s%s)...\n",
+           num_matrices, n, n, (unsigned long long)layout->chunk_dims[0],
+           (unsigned long long)layout->chunk_dims[1], layout->shuffle, layout->deflate_level,
+           layout->transposed ? ", transposed copy" : "", layout->morton ? ", Z-order" : "");
+
+    compress_stats_t st = {0};
+    const int copies = layout->transposed ? 2 : 1;
+    hid_t file_id, dataset_ids[copies][num_matrices];
+    char dataset_names[copies][num_matrices][50];
+    int ret = 0;
+
+    file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0);
+    if (file_id < 0) {
+        printf("Error: Failed to create HDF5 file\n");
+        return -1;
+    }
+    hdf5_direct_begin();
+    hid_t dcpl[2] = {make_layout_dcpl_ex(layout, 0), make_layout_dcpl_ex(layout, 1)};
+    hdf5_direct_end();
+    for (int v = 0; v < copies; v++)
+    for (int i = 0; i < num_matrices; i++) {
+        hdf5_io_req_t req = {0};
+        sprintf(dataset_names[v][i], v ? "/matrix_%d_T" : "/matrix_%d", i);
+        req.op = IO_DATASET_CREATE;
+        req.obj = file_id;
+        req.name = dataset_names[v][i];
+        req.rows = n;
+        req.cols = n;
+        req.plist = dcpl[v];
+        hdf5_io_submit(&req);
+        dataset_ids[v][i] = hdf5_io_wait(&req);
+        if (dataset_ids[v][i] < 0) {
+            printf("Error: Failed to create dataset %s\n", dataset_names[v][i]);
+            ret = -1;
+        }
+    }
+
+    hsize_t cr = layout->chunk_dims[0], cc = layout->chunk_dims[1];
+    long chunk_rows = (n + cr - 1) / cr, chunk_cols = (n + cc - 1) / cc;
+    long chunks_per_matrix = chunk_rows * chunk_cols;
+    long total_chunks = chunks_per_matrix * num_matrices;
+    size_t chunk_count = (size_t)cr * cc;
+    size_t chunk_bytes = chunk_count * sizeof(double);
+    size_t out_capacity = compressBound((uLong)chunk_bytes);
+    tile_coord_t *order = make_tile_order(chunk_rows, chunk_cols, layout->morton);
+    long failed = 0;
+    if (!order) {
+        printf("Error: Failed to allocate chunk order\n");
+        total_chunks = 0;
+        ret = -1;
+    }
+
+    #pragma omp parallel reduction(+:failed)
+    {
+        hdf5_io_req_t reqs[COMPRESS_INFLIGHT];
+        unsigned char *outs[COMPRESS_INFLIGHT];
+        // 暂存分块 | 转置分块 | shuffle 暂存
+        unsigned char *scratch = (unsigned char*)pool_alloc(3 * chunk_bytes);
+        double *chunk = (double*)scratch, *tchunk = (double*)(scratch + chunk_bytes);
+        unsigned char *stage = scratch + 2 * chunk_bytes;
+        int slot = 0, ok = scratch != NULL;
+        double my_compress = 0.0, my_raw = 0.0, my_comp = 0.0;
+        long my_chunks = 0;
+
+        for (int s = 0; s < COMPRESS_INFLIGHT; s++) {
+            reqs[s].op = IO_SHUTDOWN;   // 标记为空闲槽位
+            atomic_init(&reqs[s].done, IO_REQ_DONE);
+            outs[s] = (unsigned char*)pool_alloc(out_capacity);
+            if (!outs[s]) ok = 0;
+        }
+
+        #pragma omp for schedule(dynamic)
+        for (long c = 0; c < total_chunks; c++) {
+            int i = (int)(c / chunks_per_matrix);
+            const tile_coord_t *t = &order[c % chunks_per_matrix];
+            hsize_t row = (hsize_t)t->tile_row * cr;
+            hsize_t col = (hsize_t)t->tile_col * cc;
+            if (!ok || dataset_ids[0][i] < 0 || (copies > 1 && dataset_ids[1][i] < 0)) {
+                failed++;
+                continue;
+            }
+            stage_chunk(matrices[i], n, row, col, cr, cc, chunk);
+
+            for (int v = 0; v < copies; v++) {
+                // 复用槽位前等待上一次写入完成
+                hdf5_io_req_t *req = &reqs[slot];
+                if (req->op == IO_WRITE_CHUNK && hdf5_io_wait(req) < 0)
+                    failed++;
+
+                double t0 = omp_get_wtime();
+                uint64_t span = trace_begin();
+                if (v)
+                    transpose_chunk(chunk, cr, cc, tchunk);
+                size_t size = encode_chunk(v ? tchunk : chunk, chunk_count, layout, stage,
+                                           outs[slot], out_capacity);
+                trace_end(TRACE_ENCODE, span, chunk_bytes);
+                my_compress += omp_get_wtime() - t0;
+                if (size == 0) {
+                    failed++;
+                    req->op = IO_SHUTDOWN;
+                    continue;
+                }
+
+                memset(req, 0, sizeof(*req));
+                req->op = IO_WRITE_CHUNK;
+                req->obj = dataset_ids[v][i];
+                req->row = v ? col : row;
+                req->col = v ? row : col;
+                req->data = outs[slot];
+                req->data_size = size;
+                req->filter_mask = 0;
+                hdf5_io_submit(req);
+                slot = (slot + 1) % COMPRESS_INFLIGHT;
+
+                hsize_t valid_rows = row + cr <= (hsize_t)n ? cr : n - row;
+                hsize_t valid_cols = col + cc <= (hsize_t)n ? cc : n - col;
+                my_raw += (double)(valid_rows * valid_cols * sizeof(double));
+                my_comp += (double)size;
+                my_chunks++;
+            }
+        }
+
+        for (int s = 0; s < COMPRESS_INFLIGHT; s++) {
+            if (reqs[s].op == IO_WRITE_CHUNK && hdf5_io_wait(&reqs[s]) < 0)
+                failed++;
+            pool_free(outs[s], out_capacity);
+        }
+        pool_free(scratch, 3 * chunk_bytes);
+
+        #pragma omp critical
+        {
+            st.compress_time += my_compress;
+            st.raw_bytes += my_raw;
+            st.compressed_bytes += my_comp;
+            st.chunks += my_chunks;
+        }
+    }
+    free(order);
+
+    for (int i = 0; i < num_matrices; i++) {
+        matrix_checksum_t cs;
+        if (dataset_ids[0][i] < 0)
+            continue;
+        if (checksum_matrix(matrices[i], n, n, &cs) < 0 || hdf5_io_checksum(dataset_ids[0][i], &cs, 1) < 0) {
+            printf("Error: Failed to write checksum of dataset %s\n", dataset_names[0][i]);
+            ret = -1;
+        }
+    }
+    for (int v = 0; v < copies; v++)
+    for (int i = 0; i < num_matrices; i++) {
+        if (dataset_ids[v][i] < 0)
+            continue;
+        hdf5_io_call(IO_DATASET_CLOSE, dataset_ids[v][i], NULL, 0, 0);
+        if (layout->morton) {
+            hdf5_io_req_t req = {0};
+            req.op = IO_CALLBACK;
+            req.obj = file_id;
+            req.name = dataset_names[v][i];
+            req.callback = io_tile_index_callback;
+            hdf5_io_submit(&req);
+            if (hdf5_io_wait(&req) < 0) {
+                printf("Error: Failed to write tile index of %s\n", dataset_names[v][i]);
+                ret = -1;
+            }
+        }
+    }
+    if (hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0) < 0)
+        ret = -1;
+    hdf5_direct_begin();
+    for (int v = 0; v < 2; v++)
+        if (dcpl[v] != H5P_DEFAULT)
+            H5Pclose(dcpl[v]);
+    hdf5_direct_end();
+
+    if (failed > 0) {
+        printf("Error: Failed to write %ld of %ld chunks\n", failed, total_chunks * copies);
+        ret = -1;
+    }
+    if (stats)
+        *stats = st;
+    progress_printf("  [Parallel] Wrote %ld chunks to HDF5 file %s\n", st.chunks, filename);
+    return ret;
+}
+
+int parallel_write_hdf5(const char* filename, double **matrices, int n, int num_matrices) {
+/**
+ * 并行写入HDF5文件
+ * 演示：将大型矩阵数据并行写入多个数据集
+ * 
+ * @param filename 文件名
+ * @param matrices 矩阵数组指针
+ * @param n 矩阵维度
+ * @param num_matrices 矩阵数量
+ * @return 0 成功，-1 失败
+ */
+    progress_printf("  [Parallel] Create HDF5 file and write %d %dx%d matrices...\n", num_matrices, n, n);
+    
+    hid_t file_id, dataset_ids[num_matrices];
+    hdf5_io_req_t requests[num_matrices];
+    char dataset_names[num_matrices][50];
+    int failed = 0;
+    
+    // 创建HDF5文件（由I/O线程执行）
+    file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0);
+    if (file_id < 0) {
+        printf("Error: Failed to create HDF5 file\n");
+        return -1;
+    }
+    
+    for (int i = 0; i < num_matrices; i++) {
+        sprintf(dataset_names[i], "/matrix_%d", i);// 准备数据集名称
+        dataset_ids[i] = hdf5_io_call(IO_DATASET_CREATE, file_id, dataset_names[i], n, n);
+        if (dataset_ids[i] < 0) {
+            printf("Error: Failed to create dataset %s\n", dataset_names[i]);
+            failed++;
+        }
+    }
+
+    // 各线程并行提交写请求，不等待完成
+    #pragma omp parallel for
+    for (int i = 0; i < num_matrices; i++) {
+        if (dataset_ids[i] >= 0) {
+            hdf5_io_rows(&requests[i], IO_WRITE, dataset_ids[i], 0, n, n, matrices[i]);
+            hdf5_io_submit(&requests[i]);
+            progress_printf("    Thread %d: submitted matrix %d\n", omp_get_thread_num(), i);
+        }
+    }
+
+    // I/O 线程写出的同时计算校验和，写完后存为属性
+    matrix_checksum_t sums[num_matrices];
+    for (int i = 0; i < num_matrices; i++)
+        if (dataset_ids[i] >= 0 && checksum_matrix(matrices[i], n, n, &sums[i]) < 0)
+            sums[i].count = 0;
+    
+    for (int i = 0; i < num_matrices; i++) {
+        if (dataset_ids[i] < 0)
+            continue;
+        if (hdf5_io_wait(&requests[i]) < 0) {
+            printf("Error: Failed to write dataset %s\n", dataset_names[i]);
+            failed++;
+        } else if (sums[i].count && hdf5_io_checksum(dataset_ids[i], &sums[i], 1) < 0) {
+            printf("Error: Failed to write checksum of dataset %s\n", dataset_names[i]);
+            failed++;
+        }
+        hdf5_io_call(IO_DATASET_CLOSE, dataset_ids[i], NULL, 0, 0);
+    }
+    if (hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0) < 0)
+        failed++;
+    
+    progress_printf("  [Parallel] Write %d %dx%d matrices to HDF5 file %s (%d failed)\n",
+           num_matrices - failed, n, n, filename, failed);
+    return failed ? -1 : 0;
+}
+
+/**
+ * 串行按分块写入一个矩阵：按 layout 给出的顺序（Z-order 或行主序）逐块写 dataset_id，
+ * transposed_id >= 0 时同时把转置后的分块写到转置副本的 (col, row) 位置
+ *
+ * @return 0 成功，-1 失败
+ */
+static int serial_write_tiles(hid_t dataset_id, hid_t transposed_id, double *matrix, int n,
+                              const hdf5_layout_t *layout) {
+    hsize_t cr = layout->chunk_dims[0], cc = layout->chunk_dims[1];
+    long grid_rows = (n + cr - 1) / cr, grid_cols = (n + cc - 1) / cc;
+    tile_coord_t *order = make_tile_order(grid_rows, grid_cols, layout->morton);
+    double *tile = (double*)pool_alloc(2 * cr * cc * sizeof(double));
+    int ret = order && tile ? 0 : -1;
+
+    for (long k = 0; ret == 0 && k < grid_rows * grid_cols; k++) {
+        hsize_t row = (hsize_t)order[k].tile_row * cr, col = (hsize_t)order[k].tile_col * cc;
+        hsize_t rows = row + cr <= (hsize_t)n ? cr : n - row;
+        hsize_t cols = col + cc <= (hsize_t)n ? cc : n - col;
+        if (hdf5_tile_io(dataset_id, 1, row, col, rows, cols, matrix + row * n + col, n) < 0)
+            ret = -1;
+        if (ret == 0 && transposed_id >= 0) {
+            double *staged = tile, *transposed = tile + cr * cc;
+            stage_chunk(matrix, n, row, col, rows, cols, staged);
+            transpose_chunk(staged, rows, cols, transposed);
+            if (hdf5_tile_io(transposed_id, 1, col, row, cols, rows, transposed, rows) < 0)
+                ret = -1;
+        }
+    }
+    pool_free(tile, 2 * cr * cc * sizeof(double));
+    free(order);
+    return ret;
+}
+
+// 面板读取的 I/O 统计查询（在 I/O 线程上执行）
+typedef struct {
+    hid_t file_id, dataset_id;
+    const char *dataset_name;
+    hsize_t row, col, rows, cols;
+    long io_runs;               // 读取面板所需的连续文件区间数
+} panel_query_t;
+
+static void panel_query_callback(hdf5_io_req_t *req) {
+    panel_query_t *q = (panel_query_t*)req->arg;
+    hid_t space_id = H5Dget_space(q->dataset_id);
+    hid_t dcpl = H5Dget_create_plist(q->dataset_id);
+    hsize_t dims[2], tile[2];
+    tile_index_entry_t *entries = NULL;
+    size_t count;
+    if (space_id < 0 || dcpl < 0 || H5Sget_simple_extent_dims(space_id, dims, NULL) != 2) {
+        req->result = -1;
+    } else if (H5Pget_layout(dcpl) == H5D_CHUNKED && H5Pget_chunk(dcpl, 2, tile) == 2 &&
+               read_tile_index(q->file_id, q->dataset_name, &entries, &count) == 0) {
+        q->io_runs = tile_index_io_runs(entries, count, tile, q->row, q->col, q->rows, q->cols);
+    } else if (H5Pget_layout(dcpl) == H5D_CHUNKED) {
+        q->io_runs = -1;        // 没有分块索引
+    } else {
+        q->io_runs = q->cols == dims[1] ? 1 : (long)q->rows;   // 连续存储：每行一段
+    }
+    free(entries);
+    if (dcpl >= 0) H5Pclose(dcpl);
+    if (space_id >= 0) H5Sclose(space_id);
+}
+
+/**
+ * 读取数据集的面板 [row, row+rows) x [col, col+cols) 到 buf（行跨度 cols），
+ * 并统计该面板在文件中对应多少段连续区间（分块数据集依据 <name>_tile_index 合并地址相邻的分块）
+ *
+ * @param io_runs 输出连续区间数，分块数据集缺少索引时为 -1，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int read_panel_hdf5(const char *filename, const char *dataset_name, hsize_t row, hsize_t col,
+                    hsize_t rows, hsize_t cols, double *buf, long *io_runs) {
+    panel_query_t q = {-1, -1, dataset_name, row, col, rows, cols, -1};
+    int ret = -1;
+    q.file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    if (q.file_id < 0) {
+        printf("Error: Failed to open HDF5 file %s\n", filename);
+        return -1;
+    }
+    q.dataset_id = hdf5_io_call(IO_DATASET_OPEN, q.file_id, dataset_name, 0, 0);
+    if (q.dataset_id >= 0) {
+        hdf5_io_req_t req = {0};
+        req.op = IO_READ;
+        req.obj = q.dataset_id;
+        req.row = row;
+        req.col = col;
+        req.rows = rows;
+        req.cols = req.ld = cols;
+        req.buf = buf;
+        hdf5_io_submit(&req);
+        ret = hdf5_io_wait(&req) < 0 ? -1 : 0;
+
+        if (ret == 0 && io_runs) {
+            memset(&req, 0, sizeof(req));
+            req.op = IO_CALLBACK;
+            req.callback = panel_query_callback;
+            req.arg = &q;
+            hdf5_io_submit(&req);
+            ret = hdf5_io_wait(&req) < 0 ? -1 : 0;
+            *io_runs = q.io_runs;
+        }
+        hdf5_io_call(IO_DATASET_CLOSE, q.dataset_id, NULL, 0, 0);
+    }
+    hdf5_io_call(IO_FILE_CLOSE, q.file_id, NULL, 0, 0);
+    if (ret < 0)
+        printf("Error: Failed to read panel of dataset %s\n", dataset_name);
+    return ret;
+}
+
+/**
+ * 按指定存储布局串行写入HDF5文件
+ * 分块压缩布局下由 HDF5 过滤器管线在单线程中完成压缩
+ *
+ * @param layout 存储布局，NULL 表示连续存储
+ * @return 0 成功，-1 失败
+ */
+int serial_write_hdf5_layout(const char* filename, double **matrices, int n, int num_matrices,
+                             const hdf5_layout_t *layout) {
+    progress_printf("  [Serial] Create HDF5 file and write %d %dx%d matrices...\n", num_matrices, n, n);
+    
+    hid_t file_id, dataspace_id, dataset_id;
+    herr_t status;
+    hsize_t dims[2] = {n, n};
+    char dataset_name[50];
+    int ret = 0;
+    
+    // 创建HDF5文件（串行基线在调用线程上直接调用 HDF5）
+    hdf5_direct_begin();
+    file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, file_fapl);
+    if (file_id < 0) {
+        hdf5_direct_end();
+        printf("Error: Failed to create HDF5 file\n");
+        return -1;
+    }
+    
+    // 创建数据空间和数据集创建属性
+    dataspace_id = H5Screate_simple(2, dims, NULL);
+    hid_t dcpl = make_layout_dcpl(layout);
+    int tiled = layout && layout->chunked && (layout->morton || layout->transposed);
+    hid_t dcpl_t = tiled && layout->transposed ? make_layout_dcpl_ex(layout, 1) : H5P_DEFAULT;
+    
+    // 串行创建和写入数据集
+    for (int i = 0; i < num_matrices; i++) {
+        hid_t transposed_id = -1;
+        char transposed_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        sprintf(transposed_name, "/matrix_%d_T", i);
+        
+        // 创建数据集
+        uint64_t t0 = trace_begin();
+        dataset_id = H5Dcreate(file_id, dataset_name, H5T_IEEE_F64LE, dataspace_id,
+                              H5P_DEFAULT, dcpl, H5P_DEFAULT);
+        if (dataset_id >= 0 && dcpl_t != H5P_DEFAULT)
+            transposed_id = H5Dcreate(file_id, transposed_name, H5T_IEEE_F64LE, dataspace_id,
+                                      H5P_DEFAULT, dcpl_t, H5P_DEFAULT);
+        trace_end(TRACE_H5_DSET_CREATE, t0, 0);
+        if (dataset_id < 0 || (dcpl_t != H5P_DEFAULT && transposed_id < 0)) {
+            printf("Error: Failed to create dataset %s\n", dataset_id < 0 ? dataset_name : transposed_name);
+            if (dataset_id >= 0)
+                H5Dclose(dataset_id);
+            ret = -1;
+            continue;
+        }
+        
+        // 写入数据：Z-order / 转置副本按分块写，否则一次写整个矩阵
+        if (tiled) {
+            status = serial_write_tiles(dataset_id, transposed_id, matrices[i], n, layout);
+        } else {
+            t0 = trace_begin();
+            status = H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, 
+                             H5P_DEFAULT, matrices[i]);
+            trace_end(TRACE_H5_WRITE, t0, (uint64_t)n * n * sizeof(double));
+        }
+        if (status < 0) {
+            printf("Error: Failed to write dataset %s\n", dataset_name);
+            ret = -1;
+        } else {
+            matrix_checksum_t cs;
+            if (checksum_matrix(matrices[i], n, n, &cs) < 0 || write_checksum_attr(dataset_id, &cs) < 0) {
+                printf("Error: Failed to write checksum of dataset %s\n", dataset_name);
+                ret = -1;
+            }
+            progress_printf("    Completed writing matrix %d\n", i);
+        }
+        
+        H5Dclose(dataset_id);
+        if (transposed_id >= 0)
+            H5Dclose(transposed_id);
+        if (status >= 0 && tiled && layout->morton &&
+            (write_tile_index(file_id, dataset_name) < 0 ||
+             (transposed_id >= 0 && write_tile_index(file_id, transposed_name) < 0))) {
+            printf("Error: Failed to write tile index of %s\n", dataset_name);
+            ret = -1;
+        }
+    }
+    
+    // 关闭资源
+    if (dcpl != H5P_DEFAULT)
+        H5Pclose(dcpl);
+    if (dcpl_t != H5P_DEFAULT)
+        H5Pclose(dcpl_t);
+    H5Sclose(dataspace_id);
+    if (H5Fclose(file_id) < 0)
+        ret = -1;
+    hdf5_direct_end();
+    
+    progress_printf("  [Serial] Write %d %dx%d matrices to HDF5 file %s\n", num_matrices, n, n, filename);
+    return ret;
+}
+
+// ===================== 双缓冲流水线写入 =====================
+
+// 块生产者：填充第 matrix 个矩阵的 [row, row+rows) 行到 block（行跨度 n）
+typedef void (*block_producer_fn)(double *block, int matrix, int row, int rows, int n, void *arg);
+
+// 流水线统计
+typedef struct {
+    double produce_time;    // 生产者（初始化/计算）耗时
+    double stall_time;      // 等待暂存缓冲区写完的耗时
+    double total_time;      // 端到端耗时
+    double staging_mb;      // 暂存缓冲区总大小 (MB)
+    long blocks;            // 写入的块数
+} pipeline_stats_t;
+
+// 初始化生产者：与 init_matrix_parallel 生成完全相同的数据，仅填充一个行块
+void produce_init_block(double *block, int matrix, int row, int rows, int n, void *arg) {
+    (void)arg;
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        philox_fill_row(block + (size_t)i*n, RNG_SEED, (uint32_t)matrix, (uint32_t)(row + i), n);
+    }
+}
+
+/**
+ * 流水线写入HDF5文件
+ * 生产者在一个暂存缓冲区中填充第 k+1 块的同时，I/O 线程从另一个缓冲区写出第 k 块。
+ * 暂存缓冲区组成大小为 ring_size 的环，峰值内存只有 ring_size 个块而非整个矩阵。
+ *
+ * @param filename 文件名
+ * @param n 矩阵维度
+ * @param num_matrices 矩阵数量
+ * @param block_rows 每块行数
+ * @param ring_size 暂存缓冲区个数（>= 2）
+ * @param producer 块生产者
+ * @param arg 传给生产者的参数
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int pipelined_write_hdf5(const char* filename, int n, int num_matrices, int block_rows, int ring_size,
+                         block_producer_fn producer, void *arg, pipeline_stats_t *stats) {
+    progress_printf("  [Pipeline] Produce and write %d %dx%d matrices (%d-row blocks, %d staging buffers)...\n",
+           num_matrices, n, n, block_rows, ring_size);
+
+    pipeline_stats_t st = {0};
+    double start = omp_get_wtime();
+    hid_t dataset_ids[num_matrices];
+    int ret = 0;
+
+    if (block_rows <= 0 || block_rows > n)
+        block_rows = n;
+    if (ring_size < 2)
+        ring_size = 2;
+
+    hid_t file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0);
+    if (file_id < 0) {
+        printf("Error: Failed to create HDF5 file\n");
+        return -1;
+    }
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        dataset_ids[i] = hdf5_io_call(IO_DATASET_CREATE, file_id, dataset_name, n, n);
+        if (dataset_ids[i] < 0) {
+            printf("Error: Failed to create dataset %s\n", dataset_name);
+            ret = -1;
+        }
+    }
+
+    size_t block_elems = (size_t)block_rows * n;
+    double *ring[ring_size];
+    hdf5_io_req_t reqs[ring_size];
+    int in_flight[ring_size];
+    for (int s = 0; s < ring_size; s++) {
+        ring[s] = (double*)pool_alloc(block_elems * sizeof(double));
+        in_flight[s] = 0;
+        if (!ring[s])
+            ret = -1;
+    }
+    // 块生产出来后趁其仍在缓存中按行序累积校验和
+    checksum_acc_t acc[num_matrices];
+    size_t partial_bytes = (size_t)block_rows * sizeof(row_checksum_t);
+    row_checksum_t *partial = (row_checksum_t*)pool_alloc(partial_bytes);
+    if (!partial)
+        ret = -1;
+    for (int i = 0; i < num_matrices; i++)
+        checksum_init(&acc[i], n);
+    st.staging_mb = (double)ring_size * block_elems * sizeof(double) / (1024 * 1024);
+
+    int blocks_per_matrix = (n + block_rows - 1) / block_rows;
+    long total_blocks = (long)blocks_per_matrix * num_matrices;
+    for (long k = 0; k < total_blocks && ret == 0; k++) {
+        int s = (int)(k % ring_size);
+        int i = (int)(k / blocks_per_matrix);
+        int row = (int)(k % blocks_per_matrix) * block_rows;
+        int rows = n - row < block_rows ? n - row : block_rows;
+
+        // 反压：槽位上一次的写入完成后才能复用
+        if (in_flight[s]) {
+            double t0 = omp_get_wtime();
+            if (hdf5_io_wait(&reqs[s]) < 0)
+                ret = -1;
+            in_flight[s] = 0;
+            st.stall_time += omp_get_wtime() - t0;
+        }
+
+        double t0 = omp_get_wtime();
+        uint64_t span = trace_begin();
+        producer(ring[s], i, row, rows, n, arg);
+        trace_end(TRACE_PRODUCE, span, (uint64_t)rows * n * sizeof(double));
+        st.produce_time += omp_get_wtime() - t0;
+        checksum_rows(&acc[i], ring[s], rows, n, partial);
+
+        hdf5_io_rows(&reqs[s], IO_WRITE, dataset_ids[i], row, rows, n, ring[s]);
+        hdf5_io_submit(&reqs[s]);
+        in_flight[s] = 1;
+        st.blocks++;
+    }
+
+    double t0 = omp_get_wtime();
+    for (int s = 0; s < ring_size; s++) {
+        if (in_flight[s] && hdf5_io_wait(&reqs[s]) < 0)
+            ret = -1;
+        pool_free(ring[s], block_elems * sizeof(double));
+    }
+    st.stall_time += omp_get_wtime() - t0;
+    pool_free(partial, partial_bytes);
+
+    for (int i = 0; i < num_matrices; i++) {
+        if (dataset_ids[i] < 0)
+            continue;
+        matrix_checksum_t cs;
+        checksum_final(&acc[i], &cs);
+        if (ret == 0 && hdf5_io_checksum(dataset_ids[i], &cs, 1) < 0)
+            ret = -1;
+        hdf5_io_call(IO_DATASET_CLOSE, dataset_ids[i], NULL, 0, 0);
+    }
+    hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+
+    st.total_time = omp_get_wtime() - start;
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Pipelined write to %s failed\n", filename);
+    else
+        progress_printf("  [Pipeline] Wrote %ld blocks to HDF5 file %s\n", st.blocks, filename);
+    return ret;
+}
+
+/**
+ * 串行写入HDF5文件
+ * 用于性能对比
+ */
+int serial_write_hdf5(const char* filename, double **matrices, int n, int num_matrices) {
+    return serial_write_hdf5_layout(filename, matrices, n, num_matrices, NULL);
+}
+
+/**
+ * 并行读取HDF5文件中的矩阵数据
+ * 演示：使用超平面选择(hyperslab)并行读取数据块
+ * 
+ * @param filename 文件名
+ * @param matrices 用于存储读取数据的矩阵数组
+ * @param n 矩阵维度
+ * @param num_matrices 矩阵数量
+ * @param chunk_size 每次读取的行数
+ * @return 0 成功，-1 失败
+ */
+int parallel_read_hdf5(const char* filename, double **matrices, int n, 
+                      int num_matrices, int chunk_size) {
+    progress_printf("  [Parallel] Read %d %dx%d matrices from HDF5 file (chunk size: %d)...\n", 
+           num_matrices, n, n, chunk_size);
+    
+    hid_t file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    if (file_id < 0) {
+        printf("Error: Failed to open HDF5 file\n");
+        return -1;
+    }
+    if (chunk_size <= 0 || chunk_size > n)
+        chunk_size = n;
+
+    // 先打开所有数据集，再把 (数据集, 行块) 对均匀分配给所有线程
+    hid_t dataset_ids[num_matrices];
+    int ret = 0;
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        dataset_ids[i] = hdf5_io_call(IO_DATASET_OPEN, file_id, dataset_name, 0, 0);
+        if (dataset_ids[i] < 0) {
+            printf("Error: Failed to open dataset %s\n", dataset_name);
+            ret = -1;
+        }
+    }
+
+    int blocks_per_matrix = (n + chunk_size - 1) / chunk_size;
+    int total_blocks = num_matrices * blocks_per_matrix;
+    int failed_blocks = 0;
+    hdf5_io_req_t *requests = (hdf5_io_req_t*)calloc(total_blocks, sizeof(hdf5_io_req_t));
+    if (!requests) {
+        printf("Error: Failed to allocate I/O requests\n");
+        total_blocks = 0;
+        ret = -1;
+    }
+
+    // 行块读请求由所有线程并行提交，I/O 线程顺序执行
+    #pragma omp parallel
+    {
+        int my_blocks = 0;
+        #pragma omp for schedule(static)
+        for (int b = 0; b < total_blocks; b++) {
+            int i = b / blocks_per_matrix;
+            int row = (b % blocks_per_matrix) * chunk_size;
+            int rows = n - row < chunk_size ? n - row : chunk_size;
+            if (dataset_ids[i] < 0)
+                continue;
+            hdf5_io_rows(&requests[b], IO_READ, dataset_ids[i], row, rows, n,
+                         matrices[i] + (size_t)row * n);
+            hdf5_io_submit(&requests[b]);
+            my_blocks++;
+        }
+        #pragma omp for schedule(static) reduction(+:failed_blocks)
+        for (int b = 0; b < total_blocks; b++) {
+            if (dataset_ids[b / blocks_per_matrix] < 0 || hdf5_io_wait(&requests[b]) < 0)
+                failed_blocks++;
+        }
+        progress_printf("    Thread %d: Parallel read %d row blocks\n", omp_get_thread_num(), my_blocks);
+    }
+    if (failed_blocks > 0) {
+        printf("Error: Failed to read %d of %d row blocks\n", failed_blocks, total_blocks);
+        ret = -1;
+    }
+    free(requests);
+
+    for (int i = 0; i < num_matrices; i++)
+        if (dataset_ids[i] >= 0)
+            hdf5_io_call(IO_DATASET_CLOSE, dataset_ids[i], NULL, 0, 0);
+    hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    progress_printf("  [Parallel] Finish reading.\n");
+    return ret;
+}
+
+/**
+ * 串行读取HDF5文件
+ * 用于性能对比
+ *
+ * @return 0 成功，-1 失败
+ */
+int serial_read_hdf5(const char* filename, double **matrices, int n, int num_matrices) {
+    progress_printf("  [Serial] Read %d %dx%d matrices from HDF5 file...\n", num_matrices, n, n);
+    
+    hid_t file_id, dataset_id;
+    herr_t status;
+    char dataset_name[50];
+    int ret = 0;
+    
+    // 打开HDF5文件（串行基线在调用线程上直接调用 HDF5）
+    hdf5_direct_begin();
+    file_id = H5Fopen(filename, H5F_ACC_RDONLY, file_fapl);
+    if (file_id < 0) {
+        hdf5_direct_end();
+        printf("Error: Failed to open HDF5 file\n");
+        return -1;
+    }
+    
+    // 串行读取每个数据集
+    for (int i = 0; i < num_matrices; i++) {
+        sprintf(dataset_name, "/matrix_%d", i);
+        
+        // 打开数据集
+        dataset_id = H5Dopen(file_id, dataset_name, H5P_DEFAULT);
+        if (dataset_id < 0) {
+            printf("Error: Failed to open dataset %s\n", dataset_name);
+            ret = -1;
+            continue;
+        }
+        
+        // 读取整个数据集
+        uint64_t t0 = trace_begin();
+        status = H5Dread(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, 
+                        H5P_DEFAULT, matrices[i]);
+        trace_end(TRACE_H5_READ, t0, (uint64_t)n * n * sizeof(double));
+        if (status < 0) {
+            printf("Error: Failed to read dataset %s\n", dataset_name);
+            ret = -1;
+        } else {
+            progress_printf("    Completed reading matrix %d\n", i);
+        }
+        
+        H5Dclose(dataset_id);
+    }
+    
+    H5Fclose(file_id);
+    hdf5_direct_end();
+    progress_printf("  [Serial] Finish reading.\n");
+    return ret;
+}
+
+// ===================== 任务调度：(数据集, 行块) 任务图 =====================
+// 数据集级的 parallel for 内再调用 init_matrix_parallel 会形成嵌套并行：嵌套默认关闭时内层退化为串行，
+// 最多只有 num_matrices 个线程有活干；打开嵌套又会超额订阅 CPU。
+// 这里把 init / write / read / verify 统一拆成 (数据集, 行块) 单元，由一个线程生成 OpenMP 任务，
+// 其余线程从任务队列中领取执行（libgomp 的任务队列为所有线程共享，空闲线程随时取走下一个任务），
+// 负载与数据集个数和线程数的比例无关。每个单元最多两个阶段，第二阶段通过 depend 依赖同一单元的第一阶段
+// （如 读请求提交 -> 等待完成并计算校验），不同单元之间没有依赖。
+// 每个线程分别统计执行任务的时间、其中等待 I/O 线程的时间和任务个数，空闲时间 = 墙钟时间 - 执行时间。
+
+#define TASK_MAX_WORKERS 256
+
+// 单个线程的统计，按缓存行对齐避免伪共享
+typedef struct {
+    double busy;                // 执行任务的累计时间（含等待 I/O）
+    double wait;                // 任务内等待 I/O 线程的累计时间
+    long tasks;
+} __attribute__((aligned(64))) task_worker_t;
+
+typedef struct {
+    int workers;
+    long units, tasks;
+    double wall_time;
+    task_worker_t worker[TASK_MAX_WORKERS];
+} task_stats_t;
+
+// 一个阶段处理矩阵 matrix 的 [row, row + rows) 行；unit 为单元编号（矩阵主序）
+typedef void (*task_stage_fn)(void *ctx, long unit, int matrix, int row, int rows);
+
+static void task_execute(task_stage_fn stage, void *ctx, long unit, int blocks, int block_rows, int n,
+                         task_stats_t *stats) {
+    int matrix = (int)(unit / blocks);
+    int row = (int)(unit % blocks) * block_rows;
+    int rows = n - row < block_rows ? n - row : block_rows;
+    task_worker_t *w = &stats->worker[omp_get_thread_num()];
+    uint64_t span = trace_begin();
+    double t0 = omp_get_wtime();
+    stage(ctx, unit, matrix, row, rows);
+    w->busy += omp_get_wtime() - t0;
+    w->tasks++;
+    trace_end(TRACE_TASK, span, (uint64_t)rows * n * sizeof(double));
+}
+
+/**
+ * 对 num_matrices 个 n x n 矩阵的所有行块执行任务图
+ * stage1 非 NULL 时，每个单元的 stage1 在同一单元的 stage0 完成后执行
+ */
+static void task_run_graph(int n, int num_matrices, int block_rows, task_stage_fn stage0,
+                           task_stage_fn stage1, void *ctx, task_stats_t *stats) {
+    if (block_rows <= 0 || block_rows > n)
+        block_rows = n;
+    int blocks = (n + block_rows - 1) / block_rows;
+    long units = (long)blocks * num_matrices;
+    int workers = omp_get_max_threads() < TASK_MAX_WORKERS ? omp_get_max_threads() : TASK_MAX_WORKERS;
+    char *deps = (char*)calloc(units > 0 ? units : 1, 1);   // 仅用作 depend 的地址
+    memset(stats, 0, sizeof(*stats));
+    stats->workers = workers;
+    stats->units = units;
+
+    double t0 = omp_get_wtime();
+    #pragma omp parallel num_threads(workers)
+    {
+        #pragma omp single nowait
+        for (long u = 0; u < units; u++) {
+            #pragma omp task firstprivate(u) depend(out: deps[u])
+            task_execute(stage0, ctx, u, blocks, block_rows, n, stats);
+            if (stage1) {
+                #pragma omp task firstprivate(u) depend(in: deps[u])
+                task_execute(stage1, ctx, u, blocks, block_rows, n, stats);
+            }
+        }
+    }
+    stats->wall_time = omp_get_wtime() - t0;
+    for (int t = 0; t < workers; t++)
+        stats->tasks += stats->worker[t].tasks;
+    free(deps);
+}
+
+/**
+ * 打印各线程的任务数、执行/等待 I/O/空闲时间
+ */
+void print_task_stats(const char *label, const task_stats_t *st) {
+    double idle_sum = 0.0, idle_max = 0.0;
+    long min_tasks = st->workers > 0 ? st->worker[0].tasks : 0, max_tasks = 0;
+    for (int t = 0; t < st->workers; t++) {
+        double idle = st->wall_time - st->worker[t].busy;
+        idle_sum += idle > 0 ? idle : 0;
+        idle_max = idle > idle_max ? idle : idle_max;
+        min_tasks = st->worker[t].tasks < min_tasks ? st->worker[t].tasks : min_tasks;
+        max_tasks = st->worker[t].tasks > max_tasks ? st->worker[t].tasks : max_tasks;
+    }
+    printf("%s: %ld 个单元 / %ld 个任务, %d 个线程, 墙钟 %.4f 秒, 每线程任务数 %ld-%ld, "
+           "平均空闲 %.1f%%, 最大空闲 %.4f 秒\n", label, st->units, st->tasks, st->workers, st->wall_time,
+           min_tasks, max_tasks,
+           st->workers > 0 && st->wall_time > 0 ? 100.0 * idle_sum / (st->workers * st->wall_time) : 0.0,
+           idle_max);
+    for (int t = 0; t < st->workers && verbose_progress; t++)
+        printf("    线程 %3d: %5ld 个任务, 执行 %.4f 秒 (等待 I/O %.4f 秒), 空闲 %.4f 秒\n", t,
+               st->worker[t].tasks, st->worker[t].busy, st->worker[t].wait,
+               fmax(st->wall_time - st->worker[t].busy, 0.0));
+}
+
+// 任务图各阶段共享的上下文
+typedef struct {
+    double **matrices;
+    int n, num_matrices, block_rows;
+    hid_t *dataset_ids;
+    hdf5_io_req_t *reqs;            // 每个单元一个 I/O 请求
+    row_checksum_t **partial;       // 每个矩阵 n 行的单行校验部分结果
+    task_stats_t *stats;
+} task_ctx_t;
+
+static void task_init_stage(void *arg, long unit, int matrix, int row, int rows) {
+    task_ctx_t *c = (task_ctx_t*)arg;
+    (void)unit;
+    for (int i = row; i < row + rows; i++)
+        philox_fill_row(c->matrices[matrix] + (size_t)i * c->n, RNG_SEED, (uint32_t)matrix, (uint32_t)i, c->n);
+}
+
+static void task_checksum_stage(void *arg, long unit, int matrix, int row, int rows) {
+    task_ctx_t *c = (task_ctx_t*)arg;
+    (void)unit;
+    for (int i = row; i < row + rows; i++)
+        checksum_row(c->matrices[matrix] + (size_t)i * c->n, c->n, &c->partial[matrix][i]);
+}
+
+static void task_submit_stage(void *arg, long unit, int matrix, int row, int rows, hdf5_io_op_t op) {
+    task_ctx_t *c = (task_ctx_t*)arg;
+    if (c->dataset_ids[matrix] < 0)
+        return;
+    hdf5_io_rows(&c->reqs[unit], op, c->dataset_ids[matrix], row, rows, c->n,
+                 c->matrices[matrix] + (size_t)row * c->n);
+    hdf5_io_submit(&c->reqs[unit]);
+}
+
+static void task_write_stage(void *arg, long unit, int matrix, int row, int rows) {
+    task_submit_stage(arg, unit, matrix, row, rows, IO_WRITE);
+}
+
+static void task_read_stage(void *arg, long unit, int matrix, int row, int rows) {
+    task_submit_stage(arg, unit, matrix, row, rows, IO_READ);
+}
+
+// 等待本单元的读请求完成后计算校验
+static void task_read_checksum_stage(void *arg, long unit, int matrix, int row, int rows) {
+    task_ctx_t *c = (task_ctx_t*)arg;
+    if (c->dataset_ids[matrix] < 0)
+        return;
+    double t0 = omp_get_wtime();
+    hdf5_io_wait(&c->reqs[unit]);
+    c->stats->worker[omp_get_thread_num()].wait += omp_get_wtime() - t0;
+    task_checksum_stage(arg, unit, matrix, row, rows);
+}
+
+static int task_ctx_init(task_ctx_t *c, double **matrices, int n, int num_matrices, int block_rows,
+                         int io, int checksum, task_stats_t *stats) {
+    memset(c, 0, sizeof(*c));
+    c->matrices = matrices;
+    c->n = n;
+    c->num_matrices = num_matrices;
+    c->block_rows = block_rows <= 0 || block_rows > n ? n : block_rows;
+    c->stats = stats;
+    long units = (long)((n + c->block_rows - 1) / c->block_rows) * num_matrices;
+    int ok = 1;
+    if (io) {
+        c->dataset_ids = (hid_t*)malloc(num_matrices * sizeof(hid_t));
+        c->reqs = (hdf5_io_req_t*)calloc(units > 0 ? units : 1, sizeof(hdf5_io_req_t));
+        ok = c->dataset_ids && c->reqs;
+        for (int i = 0; ok && i < num_matrices; i++)
+            c->dataset_ids[i] = -1;
+    }
+    if (checksum) {
+        c->partial = (row_checksum_t**)calloc(num_matrices, sizeof(row_checksum_t*));
+        ok = ok && c->partial;
+        for (int i = 0; ok && i < num_matrices; i++)
+            ok = (c->partial[i] = (row_checksum_t*)pool_alloc((size_t)n * sizeof(row_checksum_t))) != NULL;
+    }
+    return ok ? 0 : -1;
+}
+
+static void task_ctx_free(task_ctx_t *c) {
+    for (int i = 0; c->partial && i < c->num_matrices; i++)
+        pool_free(c->partial[i], (size_t)c->n * sizeof(row_checksum_t));
+    free(c->partial);
+    free(c->reqs);
+    free(c->dataset_ids);
+}
+
+// 按行序合并矩阵 i 的单行部分结果
+static void task_merge_checksum(const task_ctx_t *c, int i, matrix_checksum_t *cs) {
+    checksum_acc_t acc;
+    checksum_init(&acc, c->n);
+    checksum_merge_rows(&acc, c->partial[i], c->n, c->n);
+    checksum_final(&acc, cs);
+}
+
+/**
+ * 任务调度的矩阵初始化：所有矩阵的行块作为同一批任务，结果与 init_matrix_parallel 逐位一致
+ *
+ * @param stats 输出统计，可为 NULL
+ */
+void task_init_matrices(double **matrices, int n, int num_matrices, int block_rows, task_stats_t *stats) {
+    task_stats_t local;
+    task_stats_t *st = stats ? stats : &local;
+    task_ctx_t c;
+    task_ctx_init(&c, matrices, n, num_matrices, block_rows, 0, 0, st);
+    task_run_graph(n, num_matrices, c.block_rows, task_init_stage, NULL, &c, st);
+    task_ctx_free(&c);
+}
+
+/**
+ * 任务调度的校验：每个行块一个任务计算单行校验，再按行序合并，结果与 checksum_matrix 一致
+ *
+ * @param sums 输出 num_matrices 个校验和
+ * @return 0 成功，-1 内存分配失败
+ */
+int task_checksum_matrices(double **matrices, int n, int num_matrices, int block_rows,
+                           matrix_checksum_t *sums, task_stats_t *stats) {
+    task_stats_t local;
+    task_stats_t *st = stats ? stats : &local;
+    task_ctx_t c;
+    int ret = task_ctx_init(&c, matrices, n, num_matrices, block_rows, 0, 1, st);
+    if (ret == 0) {
+        task_run_graph(n, num_matrices, c.block_rows, task_checksum_stage, NULL, &c, st);
+        for (int i = 0; i < num_matrices; i++)
+            task_merge_checksum(&c, i, &sums[i]);
+    }
+    task_ctx_free(&c);
+    return ret;
+}
+
+/**
+ * 任务调度的写入：每个行块一个任务提交写请求，另一个任务计算该行块的校验（与写入重叠），
+ * 写完后把校验和存为 "checksum" 属性；文件格式与 parallel_write_hdf5 相同
+ *
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int task_write_hdf5(const char *filename, double **matrices, int n, int num_matrices, int block_rows,
+                    task_stats_t *stats) {
+    progress_printf("  [Task] Write %d %dx%d matrices as (dataset, %d-row block) tasks...\n",
+                    num_matrices, n, n, block_rows);
+    task_stats_t local;
+    task_stats_t *st = stats ? stats : &local;
+    task_ctx_t c;
+    int failed = 0;
+    hid_t file_id = -1;
+    if (task_ctx_init(&c, matrices, n, num_matrices, block_rows, 1, 1, st) < 0 ||
+        (file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0)) < 0) {
+        printf("Error: Failed to create HDF5 file\n");
+        task_ctx_free(&c);
+        return -1;
+    }
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        c.dataset_ids[i] = hdf5_io_call(IO_DATASET_CREATE, file_id, dataset_name, n, n);
+        if (c.dataset_ids[i] < 0) {
+            printf("Error: Failed to create dataset %s\n", dataset_name);
+            failed++;
+        }
+    }
+
+    task_run_graph(n, num_matrices, c.block_rows, task_write_stage, task_checksum_stage, &c, st);
+
+    long units = st->units;
+    int blocks = units / (num_matrices > 0 ? num_matrices : 1);
+    for (long u = 0; u < units; u++)
+        if (c.dataset_ids[u / blocks] >= 0 && hdf5_io_wait(&c.reqs[u]) < 0)
+            failed++;
+    for (int i = 0; i < num_matrices; i++) {
+        if (c.dataset_ids[i] < 0)
+            continue;
+        matrix_checksum_t cs;
+        task_merge_checksum(&c, i, &cs);
+        if (hdf5_io_checksum(c.dataset_ids[i], &cs, 1) < 0)
+            failed++;
+        hdf5_io_call(IO_DATASET_CLOSE, c.dataset_ids[i], NULL, 0, 0);
+    }
+    hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    task_ctx_free(&c);
+    if (failed)
+        printf("Error: Failed to write %d blocks/datasets to %s\n", failed, filename);
+    return failed ? -1 : 0;
+}
+
+/**
+ * 任务调度的读取与校验：每个行块先由一个任务提交读请求，依赖它的第二个任务等待完成后计算校验，
+ * 最后与文件中的 "checksum" 属性比对
+ *
+ * @param mismatched 输出校验不一致的数据集个数，可为 NULL
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功（可能有不一致），-1 读取失败
+ */
+int task_read_hdf5(const char *filename, double **matrices, int n, int num_matrices, int block_rows,
+                   int *mismatched, task_stats_t *stats) {
+    progress_printf("  [Task] Read and verify %d %dx%d matrices as (dataset, %d-row block) tasks...\n",
+                    num_matrices, n, n, block_rows);
+    task_stats_t local;
+    task_stats_t *st = stats ? stats : &local;
+    task_ctx_t c;
+    int failed = 0, bad = 0;
+    hid_t file_id = -1;
+    if (task_ctx_init(&c, matrices, n, num_matrices, block_rows, 1, 1, st) < 0 ||
+        (file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0)) < 0) {
+        printf("Error: Failed to open HDF5 file\n");
+        task_ctx_free(&c);
+        return -1;
+    }
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        c.dataset_ids[i] = hdf5_io_call(IO_DATASET_OPEN, file_id, dataset_name, 0, 0);
+        if (c.dataset_ids[i] < 0) {
+            printf("Error: Failed to open dataset %s\n", dataset_name);
+            failed++;
+        }
+    }
+
+    task_run_graph(n, num_matrices, c.block_rows, task_read_stage, task_read_checksum_stage, &c, st);
+
+    long units = st->units;
+    int blocks = units / (num_matrices > 0 ? num_matrices : 1);
+    for (long u = 0; u < units; u++)
+        if (c.dataset_ids[u / blocks] >= 0 && c.reqs[u].result < 0)
+            failed++;
+    for (int i = 0; i < num_matrices; i++) {
+        if (c.dataset_ids[i] < 0)
+            continue;
+        matrix_checksum_t computed, stored;
+        task_merge_checksum(&c, i, &computed);
+        if (hdf5_io_checksum(c.dataset_ids[i], &stored, 0) < 0 || !checksum_equal(&computed, &stored))
+            bad++;
+        hdf5_io_call(IO_DATASET_CLOSE, c.dataset_ids[i], NULL, 0, 0);
+    }
+    hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    task_ctx_free(&c);
+    if (mismatched)
+        *mismatched = bad;
+    if (failed)
+        printf("Error: Failed to read %d blocks/datasets from %s\n", failed, filename);
+    return failed ? -1 : 0;
+}
+
+// ===================== 混合精度存储 =====================
+// 计算始终使用 double，磁盘上可以存为 float32 / float16 / bfloat16，I/O 量减半或减到四分之一。
+// 精度转换在计算线程上由并行 SIMD 内核完成（double -> float 用 vcvtpd2ps，float16 优先用 F16C，
+// bfloat16 用整数舍入），写入/读取时内存类型与文件类型相同，HDF5 不再逐元素做标量类型转换。
+// float16 / bfloat16 是由 IEEE float32 修改位域得到的自定义 HDF5 浮点类型，其他 HDF5 程序可以直接读取。
+// 所有舍入均为就近偶数；float16 先舍入到 float32 再舍入到 float16（与 F16C 路径逐位一致）。
+
+typedef enum { PRECISION_F64, PRECISION_F32, PRECISION_F16, PRECISION_BF16, PRECISION_COUNT } storage_precision_t;
+
+static const struct {
+    const char *name;
+    size_t size;                // 存储元素字节数
+} precision_info[PRECISION_COUNT] = {
+    {"f64", 8}, {"f32", 4}, {"f16", 2}, {"bf16", 2}
+};
+
+#define CONVERT_SEGMENT 16384   // 并行转换时每个任务处理的元素数
+
+// 读回数据相对于 double 源数据的误差
+typedef struct {
+    double max_abs_err;
+    double max_rel_err;         // 仅统计源数据非零的元素
+    double sum_sq_err;
+    double count;
+} precision_error_t;
+
+// 混合精度读写统计
+typedef struct {
+    double convert_time;        // 转换（含误差统计）耗时
+    double total_time;          // 端到端耗时
+    double stored_mb;           // 数据集存储数据量
+    precision_error_t err;
+} precision_stats_t;
+
+/**
+ * 创建存储精度对应的 HDF5 文件类型，调用者负责 H5Tclose
+ * float16: 1 位符号 + 5 位指数（偏置 15）+ 10 位尾数；bfloat16: 1 + 8（偏置 127）+ 7，即 float32 的高 16 位
+ */
+hid_t precision_h5type(storage_precision_t precision) {
+    hid_t type_id;
+    switch (precision) {
+    case PRECISION_F64:
+        return H5Tcopy(H5T_IEEE_F64LE);
+    case PRECISION_F32:
+        return H5Tcopy(H5T_IEEE_F32LE);
+    case PRECISION_F16:
+        type_id = H5Tcopy(H5T_IEEE_F32LE);
+        H5Tset_fields(type_id, 15, 10, 5, 0, 10);
+        H5Tset_precision(type_id, 16);
+        H5Tset_size(type_id, 2);
+        H5Tset_ebias(type_id, 15);
+        return type_id;
+    case PRECISION_BF16:
+        type_id = H5Tcopy(H5T_IEEE_F32LE);
+        H5Tset_fields(type_id, 15, 7, 8, 0, 7);
+        H5Tset_precision(type_id, 16);
+        H5Tset_size(type_id, 2);
+        H5Tset_ebias(type_id, 127);
+        return type_id;
+    default:
+        return -1;
+    }
+}
+
+static inline uint32_t float_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bits_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// float32 -> float16，就近偶数舍入，溢出为 Inf，NaN 保持为静默 NaN，支持非规格化数
+static inline uint16_t float_to_half(float f) {
+    const uint32_t f32_infty = 255u << 23, f16_max = (127u + 16) << 23;
+    const uint32_t denorm_magic = ((127u - 15) + (23 - 10) + 1) << 23;
+    uint32_t u = float_bits(f), sign = u & 0x80000000u;
+    uint16_t h;
+    u ^= sign;
+    if (u >= f16_max) {
+        h = u > f32_infty ? 0x7e00 : 0x7c00;
+    } else if (u < (113u << 23)) {
+        // 结果为非规格化数：借助浮点加法完成移位和舍入
+        h = (uint16_t)(float_bits(bits_float(u) + bits_float(denorm_magic)) - denorm_magic);
+    } else {
+        uint32_t mant_odd = (u >> 13) & 1;
+        u += ((uint32_t)(15 - 127) << 23) + 0xfff + mant_odd;
+        h = (uint16_t)(u >> 13);
+    }
+    return h | (uint16_t)(sign >> 16);
+}
+
+static inline float half_to_float(uint16_t h) {
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t u = ((uint32_t)h & 0x7fff) << 13, exp = shifted_exp & u;
+    u += (uint32_t)(127 - 15) << 23;
+    if (exp == shifted_exp)
+        u += (uint32_t)(128 - 16) << 23;                                // Inf / NaN
+    else if (exp == 0)
+        u = float_bits(bits_float(u + (1u << 23)) - bits_float(113u << 23));   // 零 / 非规格化数
+    return bits_float(u | ((uint32_t)h & 0x8000) << 16);
+}
+
+// float32 -> bfloat16：截取高 16 位前按就近偶数舍入，NaN 置静默位
+static inline uint16_t float_to_bfloat(float f) {
+    uint32_t u = float_bits(f);
+    uint32_t rounded = u + 0x7fff + ((u >> 16) & 1);
+    return (u & 0x7fffffffu) > 0x7f800000u ? (uint16_t)((u >> 16) | 0x40) : (uint16_t)(rounded >> 16);
+}
+
+RNG_TARGET_CLONES
+static void convert_f64_to_f32(const double *restrict src, float *restrict dst, size_t count) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++)
+        dst[i] = (float)src[i];
+}
+
+RNG_TARGET_CLONES
+static void convert_f32_to_f64(const float *restrict src, double *restrict dst, size_t count) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++)
+        dst[i] = src[i];
+}
+
+RNG_TARGET_CLONES
+static void convert_f64_to_bf16(const double *restrict src, uint16_t *restrict dst, size_t count) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++)
+        dst[i] = float_to_bfloat((float)src[i]);
+}
+
+RNG_TARGET_CLONES
+static void convert_bf16_to_f64(const uint16_t *restrict src, double *restrict dst, size_t count) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++)
+        dst[i] = bits_float((uint32_t)src[i] << 16);
+}
+
+static void convert_f64_to_f16_soft(const double *restrict src, uint16_t *restrict dst, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        dst[i] = float_to_half((float)src[i]);
+}
+
+static void convert_f16_to_f64_soft(const uint16_t *restrict src, double *restrict dst, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        dst[i] = half_to_float(src[i]);
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("avx2,f16c")))
+static void convert_f64_to_f16_f16c(const double *restrict src, uint16_t *restrict dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 lo = _mm256_cvtpd_ps(_mm256_loadu_pd(src + i));
+        __m128 hi = _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 4));
+        __m256 f = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    convert_f64_to_f16_soft(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx2,f16c")))
+static void convert_f16_to_f64_f16c(const uint16_t *restrict src, double *restrict dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 f = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i)));
+        _mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm256_castps256_ps128(f)));
+        _mm256_storeu_pd(dst + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)));
+    }
+    convert_f16_to_f64_soft(src + i, dst + i, count - i);
+}
+#endif
+
+static int f16c_supported(void) {
+    static int supported = -1;
+    if (supported < 0) {
+#if defined(__x86_64__) && defined(__GNUC__)
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c") &&
+                    !getenv("NO_F16C");
+#else
+        supported = 0;
+#endif
+    }
+    return supported;
+}
+
+/**
+ * 并行把 count 个 double 转换为存储精度
+ */
+void convert_to_storage(storage_precision_t precision, const double *src, void *dst, size_t count) {
+    long segments = (long)((count + CONVERT_SEGMENT - 1) / CONVERT_SEGMENT);
+    int f16c = f16c_supported();
+    uint64_t t0 = trace_begin();
+    #pragma omp parallel for schedule(static)
+    for (long s = 0; s < segments; s++) {
+        size_t first = (size_t)s * CONVERT_SEGMENT;
+        size_t len = count - first < CONVERT_SEGMENT ? count - first : CONVERT_SEGMENT;
+        switch (precision) {
+        case PRECISION_F64:
+            memcpy((double*)dst + first, src + first, len * sizeof(double));
+            break;
+        case PRECISION_F32:
+            convert_f64_to_f32(src + first, (float*)dst + first, len);
+            break;
+        case PRECISION_F16:
+#if defined(__x86_64__) && defined(__GNUC__)
+            if (f16c) {
+                convert_f64_to_f16_f16c(src + first, (uint16_t*)dst + first, len);
+                break;
+            }
+#endif
+            convert_f64_to_f16_soft(src + first, (uint16_t*)dst + first, len);
+            break;
+        case PRECISION_BF16:
+            convert_f64_to_bf16(src + first, (uint16_t*)dst + first, len);
+            break;
+        default:
+            break;
+        }
+    }
+    trace_end(TRACE_ENCODE, t0, count * sizeof(double));
+}
+
+/**
+ * 并行把 count 个存储精度元素转换回 double；ref 非 NULL 时同时累计相对于 ref 的误差
+ */
+void convert_from_storage(storage_precision_t precision, const void *src, double *dst, size_t count,
+                          const double *ref, precision_error_t *err) {
+    long segments = (long)((count + CONVERT_SEGMENT - 1) / CONVERT_SEGMENT);
+    int f16c = f16c_supported();
+    double max_abs = 0.0, max_rel = 0.0, sum_sq = 0.0;
+    uint64_t t0 = trace_begin();
+    #pragma omp parallel for schedule(static) reduction(max:max_abs, max_rel) reduction(+:sum_sq)
+    for (long s = 0; s < segments; s++) {
+        size_t first = (size_t)s * CONVERT_SEGMENT;
+        size_t len = count - first < CONVERT_SEGMENT ? count - first : CONVERT_SEGMENT;
+        double *out = dst + first;
+        switch (precision) {
+        case PRECISION_F64:
+            memcpy(out, (const double*)src + first, len * sizeof(double));
+            break;
+        case PRECISION_F32:
+            convert_f32_to_f64((const float*)src + first, out, len);
+            break;
+        case PRECISION_F16:
+#if defined(__x86_64__) && defined(__GNUC__)
+            if (f16c) {
+                convert_f16_to_f64_f16c((const uint16_t*)src + first, out, len);
+                break;
+            }
+#endif
+            convert_f16_to_f64_soft((const uint16_t*)src + first, out, len);
+            break;
+        case PRECISION_BF16:
+            convert_bf16_to_f64((const uint16_t*)src + first, out, len);
+            break;
+        default:
+            break;
+        }
+        if (ref) {
+            const double *r = ref + first;
+            #pragma omp simd reduction(max:max_abs, max_rel) reduction(+:sum_sq)
+            for (size_t i = 0; i < len; i++) {
+                double e = fabs(out[i] - r[i]);
+                double rel = r[i] != 0.0 ? e / fabs(r[i]) : 0.0;
+                max_abs = e > max_abs ? e : max_abs;
+                max_rel = rel > max_rel ? rel : max_rel;
+                sum_sq += e * e;
+            }
+        }
+    }
+    trace_end(TRACE_DECODE, t0, count * sizeof(double));
+    if (ref && err) {
+        if (max_abs > err->max_abs_err) err->max_abs_err = max_abs;
+        if (max_rel > err->max_rel_err) err->max_rel_err = max_rel;
+        err->sum_sq_err += sum_sq;
+        err->count += (double)count;
+    }
+}
+
+/**
+ * 并行写入：计算线程把行块转换为存储精度后提交给 I/O 线程，
+ * PIPELINE_RING_SIZE 个暂存缓冲区轮转，转换下一块与写入上一块重叠
+ *
+ * @param block_rows 每个行块的行数
+ * @param precision 存储精度，PRECISION_F64 时直接写 double 数据
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int parallel_write_hdf5_precision(const char *filename, double **matrices, int n, int num_matrices,
+                                  int block_rows, storage_precision_t precision, precision_stats_t *stats) {
+    progress_printf("  [Parallel] Write %d %dx%d matrices as %s (block %d rows)...\n",
+                    num_matrices, n, n, precision_info[precision].name, block_rows);
+    precision_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    if (block_rows <= 0 || block_rows > n)
+        block_rows = n;
+    size_t elem = precision_info[precision].size;
+    size_t slot_bytes = (size_t)block_rows * n * elem;
+    hdf5_direct_begin();
+    hid_t file_type = precision_h5type(precision);
+    hdf5_direct_end();
+    hid_t file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0);
+    hid_t dataset_ids[num_matrices];
+    hdf5_io_req_t reqs[PIPELINE_RING_SIZE];
+    void *slots[PIPELINE_RING_SIZE];
+    int ret = file_id >= 0 && file_type >= 0 ? 0 : -1;
+
+    for (int i = 0; i < num_matrices; i++) {
+        hdf5_io_req_t req = {0};
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        dataset_ids[i] = -1;
+        if (ret < 0)
+            continue;
+        req.op = IO_DATASET_CREATE;
+        req.obj = file_id;
+        req.name = dataset_name;
+        req.rows = n;
+        req.cols = n;
+        req.type = file_type;
+        hdf5_io_submit(&req);
+        if ((dataset_ids[i] = hdf5_io_wait(&req)) < 0) {
+            printf("Error: Failed to create dataset %s\n", dataset_name);
+            ret = -1;
+        }
+    }
+    for (int s = 0; s < PIPELINE_RING_SIZE; s++) {
+        reqs[s].op = IO_SHUTDOWN;   // 标记为空闲槽位
+        slots[s] = precision == PRECISION_F64 ? NULL : pool_alloc(slot_bytes);
+        if (precision != PRECISION_F64 && !slots[s])
+            ret = -1;
+    }
+
+    int blocks_per_matrix = (n + block_rows - 1) / block_rows;
+    for (int b = 0; ret == 0 && b < num_matrices * blocks_per_matrix; b++) {
+        int i = b / blocks_per_matrix, row = (b % blocks_per_matrix) * block_rows;
+        int rows = n - row < block_rows ? n - row : block_rows;
+        int s = b % PIPELINE_RING_SIZE;
+        double *src = matrices[i] + (size_t)row * n;
+        if (reqs[s].op != IO_SHUTDOWN && hdf5_io_wait(&reqs[s]) < 0)
+            ret = -1;
+        hdf5_io_rows(&reqs[s], IO_WRITE, dataset_ids[i], row, rows, n, src);
+        if (precision != PRECISION_F64) {
+            double t0 = omp_get_wtime();
+            convert_to_storage(precision, src, slots[s], (size_t)rows * n);
+            st.convert_time += omp_get_wtime() - t0;
+            reqs[s].type = file_type;
+            reqs[s].raw = slots[s];
+        }
+        hdf5_io_submit(&reqs[s]);
+    }
+    for (int s = 0; s < PIPELINE_RING_SIZE; s++) {
+        if (reqs[s].op != IO_SHUTDOWN && hdf5_io_wait(&reqs[s]) < 0)
+            ret = -1;
+        pool_free(slots[s], slot_bytes);
+    }
+
+    for (int i = 0; i < num_matrices; i++)
+        if (dataset_ids[i] >= 0)
+            hdf5_io_call(IO_DATASET_CLOSE, dataset_ids[i], NULL, 0, 0);
+    if (file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    hdf5_direct_begin();
+    if (file_type >= 0)
+        H5Tclose(file_type);
+    hdf5_direct_end();
+
+    st.stored_mb = (double)n * n * elem * num_matrices / (1024 * 1024);
+    st.total_time = omp_get_wtime() - t_start;
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Failed to write %s matrices to %s\n", precision_info[precision].name, filename);
+    return ret;
+}
+
+// 在 I/O 线程上识别数据集的存储精度：obj = dataset_id -> result = storage_precision_t
+static void precision_query_callback(hdf5_io_req_t *req) {
+    hid_t dtype = H5Dget_type(req->obj);
+    req->result = -1;
+    for (int p = 0; dtype >= 0 && p < PRECISION_COUNT && req->result < 0; p++) {
+        hid_t type_id = precision_h5type((storage_precision_t)p);
+        if (H5Tequal(dtype, type_id) > 0)
+            req->result = p;
+        H5Tclose(type_id);
+    }
+    if (dtype >= 0)
+        H5Tclose(dtype);
+}
+
+/**
+ * 并行读取：存储精度由数据集类型自动识别，I/O 线程按原类型读出行块，
+ * 计算线程并行转换回 double；最多 PIPELINE_RING_SIZE 个行块读请求在途，转换与读取重叠
+ *
+ * @param reference double 源矩阵，非 NULL 时统计读回数据的误差
+ * @param precision 输出识别到的存储精度（取所有数据集中最后一个），可为 NULL
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int parallel_read_hdf5_precision(const char *filename, double **matrices, int n, int num_matrices,
+                                 int block_rows, double **reference, storage_precision_t *precision,
+                                 precision_stats_t *stats) {
+    precision_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    if (block_rows <= 0 || block_rows > n)
+        block_rows = n;
+    hid_t file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    hid_t dataset_ids[num_matrices], file_types[PRECISION_COUNT];
+    storage_precision_t precisions[num_matrices];
+    size_t slot_bytes = (size_t)block_rows * n * sizeof(double);   // 按最宽的 double 分配
+    hdf5_io_req_t reqs[PIPELINE_RING_SIZE];
+    void *slots[PIPELINE_RING_SIZE];
+    int ret = file_id >= 0 ? 0 : -1;
+
+    hdf5_direct_begin();
+    for (int p = 0; p < PRECISION_COUNT; p++)
+        file_types[p] = precision_h5type((storage_precision_t)p);
+    hdf5_direct_end();
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        hdf5_io_req_t req = {0};
+        sprintf(dataset_name, "/matrix_%d", i);
+        dataset_ids[i] = ret < 0 ? -1 : hdf5_io_call(IO_DATASET_OPEN, file_id, dataset_name, 0, 0);
+        precisions[i] = PRECISION_F64;
+        if (dataset_ids[i] < 0) {
+            ret = -1;
+            continue;
+        }
+        req.op = IO_CALLBACK;
+        req.obj = dataset_ids[i];
+        req.callback = precision_query_callback;
+        hdf5_io_submit(&req);
+        hid_t p = hdf5_io_wait(&req);
+        if (p < 0) {
+            printf("Error: Unsupported element type in dataset %s\n", dataset_name);
+            ret = -1;
+        } else {
+            precisions[i] = (storage_precision_t)p;
+            st.stored_mb += (double)n * n * precision_info[p].size / (1024 * 1024);
+        }
+    }
+    progress_printf("  [Parallel] Read %d %dx%d %s matrices (block %d rows)...\n", num_matrices, n, n,
+                    num_matrices > 0 ? precision_info[precisions[num_matrices - 1]].name : "-", block_rows);
+    for (int s = 0; s < PIPELINE_RING_SIZE; s++) {
+        slots[s] = pool_alloc(slot_bytes);
+        if (!slots[s]) ret = -1;
+    }
+
+    // 预先提交前 PIPELINE_RING_SIZE 个行块，每处理完一块就把它的槽位交给后面的块
+    int blocks_per_matrix = (n + block_rows - 1) / block_rows;
+    int total_blocks = ret == 0 ? num_matrices * blocks_per_matrix : 0;
+    for (int b = 0; b < total_blocks + PIPELINE_RING_SIZE; b++) {
+        if (b >= PIPELINE_RING_SIZE) {
+            int done = b - PIPELINE_RING_SIZE, s = done % PIPELINE_RING_SIZE;
+            int i = done / blocks_per_matrix, row = (done % blocks_per_matrix) * block_rows;
+            int rows = n - row < block_rows ? n - row : block_rows;
+            if (hdf5_io_wait(&reqs[s]) < 0) {
+                ret = -1;
+            } else {
+                double t0 = omp_get_wtime();
+                convert_from_storage(precisions[i], slots[s], matrices[i] + (size_t)row * n, (size_t)rows * n,
+                                     reference ? reference[i] + (size_t)row * n : NULL, &st.err);
+                st.convert_time += omp_get_wtime() - t0;
+            }
+        }
+        if (b < total_blocks) {
+            int i = b / blocks_per_matrix, row = (b % blocks_per_matrix) * block_rows;
+            int rows = n - row < block_rows ? n - row : block_rows;
+            int s = b % PIPELINE_RING_SIZE;
+            hdf5_io_rows(&reqs[s], IO_READ, dataset_ids[i], row, rows, n, NULL);
+            reqs[s].type = file_types[precisions[i]];
+            reqs[s].raw = slots[s];
+            hdf5_io_submit(&reqs[s]);
+        }
+    }
+    for (int s = 0; s < PIPELINE_RING_SIZE; s++)
+        pool_free(slots[s], slot_bytes);
+
+    for (int i = 0; i < num_matrices; i++)
+        if (dataset_ids[i] >= 0)
+            hdf5_io_call(IO_DATASET_CLOSE, dataset_ids[i], NULL, 0, 0);
+    if (file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    hdf5_direct_begin();
+    for (int p = 0; p < PRECISION_COUNT; p++)
+        if (file_types[p] >= 0)
+            H5Tclose(file_types[p]);
+    hdf5_direct_end();
+
+    st.total_time = omp_get_wtime() - t_start;
+    if (precision && num_matrices > 0)
+        *precision = precisions[num_matrices - 1];
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Failed to read matrices from %s\n", filename);
+    return ret;
+}
+
+/**
+ * 串行写入指定存储精度（用于对比）：f32 由 HDF5 库逐元素做类型转换；
+ * f16/bf16 在本线程逐元素标量舍入后原样写入 ——
+ * HDF5 1.10 的软件浮点转换在尾数进位时不调整指数（如 0.99997 写成 f16 后读回 0.5），不能直接使用
+ *
+ * @return 0 成功，-1 失败
+ */
+int serial_write_hdf5_precision(const char *filename, double **matrices, int n, int num_matrices,
+                                storage_precision_t precision) {
+    progress_printf("  [Serial] Write %d %dx%d matrices as %s (serial conversion)...\n",
+                    num_matrices, n, n, precision_info[precision].name);
+    hsize_t dims[2] = {n, n};
+    hdf5_direct_begin();
+    hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, file_fapl);
+    if (file_id < 0) {
+        printf("Error: Failed to create HDF5 file\n");
+        hdf5_direct_end();
+        return -1;
+    }
+    hid_t space_id = H5Screate_simple(2, dims, NULL);
+    hid_t file_type = precision_h5type(precision);
+    int half = precision == PRECISION_F16 || precision == PRECISION_BF16, ret = 0;
+    uint16_t *converted = half ? (uint16_t*)malloc((size_t)n * n * sizeof(uint16_t)) : NULL;
+    if (half && !converted) {
+        printf("Error: Failed to allocate conversion buffer\n");
+        num_matrices = 0;
+        ret = -1;
+    }
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        hid_t dataset_id = H5Dcreate(file_id, dataset_name, file_type, space_id,
+                                     H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        for (size_t k = 0; half && k < (size_t)n * n; k++) {
+            float f = (float)matrices[i][k];
+            converted[k] = precision == PRECISION_F16 ? float_to_half(f) : float_to_bfloat(f);
+        }
+        uint64_t t0 = trace_begin();
+        if (dataset_id < 0 ||
+            H5Dwrite(dataset_id, half ? file_type : H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                     half ? (const void*)converted : (const void*)matrices[i]) < 0) {
+            printf("Error: Failed to write dataset %s\n", dataset_name);
+            ret = -1;
+        }
+        trace_end(TRACE_H5_WRITE, t0, (uint64_t)n * n * precision_info[precision].size);
+        if (dataset_id >= 0)
+            H5Dclose(dataset_id);
+    }
+    free(converted);
+    H5Tclose(file_type);
+    H5Sclose(space_id);
+    if (H5Fclose(file_id) < 0)
+        ret = -1;
+    hdf5_direct_end();
+    return ret;
+}
+
+/**
+ * 把误差统计格式化打印
+ */
+void print_precision_error(const char *label, const precision_error_t *err) {
+    printf("%s: 最大绝对误差 %.3e, 最大相对误差 %.3e, RMS 误差 %.3e\n", label, err->max_abs_err,
+           err->max_rel_err, err->count > 0 ? sqrt(err->sum_sq_err / err->count) : 0.0);
+}
+
+// ===================== 内存映射零拷贝读取 =====================
+
+// 访问模式提示（映射到 madvise）
+typedef enum {
+    MAP_ACCESS_NORMAL,
+    MAP_ACCESS_SEQUENTIAL,
+    MAP_ACCESS_RANDOM
+} map_access_t;
+
+// 只读映射的 HDF5 文件
+typedef struct {
+    void *base;         // mmap 返回的起始地址
+    size_t length;      // 映射长度
+} mapped_file_t;
+
+// 由 I/O 线程查询的数据集原始数据位置
+typedef struct {
+    const char *filename;
+    int num_matrices;
+    int n;
+    haddr_t *offsets;   // 每个数据集在文件中的字节偏移，不可映射时为 HADDR_UNDEF
+} map_query_t;
+
+// 在 I/O 线程上执行：检查布局、类型、形状，并取得数据的文件偏移
+static void map_query_callback(hdf5_io_req_t *req) {
+    map_query_t *q = (map_query_t*)req->arg;
+    hid_t file_id = H5Fopen(q->filename, H5F_ACC_RDONLY, file_fapl);
+    for (int i = 0; i < q->num_matrices; i++)
+        q->offsets[i] = HADDR_UNDEF;
+    if (file_id < 0)
+        return;
+    for (int i = 0; i < q->num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        hid_t dataset_id = H5Dopen(file_id, dataset_name, H5P_DEFAULT);
+        if (dataset_id < 0)
+            continue;
+        hid_t type_id = H5Dget_type(dataset_id);
+        hid_t space_id = H5Dget_space(dataset_id);
+        hsize_t dims[2] = {0, 0};
+        // 只有连续存储、已分配、磁盘类型与本机 double 一致且形状匹配时才能零拷贝
+        if (H5Tequal(type_id, H5T_NATIVE_DOUBLE) > 0 &&
+            H5Sget_simple_extent_ndims(space_id) == 2 &&
+            H5Sget_simple_extent_dims(space_id, dims, NULL) == 2 &&
+            dims[0] == (hsize_t)q->n && dims[1] == (hsize_t)q->n)
+            q->offsets[i] = H5Dget_offset(dataset_id);
+        H5Sclose(space_id);
+        H5Tclose(type_id);
+        H5Dclose(dataset_id);
+    }
+    H5Fclose(file_id);
+}
+
+/**
+ * 以只读内存映射方式“读取”HDF5文件中的矩阵，不经过 H5Dread 的拷贝与类型转换
+ * 要求数据集为连续存储、未压缩、磁盘类型等同本机 double
+ *
+ * @param filename 文件名
+ * @param views 输出：每个矩阵在映射区中的只读指针
+ * @param n 矩阵维度
+ * @param num_matrices 矩阵数量
+ * @param access 访问模式提示
+ * @param mf 输出：映射信息，用 unmap_hdf5 释放
+ * @return 0 成功，-1 失败（任一数据集不可映射）
+ */
+int mmap_read_hdf5(const char* filename, const double **views, int n, int num_matrices,
+                   map_access_t access, mapped_file_t *mf) {
+    progress_printf("  [Mmap] Map %d %dx%d matrices from HDF5 file %s...\n", num_matrices, n, n, filename);
+
+    haddr_t offsets[num_matrices];
+    map_query_t q = {filename, num_matrices, n, offsets};
+    hdf5_io_req_t req = {0};
+    req.op = IO_CALLBACK;
+    req.callback = map_query_callback;
+    req.arg = &q;
+    hdf5_io_submit(&req);
+    hdf5_io_wait(&req);
+
+    size_t matrix_bytes = (size_t)n * n * sizeof(double);
+    for (int i = 0; i < num_matrices; i++) {
+        if (offsets[i] == HADDR_UNDEF || offsets[i] % sizeof(double) != 0) {
+            printf("Error: /matrix_%d is not a contiguous, aligned native double dataset\n", i);
+            return -1;
+        }
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Error: Failed to open %s\n", filename);
+        return -1;
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        close(fd);
+        return -1;
+    }
+    for (int i = 0; i < num_matrices; i++) {
+        if (offsets[i] + matrix_bytes > (size_t)sb.st_size) {
+            printf("Error: /matrix_%d extends past end of file\n", i);
+            close(fd);
+            return -1;
+        }
+    }
+
+    mf->length = (size_t)sb.st_size;
+    mf->base = mmap(NULL, mf->length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mf->base == MAP_FAILED) {
+        printf("Error: mmap of %s failed\n", filename);
+        mf->base = NULL;
+        return -1;
+    }
+
+    int advice = access == MAP_ACCESS_SEQUENTIAL ? MADV_SEQUENTIAL :
+                 access == MAP_ACCESS_RANDOM ? MADV_RANDOM : MADV_NORMAL;
+    for (int i = 0; i < num_matrices; i++) {
+        views[i] = (const double*)((const char*)mf->base + offsets[i]);
+        // madvise 需要页对齐的起始地址
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t start = (size_t)offsets[i] & ~(page - 1);
+        madvise((char*)mf->base + start, offsets[i] + matrix_bytes - start, advice);
+    }
+    progress_printf("  [Mmap] Finish mapping.\n");
+    return 0;
+}
+
+/**
+ * 释放 mmap_read_hdf5 建立的映射
+ */
+void unmap_hdf5(mapped_file_t *mf) {
+    if (mf->base)
+        munmap(mf->base, mf->length);
+    mf->base = NULL;
+    mf->length = 0;
+}
+
+// 一个已存储分块的位置信息
+typedef struct {
+    int matrix;             // 所属矩阵编号
+    hsize_t offset[2];      // 分块起点（元素坐标）
+    haddr_t addr;           // 文件内地址
+    hsize_t size;           // 存储（压缩后）字节数
+    unsigned filter_mask;   // 写入时跳过的过滤器位掩码
+} chunk_entry_t;
+
+// 数据集的分块与过滤器描述（由 I/O 线程查询）
+typedef struct {
+    hid_t dataset_id;
+    int matrix;
+    int chunked;
+    hsize_t chunk_dims[2];
+    int nfilters;
+    H5Z_filter_t filters[8];    // 按写入顺序排列
+    chunk_entry_t *entries;
+    hsize_t nentries;
+    int status;
+} chunk_query_t;
+
+// 在 I/O 线程上执行：读取数据集的布局、过滤器管线并枚举所有分块
+static void query_chunks_callback(hdf5_io_req_t *req) {
+    chunk_query_t *q = (chunk_query_t*)req->arg;
+    hid_t dcpl = H5Dget_create_plist(q->dataset_id);
+    q->status = -1;
+    if (dcpl < 0)
+        return;
+    q->chunked = H5Pget_layout(dcpl) == H5D_CHUNKED;
+    if (q->chunked) {
+        H5Pget_chunk(dcpl, 2, q->chunk_dims);
+        q->nfilters = H5Pget_nfilters(dcpl);
+        if (q->nfilters > 8)
+            q->nfilters = 8;
+        for (int f = 0; f < q->nfilters; f++) {
+            unsigned flags, filter_config;
+            size_t cd_nelmts = 0;
+            q->filters[f] = H5Pget_filter2(dcpl, (unsigned)f, &flags, &cd_nelmts, NULL,
+                                           0, NULL, &filter_config);
+        }
+        hid_t space_id = H5Dget_space(q->dataset_id);
+        if (H5Dget_num_chunks(q->dataset_id, space_id, &q->nentries) >= 0) {
+            q->entries = (chunk_entry_t*)calloc(q->nentries ? q->nentries : 1, sizeof(chunk_entry_t));
+            q->status = q->entries ? 0 : -1;
+            for (hsize_t c = 0; c < q->nentries && q->status == 0; c++) {
+                chunk_entry_t *e = &q->entries[c];
+                e->matrix = q->matrix;
+                if (H5Dget_chunk_info(q->dataset_id, space_id, c, e->offset, &e->filter_mask,
+                                      &e->addr, &e->size) < 0)
+                    q->status = -1;
+            }
+        }
+        H5Sclose(space_id);
+    } else {
+        q->status = 0;
+    }
+    H5Pclose(dcpl);
+}
+
+static int compare_chunk_addr(const void *a, const void *b) {
+    haddr_t x = ((const chunk_entry_t*)a)->addr, y = ((const chunk_entry_t*)b)->addr;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * 按过滤器管线的逆序解码一个原始分块（支持 deflate 与 shuffle），并把有效区域散射到矩阵中
+ *
+ * @param raw 原始分块数据，decode 过程中可能被覆盖
+ * @param scratch 两个 chunk_bytes 大小的临时缓冲区
+ * @return 0 成功，-1 失败（不支持的过滤器或数据损坏）
+ */
+static int decode_chunk(const chunk_query_t *q, const chunk_entry_t *e, unsigned char *raw,
+                        unsigned char *scratch, double *matrix, int n) {
+    size_t count = (size_t)q->chunk_dims[0] * q->chunk_dims[1];
+    size_t chunk_bytes = count * sizeof(double);
+    unsigned char *cur = raw, *spare = scratch;
+    size_t cur_len = (size_t)e->size;
+
+    for (int f = q->nfilters - 1; f >= 0; f--) {
+        if (e->filter_mask & (1u << f))
+            continue;
+        if (q->filters[f] == H5Z_FILTER_DEFLATE) {
+            uLongf out_len = (uLongf)chunk_bytes;
+            if (uncompress(spare, &out_len, cur, (uLong)cur_len) != Z_OK || out_len != chunk_bytes)
+                return -1;
+            cur_len = out_len;
+        } else if (q->filters[f] == H5Z_FILTER_SHUFFLE) {
+            if (cur_len != chunk_bytes)
+                return -1;
+            for (size_t i = 0; i < count; i++)
+                for (size_t j = 0; j < sizeof(double); j++)
+                    spare[i*sizeof(double) + j] = cur[j*count + i];
+        } else {
+            return -1;
+        }
+        unsigned char *t = cur;
+        cur = spare;
+        spare = (t == raw) ? scratch + chunk_bytes : t;
+    }
+    if (cur_len != chunk_bytes)
+        return -1;
+
+    const double *chunk = (const double*)cur;
+    hsize_t cr = q->chunk_dims[0], cc = q->chunk_dims[1];
+    hsize_t row = e->offset[0], col = e->offset[1];
+    hsize_t rows = row + cr <= (hsize_t)n ? cr : n - row;
+    hsize_t cols = col + cc <= (hsize_t)n ? cc : n - col;
+    for (hsize_t i = 0; i < rows; i++)
+        memcpy(matrix + (row + i) * n + col, chunk + i * cc, cols * sizeof(double));
+    return 0;
+}
+
+/**
+ * 并行直接分块读取
+ * I/O 线程用 H5Dget_chunk_info 枚举分块地址、按文件地址顺序用 H5Dread_chunk 取回原始分块，
+ * 解压、反 shuffle 和散射到目标矩阵由所有 OpenMP 线程并行完成。
+ * 连续存储的数据集退化为整块 H5Dread。
+ *
+ * @param filename 文件名
+ * @param matrices 用于存储读取数据的矩阵数组
+ * @param n 矩阵维度
+ * @param num_matrices 矩阵数量
+ * @param stats 输出统计（compressed_bytes 为读取的存储字节数，compress_time 为解码耗时之和），可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int parallel_read_hdf5_chunks(const char* filename, double **matrices, int n, int num_matrices,
+                              compress_stats_t *stats) {
+    progress_printf("  [Parallel] Direct chunk read of %d %dx%d matrices...\n", num_matrices, n, n);
+
+    compress_stats_t st = {0};
+    chunk_query_t queries[num_matrices];
+    long total = 0, failed = 0;
+    hid_t file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    if (file_id < 0) {
+        printf("Error: Failed to open HDF5 file\n");
+        return -1;
+    }
+
+    memset(queries, 0, sizeof(queries));
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        queries[i].matrix = i;
+        queries[i].status = -1;
+        queries[i].dataset_id = hdf5_io_call(IO_DATASET_OPEN, file_id, dataset_name, 0, 0);
+        if (queries[i].dataset_id < 0) {
+            printf("Error: Failed to open dataset %s\n", dataset_name);
+            failed++;
+            continue;
+        }
+        hdf5_io_req_t req = {0};
+        req.op = IO_CALLBACK;
+        req.callback = query_chunks_callback;
+        req.arg = &queries[i];
+        hdf5_io_submit(&req);
+        hdf5_io_wait(&req);
+        if (queries[i].status < 0) {
+            printf("Error: Failed to enumerate chunks of %s\n", dataset_name);
+            failed++;
+        } else if (!queries[i].chunked) {
+            // 连续存储：直接整体读取
+            hdf5_io_req_t rd;
+            hdf5_io_rows(&rd, IO_READ, queries[i].dataset_id, 0, n, n, matrices[i]);
+            hdf5_io_submit(&rd);
+            if (hdf5_io_wait(&rd) < 0)
+                failed++;
+        }
+        total += (long)queries[i].nentries;
+    }
+
+    // 汇总所有分块并按文件地址排序，使 I/O 线程顺序访问磁盘
+    // 原始分块缓冲区按实际存储的最大分块分配：不可压缩的数据经 deflate 后会比未压缩分块更大
+    chunk_entry_t *entries = (chunk_entry_t*)malloc((total ? total : 1) * sizeof(chunk_entry_t));
+    size_t max_chunk_bytes = 0, max_stored_bytes = 1;
+    long k = 0;
+    for (int i = 0; i < num_matrices; i++) {
+        size_t bytes = (size_t)queries[i].chunk_dims[0] * queries[i].chunk_dims[1] * sizeof(double);
+        if (bytes > max_chunk_bytes)
+            max_chunk_bytes = bytes;
+        for (hsize_t c = 0; c < queries[i].nentries && entries; c++) {
+            if (queries[i].entries[c].size > max_stored_bytes)
+                max_stored_bytes = (size_t)queries[i].entries[c].size;
+            entries[k++] = queries[i].entries[c];
+        }
+    }
+    if (!entries && total > 0) {
+        failed++;
+        total = 0;
+    }
+    qsort(entries, total, sizeof(chunk_entry_t), compare_chunk_addr);
+
+    #pragma omp parallel reduction(+:failed)
+    {
+        // 每个线程两个原始分块缓冲区：解码当前分块时预取下一个
+        int nthreads = omp_get_num_threads(), tid = omp_get_thread_num();
+        unsigned char *raw[2], *scratch = (unsigned char*)pool_alloc(2 * max_chunk_bytes);
+        hdf5_io_req_t reqs[2];
+        double my_decode = 0.0, my_stored = 0.0, my_raw = 0.0;
+        long my_chunks = 0;
+        raw[0] = (unsigned char*)pool_alloc(max_stored_bytes);
+        raw[1] = (unsigned char*)pool_alloc(max_stored_bytes);
+        int ok = raw[0] && raw[1] && scratch;
+
+        // 静态轮转分配：线程 tid 处理第 tid, tid+T, ... 个分块
+        long c = tid, cur = 0;
+        if (ok && c < total) {
+            memset(&reqs[0], 0, sizeof(reqs[0]));
+            reqs[0].op = IO_READ_CHUNK;
+            reqs[0].obj = queries[entries[c].matrix].dataset_id;
+            reqs[0].row = entries[c].offset[0];
+            reqs[0].col = entries[c].offset[1];
+            reqs[0].raw = raw[0];
+            reqs[0].data_size = max_stored_bytes;
+            hdf5_io_submit(&reqs[0]);
+        }
+        for (; ok && c < total; c += nthreads, cur ^= 1) {
+            long next = c + nthreads;
+            if (next < total) {
+                hdf5_io_req_t *nr = &reqs[cur ^ 1];
+                memset(nr, 0, sizeof(*nr));
+                nr->op = IO_READ_CHUNK;
+                nr->obj = queries[entries[next].matrix].dataset_id;
+                nr->row = entries[next].offset[0];
+                nr->col = entries[next].offset[1];
+                nr->raw = raw[cur ^ 1];
+                nr->data_size = max_stored_bytes;
+                hdf5_io_submit(nr);
+            }
+            const chunk_entry_t *e = &entries[c];
+            const chunk_query_t *q = &queries[e->matrix];
+            if (hdf5_io_wait(&reqs[cur]) < 0) {
+                failed++;
+                continue;
+            }
+            double t0 = omp_get_wtime();
+            uint64_t span = trace_begin();
+            if (decode_chunk(q, e, raw[cur], scratch, matrices[e->matrix], n) < 0)
+                failed++;
+            trace_end(TRACE_DECODE, span, q->chunk_dims[0] * q->chunk_dims[1] * sizeof(double));
+            my_decode += omp_get_wtime() - t0;
+            my_stored += (double)e->size;
+            my_raw += (double)q->chunk_dims[0] * q->chunk_dims[1] * sizeof(double);
+            my_chunks++;
+        }
+        if (!ok && tid < total)
+            failed++;
+        pool_free(raw[0], max_stored_bytes);
+        pool_free(raw[1], max_stored_bytes);
+        pool_free(scratch, 2 * max_chunk_bytes);
+
+        #pragma omp critical
+        {
+            st.compress_time += my_decode;
+            st.compressed_bytes += my_stored;
+            st.raw_bytes += my_raw;
+            st.chunks += my_chunks;
+        }
+    }
+
+    if (failed > 0)
+        printf("Error: Failed to read %ld chunks\n", failed);
+    free(entries);
+    for (int i = 0; i < num_matrices; i++) {
+        free(queries[i].entries);
+        if (queries[i].dataset_id >= 0)
+            hdf5_io_call(IO_DATASET_CLOSE, queries[i].dataset_id, NULL, 0, 0);
+    }
+    hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    if (stats)
+        *stats = st;
+    progress_printf("  [Parallel] Finish reading %ld chunks.\n", st.chunks);
+    return failed > 0 ? -1 : 0;
+}
+
+// ===================== 区域读取与分块缓存 =====================
+// 分析任务经常反复读取同一矩阵中小而重叠的窗口，每次都走完整的 HDF5 选择/读取/解压路径。
+// region_read 把窗口拆成与数据集分块对齐的瓦片（连续存储时使用 REGION_TILE 大小），
+// 解码后的瓦片保存在按哈希分片的 LRU 缓存中：每个分片一把锁，多个线程读取不同瓦片时互不阻塞。
+// 未命中的瓦片每 REGION_BATCH 个一批提交给 I/O 线程，再逐个插入缓存并拷贝到输出缓冲区，
+// 请求数组大小固定，窗口再大也不会撑爆调用线程的栈。
+
+#define TILE_CACHE_SHARDS 16         // 缓存分片数
+#define TILE_CACHE_BUCKETS 256       // 每个分片的哈希桶数
+#define TILE_CACHE_BUDGET_MB 64      // 默认缓存预算 (MB)，可由 --cache-mb 覆盖
+#define REGION_TILE 256              // 连续存储数据集的瓦片边长
+#define REGION_BATCH 256             // 每批提交的未命中瓦片数
+#define REGION_WINDOWS 512           // 演示中读取的重叠窗口个数
+
+typedef struct tile_entry {
+    struct tile_entry *prev, *next;  // LRU 双向链表（表头为最近使用）
+    struct tile_entry *hnext;        // 哈希桶链
+    uint64_t hash;
+    uint32_t dataset_key;
+    hsize_t tile_row, tile_col;      // 瓦片坐标（以瓦片为单位）
+    hsize_t rows, cols;              // 瓦片有效大小（边界瓦片可能更小）
+    size_t bytes;
+    double *data;
+} tile_entry_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    tile_entry_t *buckets[TILE_CACHE_BUCKETS];
+    tile_entry_t lru;                // 哨兵
+    size_t bytes;
+    uint64_t hits, misses, evictions;
+} tile_shard_t;
+
+// 预算是全局的：插入后先淘汰本分片最久未用的瓦片，仍超出时再依次清理其他分片
+typedef struct {
+    tile_shard_t shards[TILE_CACHE_SHARDS];
+    atomic_size_t bytes;
+    size_t budget;
+} tile_cache_t;
+
+// 缓存统计（所有分片之和）
+typedef struct {
+    uint64_t hits, misses, evictions;
+    size_t bytes, budget;
+} tile_cache_stats_t;
+
+// 通过 region_open 打开的数据集
+typedef struct {
+    tile_cache_t *cache;
+    hid_t file_id, dataset_id;
+    uint32_t key;                    // 在缓存中区分数据集
+    hsize_t dims[2];
+    hsize_t tile[2];                 // 瓦片形状（分块存储时等于分块形状）
+    int chunked;
+} region_dataset_t;
+
+static atomic_uint region_next_key = 1;
+
+/**
+ * 初始化瓦片缓存
+ *
+ * @param budget_mb 缓存预算 (MB)，所有分片共享；0 表示不缓存
+ */
+void tile_cache_init(tile_cache_t *cache, size_t budget_mb) {
+    memset(cache, 0, sizeof(*cache));
+    cache->budget = budget_mb << 20;
+    for (int s = 0; s < TILE_CACHE_SHARDS; s++) {
+        tile_shard_t *sh = &cache->shards[s];
+        pthread_mutex_init(&sh->lock, NULL);
+        sh->lru.prev = sh->lru.next = &sh->lru;
+    }
+    atomic_init(&cache->bytes, 0);
+}
+
+static void tile_entry_free(tile_entry_t *e) {
+    pool_free(e->data, e->bytes);
+    free(e);
+}
+
+void tile_cache_destroy(tile_cache_t *cache) {
+    for (int s = 0; s < TILE_CACHE_SHARDS; s++) {
+        tile_shard_t *sh = &cache->shards[s];
+        for (tile_entry_t *e = sh->lru.next, *next; e != &sh->lru; e = next) {
+            next = e->next;
+            tile_entry_free(e);
+        }
+        pthread_mutex_destroy(&sh->lock);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+void tile_cache_get_stats(tile_cache_t *cache, tile_cache_stats_t *st) {
+    memset(st, 0, sizeof(*st));
+    st->budget = cache->budget;
+    for (int s = 0; s < TILE_CACHE_SHARDS; s++) {
+        tile_shard_t *sh = &cache->shards[s];
+        pthread_mutex_lock(&sh->lock);
+        st->hits += sh->hits;
+        st->misses += sh->misses;
+        st->evictions += sh->evictions;
+        st->bytes += sh->bytes;
+        pthread_mutex_unlock(&sh->lock);
+    }
+}
+
+static uint64_t tile_hash(uint32_t key, hsize_t tile_row, hsize_t tile_col) {
+    uint64_t h = (uint64_t)key * 0x9E3779B97F4A7C15ull ^ (uint64_t)tile_row * 0xC2B2AE3D27D4EB4Full
+               ^ (uint64_t)tile_col * 0x165667B19E3779F9ull;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 32);
+}
+
+static tile_shard_t *tile_shard(tile_cache_t *cache, uint64_t hash) {
+    return &cache->shards[hash % TILE_CACHE_SHARDS];
+}
+
+static void lru_unlink(tile_entry_t *e) {
+    e->prev->next = e->next;
+    e->next->prev = e->prev;
+}
+
+static void lru_push_front(tile_shard_t *sh, tile_entry_t *e) {
+    e->prev = &sh->lru;
+    e->next = sh->lru.next;
+    sh->lru.next->prev = e;
+    sh->lru.next = e;
+}
+
+// 以下函数需持有分片锁
+static tile_entry_t *tile_lookup_locked(tile_shard_t *sh, uint64_t hash, uint32_t key,
+                                        hsize_t tile_row, hsize_t tile_col) {
+    for (tile_entry_t *e = sh->buckets[(hash >> 8) % TILE_CACHE_BUCKETS]; e; e = e->hnext)
+        if (e->hash == hash && e->dataset_key == key && e->tile_row == tile_row && e->tile_col == tile_col)
+            return e;
+    return NULL;
+}
+
+static void tile_evict_locked(tile_cache_t *cache, tile_shard_t *sh, const tile_entry_t *keep) {
+    while (atomic_load(&cache->bytes) > cache->budget && sh->lru.prev != &sh->lru && sh->lru.prev != keep) {
+        tile_entry_t *victim = sh->lru.prev;
+        tile_entry_t **pp = &sh->buckets[(victim->hash >> 8) % TILE_CACHE_BUCKETS];
+        while (*pp != victim)
+            pp = &(*pp)->hnext;
+        *pp = victim->hnext;
+        lru_unlink(victim);
+        sh->bytes -= victim->bytes;
+        atomic_fetch_sub(&cache->bytes, victim->bytes);
+        sh->evictions++;
+        tile_entry_free(victim);
+    }
+}
+
+// 不持有任何分片锁时调用：本分片淘汰后仍超出预算，从其他分片继续淘汰
+static void tile_cache_trim(tile_cache_t *cache, const tile_shard_t *from) {
+    for (int s = 0; s < TILE_CACHE_SHARDS && atomic_load(&cache->bytes) > cache->budget; s++) {
+        tile_shard_t *sh = &cache->shards[s];
+        if (sh == from)
+            continue;
+        pthread_mutex_lock(&sh->lock);
+        tile_evict_locked(cache, sh, NULL);
+        pthread_mutex_unlock(&sh->lock);
+    }
+}
+
+// 从瓦片拷贝窗口与瓦片的交集到输出缓冲区（行跨度 ld）
+static void tile_copy_out(const double *tile, hsize_t tile_ld, hsize_t r0, hsize_t c0,
+                          hsize_t rows, hsize_t cols, double *out, hsize_t ld) {
+    for (hsize_t r = 0; r < rows; r++)
+        memcpy(out + r * ld, tile + (r0 + r) * tile_ld + c0, cols * sizeof(double));
+}
+
+// 在 I/O 线程上执行：查询数据集形状与分块形状
+static void region_query_callback(hdf5_io_req_t *req) {
+    region_dataset_t *ds = (region_dataset_t*)req->arg;
+    hid_t space_id = H5Dget_space(ds->dataset_id);
+    hid_t dcpl = H5Dget_create_plist(ds->dataset_id);
+    if (space_id < 0 || dcpl < 0 || H5Sget_simple_extent_ndims(space_id) != 2 ||
+        H5Sget_simple_extent_dims(space_id, ds->dims, NULL) != 2) {
+        req->result = -1;
+    } else if (H5Pget_layout(dcpl) == H5D_CHUNKED && H5Pget_chunk(dcpl, 2, ds->tile) == 2) {
+        ds->chunked = 1;
+    }
+    if (dcpl >= 0) H5Pclose(dcpl);
+    if (space_id >= 0) H5Sclose(space_id);
+}
+
+/**
+ * 打开数据集用于区域读取（文件与数据集句柄由 I/O 线程持有）
+ *
+ * @param cache 瓦片缓存，可被多个数据集共享
+ * @return 0 成功，-1 失败
+ */
+int region_open(region_dataset_t *ds, tile_cache_t *cache, const char *filename, const char *dataset_name) {
+    memset(ds, 0, sizeof(*ds));
+    ds->cache = cache;
+    ds->tile[0] = ds->tile[1] = REGION_TILE;
+    ds->key = atomic_fetch_add(&region_next_key, 1);
+    ds->file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    if (ds->file_id < 0) {
+        printf("Error: Failed to open HDF5 file %s\n", filename);
+        return -1;
+    }
+    ds->dataset_id = hdf5_io_call(IO_DATASET_OPEN, ds->file_id, dataset_name, 0, 0);
+    hdf5_io_req_t req = {0};
+    req.op = IO_CALLBACK;
+    req.callback = region_query_callback;
+    req.arg = ds;
+    if (ds->dataset_id >= 0)
+        hdf5_io_submit(&req);
+    if (ds->dataset_id < 0 || hdf5_io_wait(&req) < 0) {
+        printf("Error: Failed to open dataset %s\n", dataset_name);
+        if (ds->dataset_id >= 0)
+            hdf5_io_call(IO_DATASET_CLOSE, ds->dataset_id, NULL, 0, 0);
+        hdf5_io_call(IO_FILE_CLOSE, ds->file_id, NULL, 0, 0);
+        return -1;
+    }
+    return 0;
+}
+
+void region_close(region_dataset_t *ds) {
+    hdf5_io_call(IO_DATASET_CLOSE, ds->dataset_id, NULL, 0, 0);
+    hdf5_io_call(IO_FILE_CLOSE, ds->file_id, NULL, 0, 0);
+}
+
+// 等待一批未命中瓦片读完，拷贝到输出缓冲区并插入缓存；返回 0 成功，-1 有瓦片读取失败
+static int region_finish_batch(region_dataset_t *ds, const hsize_t offset[2], const hsize_t count[2], double *buf,
+                               tile_entry_t **missing, hdf5_io_req_t *reqs, int nmissing) {
+    int ret = 0;
+    for (int m = 0; m < nmissing; m++) {
+        tile_entry_t *e = missing[m];
+        hsize_t row = e->tile_row * ds->tile[0], col = e->tile_col * ds->tile[1];
+        hsize_t r0 = offset[0] > row ? offset[0] - row : 0;
+        hsize_t c0 = offset[1] > col ? offset[1] - col : 0;
+        hsize_t r1 = offset[0] + count[0] < row + e->rows ? offset[0] + count[0] - row : e->rows;
+        hsize_t c1 = offset[1] + count[1] < col + e->cols ? offset[1] + count[1] - col : e->cols;
+        double *out = buf + (row + r0 - offset[0]) * count[1] + (col + c0 - offset[1]);
+        if (hdf5_io_wait(&reqs[m]) < 0) {
+            tile_entry_free(e);
+            ret = -1;
+            continue;
+        }
+        tile_copy_out(e->data, e->cols, r0, c0, r1 - r0, c1 - c0, out, count[1]);
+
+        tile_shard_t *sh = tile_shard(ds->cache, e->hash);
+        pthread_mutex_lock(&sh->lock);
+        // 其他线程可能已并发插入同一瓦片，或瓦片超过整个预算：不缓存
+        if (e->bytes > ds->cache->budget ||
+            tile_lookup_locked(sh, e->hash, e->dataset_key, e->tile_row, e->tile_col)) {
+            pthread_mutex_unlock(&sh->lock);
+            tile_entry_free(e);
+            continue;
+        }
+        tile_entry_t **bucket = &sh->buckets[(e->hash >> 8) % TILE_CACHE_BUCKETS];
+        e->hnext = *bucket;
+        *bucket = e;
+        lru_push_front(sh, e);
+        sh->bytes += e->bytes;
+        atomic_fetch_add(&ds->cache->bytes, e->bytes);
+        tile_evict_locked(ds->cache, sh, e);
+        pthread_mutex_unlock(&sh->lock);
+        tile_cache_trim(ds->cache, sh);
+    }
+    return ret;
+}
+
+/**
+ * 读取数据集的一个矩形区域，经由瓦片缓存（线程安全）
+ *
+ * @param ds 已打开的数据集
+ * @param offset 区域起点 [行, 列]
+ * @param count 区域大小 [行数, 列数]
+ * @param buf 输出缓冲区（count[0] x count[1]，行主序）
+ * @return 0 成功，-1 失败
+ */
+int region_read(region_dataset_t *ds, const hsize_t offset[2], const hsize_t count[2], double *buf) {
+    if (offset[0] + count[0] > ds->dims[0] || offset[1] + count[1] > ds->dims[1])
+        return -1;
+    if (count[0] == 0 || count[1] == 0)
+        return 0;
+
+    hsize_t tr0 = offset[0] / ds->tile[0], tr1 = (offset[0] + count[0] - 1) / ds->tile[0];
+    hsize_t tc0 = offset[1] / ds->tile[1], tc1 = (offset[1] + count[1] - 1) / ds->tile[1];
+    uint64_t t0 = trace_begin();
+    tile_entry_t *missing[REGION_BATCH];
+    hdf5_io_req_t reqs[REGION_BATCH];
+    int nmissing = 0, ret = 0;
+
+    // 命中的瓦片直接拷贝，未命中的瓦片提交读取请求，攒满一批后等待完成并插入缓存
+    for (hsize_t tr = tr0; tr <= tr1; tr++)
+    for (hsize_t tc = tc0; tc <= tc1; tc++) {
+        hsize_t row = tr * ds->tile[0], col = tc * ds->tile[1];
+        hsize_t rows = ds->dims[0] - row < ds->tile[0] ? ds->dims[0] - row : ds->tile[0];
+        hsize_t cols = ds->dims[1] - col < ds->tile[1] ? ds->dims[1] - col : ds->tile[1];
+        hsize_t r0 = offset[0] > row ? offset[0] - row : 0;
+        hsize_t c0 = offset[1] > col ? offset[1] - col : 0;
+        hsize_t r1 = offset[0] + count[0] < row + rows ? offset[0] + count[0] - row : rows;
+        hsize_t c1 = offset[1] + count[1] < col + cols ? offset[1] + count[1] - col : cols;
+        double *out = buf + (row + r0 - offset[0]) * count[1] + (col + c0 - offset[1]);
+
+        uint64_t hash = tile_hash(ds->key, tr, tc);
+        tile_shard_t *sh = tile_shard(ds->cache, hash);
+        pthread_mutex_lock(&sh->lock);
+        tile_entry_t *e = tile_lookup_locked(sh, hash, ds->key, tr, tc);
+        if (e) {
+            sh->hits++;
+            lru_unlink(e);
+            lru_push_front(sh, e);
+            // 持锁拷贝：瓦片不会在拷贝过程中被淘汰
+            tile_copy_out(e->data, e->cols, r0, c0, r1 - r0, c1 - c0, out, count[1]);
+            pthread_mutex_unlock(&sh->lock);
+            continue;
+        }
+        sh->misses++;
+        pthread_mutex_unlock(&sh->lock);
+
+        e = (tile_entry_t*)calloc(1, sizeof(tile_entry_t));
+        if (e) {
+            e->hash = hash;
+            e->dataset_key = ds->key;
+            e->tile_row = tr;
+            e->tile_col = tc;
+            e->rows = rows;
+            e->cols = cols;
+            e->bytes = rows * cols * sizeof(double);
+            e->data = (double*)pool_alloc(e->bytes);
+        }
+        if (!e || !e->data) {
+            free(e);
+            ret = -1;
+            continue;
+        }
+        memset(&reqs[nmissing], 0, sizeof(reqs[nmissing]));
+        reqs[nmissing].op = IO_READ;
+        reqs[nmissing].obj = ds->dataset_id;
+        reqs[nmissing].row = row;
+        reqs[nmissing].col = col;
+        reqs[nmissing].rows = rows;
+        reqs[nmissing].cols = cols;
+        reqs[nmissing].ld = cols;
+        reqs[nmissing].buf = e->data;
+        hdf5_io_submit(&reqs[nmissing]);
+        missing[nmissing++] = e;
+        if (nmissing == REGION_BATCH) {
+            if (region_finish_batch(ds, offset, count, buf, missing, reqs, nmissing) < 0)
+                ret = -1;
+            nmissing = 0;
+        }
+    }
+    if (region_finish_batch(ds, offset, count, buf, missing, reqs, nmissing) < 0)
+        ret = -1;
+    trace_end(TRACE_REGION_READ, t0, count[0] * count[1] * sizeof(double));
+    return ret;
+}
+
+// 核外(out-of-core)矩阵乘法的统计信息
+typedef struct {
+    int tile;               // 分块边长
+    double bytes_read;      // 从文件读取的字节数
+    double bytes_written;   // 写回文件的字节数
+    double io_time;         // HDF5 读写耗时（秒）
+    double compute_time;    // GEMM 计算耗时（秒）
+    double c_sum;           // 结果矩阵所有元素之和（用于校验）
+} ooc_stats_t;
+
+/**
+ * 核外矩阵乘法：C = A * B，A、B 直接以 hyperslab 分块从 HDF5 文件流式读取
+ * 结果按块累加后写入新数据集 c_name，驻留内存不超过 mem_budget_mb
+ *
+ * @param filename 文件名（需可写）
+ * @param a_name A 数据集名 (m x k)
+ * @param b_name B 数据集名 (k x n)
+ * @param c_name 结果数据集名 (m x n)，已存在时会被覆盖
+ * @param mem_budget_mb 三个分块缓冲区的总内存预算 (MB)
+ * @param stats 输出统计信息，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int ooc_matrix_multiply_hdf5(const char *filename, const char *a_name, const char *b_name,
+                             const char *c_name, double mem_budget_mb, ooc_stats_t *stats) {
+    progress_printf("  [Out-of-core] %s = %s x %s (memory budget: %.1f MB)...\n",
+           c_name, a_name, b_name, mem_budget_mb);
+
+    ooc_stats_t st = {0};
+    hsize_t a_dims[2], b_dims[2];
+    hid_t file_id, a_id = -1, b_id = -1, c_id = -1, space_id;
+    int ret = -1;
+
+    hdf5_direct_begin();
+    file_id = H5Fopen(filename, H5F_ACC_RDWR, file_fapl);
+    if (file_id < 0) {
+        printf("Error: Failed to open HDF5 file %s\n", filename);
+        hdf5_direct_end();
+        return -1;
+    }
+    a_id = H5Dopen(file_id, a_name, H5P_DEFAULT);
+    b_id = H5Dopen(file_id, b_name, H5P_DEFAULT);
+    if (a_id < 0 || b_id < 0) {
+        printf("Error: Failed to open input datasets\n");
+        goto done;
+    }
+
+    space_id = H5Dget_space(a_id);
+    H5Sget_simple_extent_dims(space_id, a_dims, NULL);
+    H5Sclose(space_id);
+    space_id = H5Dget_space(b_id);
+    H5Sget_simple_extent_dims(space_id, b_dims, NULL);
+    H5Sclose(space_id);
+    if (a_dims[1] != b_dims[0]) {
+        printf("Error: Dimension mismatch (%llu x %llu) * (%llu x %llu)\n",
+               (unsigned long long)a_dims[0], (unsigned long long)a_dims[1],
+               (unsigned long long)b_dims[0], (unsigned long long)b_dims[1]);
+        goto done;
+    }
+    int m = (int)a_dims[0], k = (int)a_dims[1], n = (int)b_dims[1];
+
+    // 创建结果数据集
+    if (H5Lexists(file_id, c_name, H5P_DEFAULT) > 0)
+        H5Ldelete(file_id, c_name, H5P_DEFAULT);
+    hsize_t c_dims[2] = {(hsize_t)m, (hsize_t)n};
+    space_id = H5Screate_simple(2, c_dims, NULL);
+    c_id = H5Dcreate(file_id, c_name, H5T_IEEE_F64LE, space_id,
+                     H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Sclose(space_id);
+    if (c_id < 0) {
+        printf("Error: Failed to create dataset %s\n", c_name);
+        goto done;
+    }
+
+    // 由内存预算确定方形分块边长：A、B、C 三个 T x T 缓冲区
+    int T = (int)sqrt(mem_budget_mb * 1024 * 1024 / (3.0 * sizeof(double)));
+    int max_dim = m > n ? m : n;
+    if (k > max_dim) max_dim = k;
+    if (T > max_dim) T = max_dim;
+    if (T < 1) T = 1;
+    st.tile = T;
+
+    size_t tile_elems = (size_t)T * T;
+    size_t tile_bytes = tile_elems * sizeof(double);
+    double *a_tile = (double*)pool_alloc(tile_bytes);
+    double *b_tile = (double*)pool_alloc(tile_bytes);
+    double *c_tile = (double*)pool_alloc(tile_bytes);
+    if (!a_tile || !b_tile || !c_tile) {
+        printf("Error: Failed to allocate %d x %d tiles\n", T, T);
+        pool_free(a_tile, tile_bytes); pool_free(b_tile, tile_bytes); pool_free(c_tile, tile_bytes);
+        goto done;
+    }
+    progress_printf("    Tile size: %d x %d, grid: %d x %d x %d\n", T, T,
+           (m + T - 1) / T, (n + T - 1) / T, (k + T - 1) / T);
+
+    ret = 0;
+    for (int ic = 0; ic < m && ret == 0; ic += T) {
+        int mt = m - ic < T ? m - ic : T;
+        for (int jc = 0; jc < n && ret == 0; jc += T) {
+            int nt = n - jc < T ? n - jc : T;
+            memset(c_tile, 0, (size_t)mt * nt * sizeof(double));
+
+            // 沿公共维度流式读取 A 行块与 B 列块并累加到 C 块
+            for (int pc = 0; pc < k; pc += T) {
+                int kt = k - pc < T ? k - pc : T;
+                double t0 = omp_get_wtime();
+                if (hdf5_tile_io(a_id, 0, ic, pc, mt, kt, a_tile, kt) < 0 ||
+                    hdf5_tile_io(b_id, 0, pc, jc, kt, nt, b_tile, nt) < 0) {
+                    printf("Error: Failed to read tiles at (%d, %d, %d)\n", ic, jc, pc);
+                    ret = -1;
+                    break;
+                }
+                double t1 = omp_get_wtime();
+                if (gemm_blocked(mt, nt, kt, a_tile, kt, b_tile, nt, c_tile, nt) < 0) {
+                    printf("Error: Failed to allocate GEMM packing buffers\n");
+                    ret = -1;
+                    break;
+                }
+                st.io_time += t1 - t0;
+                st.compute_time += omp_get_wtime() - t1;
+                st.bytes_read += ((double)mt * kt + (double)kt * nt) * sizeof(double);
+            }
+            if (ret < 0)
+                break;
+
+            double tile_sum = 0.0;
+            #pragma omp parallel for reduction(+:tile_sum)
+            for (size_t i = 0; i < (size_t)mt * nt; i++)
+                tile_sum += c_tile[i];
+            st.c_sum += tile_sum;
+
+            // 写回完成的 C 块
+            double t0 = omp_get_wtime();
+            if (hdf5_tile_io(c_id, 1, ic, jc, mt, nt, c_tile, nt) < 0) {
+                printf("Error: Failed to write tile (%d, %d) of %s\n", ic, jc, c_name);
+                ret = -1;
+            }
+            st.io_time += omp_get_wtime() - t0;
+            st.bytes_written += (double)mt * nt * sizeof(double);
+        }
+    }
+    pool_free(a_tile, tile_bytes); pool_free(b_tile, tile_bytes); pool_free(c_tile, tile_bytes);
+
+done:
+    if (c_id >= 0) H5Dclose(c_id);
+    if (b_id >= 0) H5Dclose(b_id);
+    if (a_id >= 0) H5Dclose(a_id);
+    H5Fclose(file_id);
+    hdf5_direct_end();
+    if (stats)
+        *stats = st;
+    if (ret == 0)
+        progress_printf("  [Out-of-core] Finish writing %s.\n", c_name);
+    return ret;
+}
+
+/**
+ * 计算 sum(A * B) 的期望值，无需做矩阵乘法：
+ * sum_ij (AB)_ij = sum_k (sum_i A_ik) * (sum_j B_kj)
+ */
+double expected_product_sum(const double *A, const double *B, int n) {
+    double total = 0.0;
+    #pragma omp parallel for reduction(+:total)
+    for (int p = 0; p < n; p++) {
+        double col_a = 0.0, row_b = 0.0;
+        for (int i = 0; i < n; i++)
+            col_a += A[(size_t)i*n + p];
+        for (int j = 0; j < n; j++)
+            row_b += B[(size_t)p*n + j];
+        total += col_a * row_b;
+    }
+    return total;
+}
+
+/**
+ * 计算 rows x n 行块的元素和（用于只持有部分行的场景）
+ */
+double verify_matrix_rows(const double *matrix, int rows, int n) {
+    matrix_checksum_t cs;
+    if (checksum_matrix(matrix, rows, n, &cs) < 0) {
+        printf("Error: Failed to allocate checksum buffers\n");
+        return NAN;
+    }
+    return cs.sum;
+}
+
+/**
+ * 验证矩阵数据的正确性
+ * 返回补偿求和结果，与线程数和归约顺序无关，可直接按位比较
+ */
+double verify_matrix(double *matrix, int n) {
+    return verify_matrix_rows(matrix, n, n);
+}
+
+void print_performance_stats(const char* operation, double parallel_time, 
+                           double serial_time, double data_size_mb) {
+    printf("\n=== %s 性能统计 ===\n", operation);
+    printf("数据大小: %.2f MB\n", data_size_mb);
+    printf("并行时间: %.4f 秒\n", parallel_time);
+    printf("串行时间: %.4f 秒\n", serial_time);
+    printf("加速比: %.2fx\n", serial_time / parallel_time);
+    printf("并行效率: %.2f%%\n", (serial_time / parallel_time) / omp_get_max_threads() * 100);
+    printf("=============================\n\n");
+}
+
+/**
+ * 估算机器双精度理论峰值 (GFLOP/s)
+ * 频率取自 /proc/cpuinfo 的 "cpu MHz"，无法获取时返回 0
+ */
+double estimate_peak_gflops(const gemm_kernel_t *kern, int threads) {
+    double mhz = 0.0;
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+    if (fp) {
+        char line[256];
+        while (fgets(line, sizeof(line), fp)) {
+            if (sscanf(line, "cpu MHz : %lf", &mhz) == 1)
+                break;
+        }
+        fclose(fp);
+    }
+    return mhz / 1000.0 * kern->flops_per_cycle * threads;
+}
+
+/**
+ * GEMM 性能测试
+ * 1. 在 GEMM_CHECK_SIZE 大小的子矩阵上与朴素串行乘法对比，校验正确性
+ * 2. 对完整的 n x n 矩阵计时并报告 GFLOP/s 及相对理论峰值的比例
+ */
+void benchmark_gemm(double *A, double *B, int n) {
+    const gemm_kernel_t *kern = gemm_select_kernel();
+    int threads = omp_get_max_threads();
+    int nc = n < GEMM_CHECK_SIZE ? n : GEMM_CHECK_SIZE;
+    size_t check_elems = (size_t)nc * nc;
+    double start_time, parallel_time, serial_time;
+
+    printf("  GEMM 微内核: %s (MR=%d, NR=%d, MC=%d, KC=%d, NC=%d)\n",
+           kern->name, kern->mr, kern->nr, kern->mc, kern->kc, kern->nc);
+
+    // 正确性校验：截取左上角 nc x nc 子矩阵
+    size_t check_bytes = check_elems * sizeof(double);
+    double *a = (double*)pool_alloc(check_bytes);
+    double *b = (double*)pool_alloc(check_bytes);
+    double *c_par = (double*)pool_alloc(check_bytes);
+    double *c_ser = (double*)pool_alloc(check_bytes);
+    if (!a || !b || !c_par || !c_ser) {
+        printf("Error: Failed to allocate GEMM check buffers\n");
+        pool_free(a, check_bytes); pool_free(b, check_bytes);
+        pool_free(c_par, check_bytes); pool_free(c_ser, check_bytes);
+        return;
+    }
+    for (int i = 0; i < nc; i++) {
+        memcpy(a + (size_t)i*nc, A + (size_t)i*n, nc * sizeof(double));
+        memcpy(b + (size_t)i*nc, B + (size_t)i*n, nc * sizeof(double));
+    }
+
+    start_time = omp_get_wtime();
+    matrix_multiply_parallel(a, b, c_par, nc);
+    parallel_time = omp_get_wtime() - start_time;
+
+    start_time = omp_get_wtime();
+    matrix_multiply_serial(a, b, c_ser, nc);
+    serial_time = omp_get_wtime() - start_time;
+
+    double max_err = 0.0;
+    #pragma omp parallel for reduction(max:max_err)
+    for (size_t i = 0; i < check_elems; i++) {
+        double denom = fabs(c_ser[i]) > 1.0 ? fabs(c_ser[i]) : 1.0;
+        double err = fabs(c_par[i] - c_ser[i]) / denom;
+        if (err > max_err)
+            max_err = err;
+    }
+    double check_gflop = 2.0 * nc * nc * (double)nc / 1e9;
+    printf("  正确性校验 (%dx%d): 最大相对误差 = %.3e %s\n", nc, nc, max_err,
+           max_err < 1e-12 * nc ? "[通过]" : "[失败]");
+    print_performance_stats("GEMM 校验规模", parallel_time, serial_time,
+                            3.0 * check_elems * sizeof(double) / (1024 * 1024));
+    printf("  分块 GEMM: %.2f GFLOP/s, 朴素串行: %.2f GFLOP/s\n\n",
+           check_gflop / parallel_time, check_gflop / serial_time);
+    pool_free(a, check_bytes); pool_free(b, check_bytes);
+    pool_free(c_par, check_bytes); pool_free(c_ser, check_bytes);
+
+    // 完整规模计时
+    double *C = matrix_alloc(n, n);
+    if (!C) {
+        printf("Error: Failed to allocate GEMM result matrix\n");
+        return;
+    }
+    start_time = omp_get_wtime();
+    matrix_multiply_parallel(A, B, C, n);
+    parallel_time = omp_get_wtime() - start_time;
+
+    double gflops = 2.0 * n * n * (double)n / 1e9 / parallel_time;
+    double peak = estimate_peak_gflops(kern, threads);
+    printf("\n=== GEMM (%dx%d) 性能统计 ===\n", n, n);
+    printf("计算时间: %.4f 秒\n", parallel_time);
+    printf("计算性能: %.2f GFLOP/s (每线程 %.2f GFLOP/s)\n", gflops, gflops / threads);
+    if (peak > 0.0)
+        printf("估算峰值: %.2f GFLOP/s (%d 线程), 达到峰值的 %.1f%%\n",
+               peak, threads, gflops / peak * 100);
+    printf("=============================\n\n");
+    matrix_free(C, n, n);
+}
+
+// ===================== 海量小数据集：文件配置与批量创建/打开 =====================
+// 数据集数量达到十万级时，每个 H5Dcreate/H5Dopen 的元数据开销（对象头、链接索引、空闲空间管理）
+// 远超过数据本身。文件配置 hdf5_file_profile_t 把相关的库参数集中起来：最新文件格式（稠密链接存储 +
+// v2 B 树名称索引）、分页聚合文件空间策略、页缓冲、元数据缓存大小、元数据块聚合和对齐。
+// 数据集在 I/O 线程上按批创建/写入/打开/读取，一批只需一次队列往返，生成下一批数据与当前批的 I/O 重叠；
+// 写入时生成索引表 /many_index（名称、形状、数据偏移），读取方直接按表打开，不需要遍历组。
+
+#define MANY_NAME_LEN 16
+#define MANY_GROUP "/many"
+#define MANY_INDEX "/many_index"
+
+typedef struct {
+    const char *name;
+    int latest_format;          // H5F_LIBVER_LATEST 文件格式
+    int paged;                  // H5F_FSPACE_STRATEGY_PAGE 分页聚合
+    hsize_t page_size;          // 文件空间页大小（字节）
+    size_t mdc_mb;              // 元数据缓存初始/最大大小，0 表示库默认
+    hsize_t align_threshold;    // 不小于此字节数的对象按 alignment 对齐
+    hsize_t alignment;          // 0 表示不对齐
+    size_t meta_block_kb;       // 元数据/小块原始数据聚合块大小，0 表示库默认 (2KB)
+    int track_times;            // 是否记录对象时间戳
+    int batch;                  // 每次提交给 I/O 线程的数据集数
+} hdf5_file_profile_t;
+
+// many-latest 另外使用最新文件格式：文件更小、打开略快，但 1.10 在单个大组中用稠密链接存储创建明显更慢；
+// 加大元数据缓存（mdc_mb）实测会拖慢打开，因此两个配置都保留库默认的自适应缓存。
+// 不使用页缓冲 (H5Pset_page_buffer_size)：1.10.8 上打开海量数据集时 H5PB_read 堆越界（ASan 可复现）
+static const hdf5_file_profile_t file_profiles[] = {
+    {"default", 0, 0, 0, 0, 0, 0, 0, 1, 1},
+    {"many", 0, 1, 64 * 1024, 0, 0, 0, 1024, 0, 512},
+    {"many-latest", 1, 1, 64 * 1024, 0, 0, 0, 1024, 0, 512},
+};
+#define NUM_FILE_PROFILES (int)(sizeof(file_profiles) / sizeof(file_profiles[0]))
+
+// 索引表的一项
+typedef struct {
+    char name[MANY_NAME_LEN];   // 组 MANY_GROUP 下的数据集名称
+    uint32_t rows, cols;
+    uint64_t offset;            // 数据在文件中的字节偏移
+} many_index_entry_t;
+
+// 海量数据集读写统计
+typedef struct {
+    long datasets;
+    double create_time, write_time;     // I/O 线程上 H5Dcreate / H5Dwrite+H5Dclose 累计耗时
+    double open_time, read_time;        // I/O 线程上 H5Dopen / H5Dread+H5Dclose 累计耗时
+    double total_time;                  // 端到端耗时
+    double file_mb;
+    long mismatched;
+} many_stats_t;
+
+// 文件访问属性列表：在默认文件驱动的基础上设置格式版本、元数据缓存、对齐；无设置时返回 H5P_DEFAULT
+hid_t make_profile_fapl(const hdf5_file_profile_t *profile) {
+    if (!profile->latest_format && !profile->mdc_mb && !profile->alignment && !profile->meta_block_kb)
+        return H5P_DEFAULT;
+    hid_t fapl = file_fapl != H5P_DEFAULT ? H5Pcopy(file_fapl) : H5Pcreate(H5P_FILE_ACCESS);
+    if (profile->latest_format)
+        H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+    if (profile->mdc_mb) {
+        H5AC_cache_config_t mdc;
+        mdc.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+        H5Pget_mdc_config(fapl, &mdc);
+        mdc.set_initial_size = 1;
+        mdc.initial_size = profile->mdc_mb << 20;
+        mdc.max_size = profile->mdc_mb << 20;
+        if (mdc.min_size > mdc.initial_size)
+            mdc.min_size = mdc.initial_size;
+        H5Pset_mdc_config(fapl, &mdc);
+    }
+    if (profile->alignment)
+        H5Pset_alignment(fapl, profile->align_threshold, profile->alignment);
+    if (profile->meta_block_kb) {
+        H5Pset_meta_block_size(fapl, profile->meta_block_kb << 10);
+        H5Pset_small_data_block_size(fapl, profile->meta_block_kb << 10);
+    }
+    return fapl;
+}
+
+// 文件创建属性列表：分页聚合文件空间策略；无设置时返回 H5P_DEFAULT
+hid_t make_profile_fcpl(const hdf5_file_profile_t *profile) {
+    if (!profile->paged)
+        return H5P_DEFAULT;
+    hid_t fcpl = H5Pcreate(H5P_FILE_CREATE);
+    H5Pset_file_space_strategy(fcpl, H5F_FSPACE_STRATEGY_PAGE, 0, 1);
+    H5Pset_file_space_page_size(fcpl, profile->page_size);
+    return fcpl;
+}
+
+// 小数据集的创建属性列表；无设置时返回 H5P_DEFAULT
+static hid_t make_profile_dcpl(const hdf5_file_profile_t *profile) {
+    if (profile->track_times)
+        return H5P_DEFAULT;
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_obj_track_times(dcpl, 0);
+    return dcpl;
+}
+
+static hid_t many_index_h5type(void) {
+    hid_t name_type = H5Tcopy(H5T_C_S1);
+    H5Tset_size(name_type, MANY_NAME_LEN);
+    hid_t type_id = H5Tcreate(H5T_COMPOUND, sizeof(many_index_entry_t));
+    H5Tinsert(type_id, "name", HOFFSET(many_index_entry_t, name), name_type);
+    H5Tinsert(type_id, "rows", HOFFSET(many_index_entry_t, rows), H5T_NATIVE_UINT32);
+    H5Tinsert(type_id, "cols", HOFFSET(many_index_entry_t, cols), H5T_NATIVE_UINT32);
+    H5Tinsert(type_id, "offset", HOFFSET(many_index_entry_t, offset), H5T_NATIVE_UINT64);
+    H5Tclose(name_type);
+    return type_id;
+}
+
+// 一批数据集的 I/O 请求，在 I/O 线程上执行
+typedef struct {
+    hid_t group_id, dcpl;
+    int first, count, n;
+    double *data;                   // count 个 n x n 矩阵，连续存放
+    many_index_entry_t *index;      // 全局索引表
+    double create_time, write_time, open_time, read_time;
+    int failed;
+} many_batch_t;
+
+static void many_write_callback(hdf5_io_req_t *req) {
+    many_batch_t *b = (many_batch_t*)req->arg;
+    hsize_t dims[2] = {b->n, b->n};
+    hid_t space_id = H5Screate_simple(2, dims, NULL);
+    for (int k = 0; k < b->count; k++) {
+        many_index_entry_t *e = &b->index[b->first + k];
+        double t0 = omp_get_wtime();
+        hid_t dataset_id = H5Dcreate(b->group_id, e->name, H5T_IEEE_F64LE, space_id,
+                                     H5P_DEFAULT, b->dcpl, H5P_DEFAULT);
+        double t1 = omp_get_wtime();
+        if (dataset_id < 0 ||
+            H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                     b->data + (size_t)k * b->n * b->n) < 0)
+            b->failed++;
+        if (dataset_id >= 0) {
+            e->offset = H5Dget_offset(dataset_id);
+            H5Dclose(dataset_id);
+        }
+        b->create_time += t1 - t0;
+        b->write_time += omp_get_wtime() - t1;
+    }
+    H5Sclose(space_id);
+    req->result = b->failed ? -1 : 0;
+}
+
+static void many_read_callback(hdf5_io_req_t *req) {
+    many_batch_t *b = (many_batch_t*)req->arg;
+    for (int k = 0; k < b->count; k++) {
+        const many_index_entry_t *e = &b->index[b->first + k];
+        double t0 = omp_get_wtime();
+        hid_t dataset_id = H5Dopen(b->group_id, e->name, H5P_DEFAULT);
+        double t1 = omp_get_wtime();
+        if (dataset_id < 0 || e->rows != (uint32_t)b->n || e->cols != (uint32_t)b->n ||
+            H5Dread(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                    b->data + (size_t)k * b->n * b->n) < 0)
+            b->failed++;
+        if (dataset_id >= 0)
+            H5Dclose(dataset_id);
+        b->open_time += t1 - t0;
+        b->read_time += omp_get_wtime() - t1;
+    }
+    req->result = b->failed ? -1 : 0;
+}
+
+// 打开（flags = 0）、创建（flags = 1）数据集组：obj = file_id -> result = group_id；
+// 关闭（flags = 2）：obj = group_id
+static void many_group_callback(hdf5_io_req_t *req) {
+    if (req->flags == 2) {
+        req->result = H5Gclose(req->obj);
+    } else if (req->flags == 1) {
+        hid_t lcpl = H5Pcreate(H5P_LINK_CREATE);
+        H5Pset_create_intermediate_group(lcpl, 1);
+        req->result = H5Gcreate(req->obj, req->name, lcpl, H5P_DEFAULT, H5P_DEFAULT);
+        H5Pclose(lcpl);
+    } else {
+        req->result = H5Gopen(req->obj, req->name, H5P_DEFAULT);
+    }
+}
+
+// 写（flags = 1）或读索引表：obj = file_id, arg -> many_index_entry_t*, rows = 项数
+static void many_index_callback(hdf5_io_req_t *req) {
+    many_index_entry_t **entries = (many_index_entry_t**)req->arg;
+    hid_t type_id = many_index_h5type();
+    if (req->flags) {
+        hsize_t dims[1] = {req->rows};
+        hid_t space_id = H5Screate_simple(1, dims, NULL);
+        hid_t index_id = H5Dcreate(req->obj, req->name, type_id, space_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        req->result = index_id < 0 ? -1 : H5Dwrite(index_id, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, *entries);
+        if (index_id >= 0) H5Dclose(index_id);
+        H5Sclose(space_id);
+    } else {
+        hid_t index_id = H5Dopen(req->obj, req->name, H5P_DEFAULT);
+        hid_t space_id = index_id < 0 ? -1 : H5Dget_space(index_id);
+        hssize_t count = space_id < 0 ? -1 : H5Sget_simple_extent_npoints(space_id);
+        *entries = count < 0 ? NULL : (many_index_entry_t*)malloc(((size_t)count ? (size_t)count : 1) *
+                                                                  sizeof(many_index_entry_t));
+        req->result = !*entries ? -1 :
+                      H5Dread(index_id, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, *entries);
+        req->rows = count < 0 ? 0 : (hsize_t)count;
+        if (space_id >= 0) H5Sclose(space_id);
+        if (index_id >= 0) H5Dclose(index_id);
+    }
+    H5Tclose(type_id);
+}
+
+// 打开/创建文件，plist/fcpl 由调用者负责关闭
+static hid_t many_open_file(const char *filename, int create, hid_t fapl, hid_t fcpl) {
+    hdf5_io_req_t req = {0};
+    req.op = create ? IO_FILE_CREATE : IO_FILE_OPEN;
+    req.name = filename;
+    req.flags = H5F_ACC_RDONLY;
+    req.plist = fapl;
+    req.fcpl = fcpl;
+    hdf5_io_submit(&req);
+    return hdf5_io_wait(&req);
+}
+
+static hid_t many_io_callback(void (*callback)(hdf5_io_req_t*), hid_t obj, const char *name,
+                              unsigned flags, hsize_t rows, void *arg, hsize_t *rows_out) {
+    hdf5_io_req_t req = {0};
+    req.op = IO_CALLBACK;
+    req.callback = callback;
+    req.obj = obj;
+    req.name = name;
+    req.flags = flags;
+    req.rows = rows;
+    req.arg = arg;
+    hdf5_io_submit(&req);
+    hid_t result = hdf5_io_wait(&req);
+    if (rows_out)
+        *rows_out = req.rows;
+    return result;
+}
+
+/**
+ * 写入 count 个 n x n 小数据集到 MANY_GROUP，并生成索引表 MANY_INDEX
+ * 第 i 个数据集的内容与 init_matrix_parallel(m, n, i) 相同；生成下一批与 I/O 线程写当前批重叠
+ *
+ * @param profile 文件配置（包括批大小）
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int many_write_hdf5(const char *filename, int count, int n, const hdf5_file_profile_t *profile,
+                    many_stats_t *stats) {
+    progress_printf("  [Many] Write %d %dx%d datasets (profile %s, batch %d)...\n",
+                    count, n, n, profile->name, profile->batch);
+    many_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    hdf5_direct_begin();
+    hid_t fapl = make_profile_fapl(profile), fcpl = make_profile_fcpl(profile);
+    hid_t dcpl = make_profile_dcpl(profile);
+    hdf5_direct_end();
+    hid_t file_id = many_open_file(filename, 1, fapl, fcpl);
+    hid_t group_id = file_id < 0 ? -1 : many_io_callback(many_group_callback, file_id, MANY_GROUP, 1, 0, NULL, NULL);
+    int batch = profile->batch > 0 ? profile->batch : 1;
+    size_t batch_bytes = (size_t)batch * n * n * sizeof(double);
+    many_index_entry_t *index = (many_index_entry_t*)calloc(count ? count : 1, sizeof(many_index_entry_t));
+    many_batch_t batches[2];
+    hdf5_io_req_t reqs[2];
+    int ret = file_id >= 0 && group_id >= 0 && index ? 0 : -1;
+
+    for (int s = 0; s < 2; s++) {
+        memset(&batches[s], 0, sizeof(batches[s]));
+        batches[s].data = (double*)pool_alloc(batch_bytes);
+        reqs[s].op = IO_SHUTDOWN;   // 标记为空闲槽位
+        if (!batches[s].data) ret = -1;
+    }
+    for (int first = 0, b = 0; ret == 0 && first < count; first += batch, b++) {
+        many_batch_t *mb = &batches[b % 2];
+        hdf5_io_req_t *req = &reqs[b % 2];
+        if (req->op == IO_CALLBACK && hdf5_io_wait(req) < 0)
+            ret = -1;
+        mb->group_id = group_id;
+        mb->dcpl = dcpl;
+        mb->first = first;
+        mb->count = first + batch <= count ? batch : count - first;
+        mb->n = n;
+        mb->index = index;
+
+        uint64_t t0 = trace_begin();
+        #pragma omp parallel for schedule(static)
+        for (int k = 0; k < mb->count; k++) {
+            snprintf(index[first + k].name, MANY_NAME_LEN, "d%07d", first + k);
+            index[first + k].rows = index[first + k].cols = (uint32_t)n;
+            for (int r = 0; r < n; r++)
+                philox_fill_row(mb->data + ((size_t)k * n + r) * n, RNG_SEED, (uint32_t)(first + k), (uint32_t)r, n);
+        }
+        trace_end(TRACE_PRODUCE, t0, (uint64_t)mb->count * n * n * sizeof(double));
+
+        memset(req, 0, sizeof(*req));
+        req->op = IO_CALLBACK;
+        req->callback = many_write_callback;
+        req->arg = mb;
+        hdf5_io_submit(req);
+    }
+    for (int s = 0; s < 2; s++) {
+        if (reqs[s].op == IO_CALLBACK && hdf5_io_wait(&reqs[s]) < 0)
+            ret = -1;
+        st.create_time += batches[s].create_time;
+        st.write_time += batches[s].write_time;
+        pool_free(batches[s].data, batch_bytes);
+    }
+
+    if (ret == 0 && many_io_callback(many_index_callback, file_id, MANY_INDEX, 1, (hsize_t)count, &index, NULL) < 0)
+        ret = -1;
+    if (group_id >= 0)
+        many_io_callback(many_group_callback, group_id, NULL, 2, 0, NULL, NULL);
+    if (file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    hdf5_direct_begin();
+    if (dcpl != H5P_DEFAULT) H5Pclose(dcpl);
+    if (fcpl != H5P_DEFAULT) H5Pclose(fcpl);
+    if (fapl != H5P_DEFAULT) H5Pclose(fapl);
+    hdf5_direct_end();
+    free(index);
+
+    struct stat sb;
+    st.datasets = count;
+    st.total_time = omp_get_wtime() - t_start;
+    st.file_mb = stat(filename, &sb) == 0 ? sb.st_size / (1024.0 * 1024.0) : 0.0;
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Failed to write datasets to %s\n", filename);
+    return ret;
+}
+
+/**
+ * 按索引表 MANY_INDEX 批量打开并读取全部小数据集（不遍历组），并与生成数据逐位比对
+ * 读取下一批与校验上一批重叠
+ *
+ * @param profile 文件配置，须与写入时的分页设置一致（页缓冲要求分页文件）
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int many_read_hdf5(const char *filename, int n, const hdf5_file_profile_t *profile, many_stats_t *stats) {
+    many_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    hdf5_direct_begin();
+    hid_t fapl = make_profile_fapl(profile);
+    hdf5_direct_end();
+    hid_t file_id = many_open_file(filename, 0, fapl, H5P_DEFAULT);
+    hid_t group_id = file_id < 0 ? -1 : many_io_callback(many_group_callback, file_id, MANY_GROUP, 0, 0, NULL, NULL);
+    many_index_entry_t *index = NULL;
+    hsize_t count = 0;
+    int batch = profile->batch > 0 ? profile->batch : 1;
+    size_t batch_bytes = (size_t)batch * n * n * sizeof(double);
+    many_batch_t batches[2];
+    hdf5_io_req_t reqs[2];
+    int ret = group_id >= 0 &&
+              many_io_callback(many_index_callback, file_id, MANY_INDEX, 0, 0, &index, &count) >= 0 ? 0 : -1;
+    progress_printf("  [Many] Read %llu %dx%d datasets via %s (profile %s, batch %d)...\n",
+                    (unsigned long long)count, n, n, MANY_INDEX, profile->name, batch);
+
+    for (int s = 0; s < 2; s++) {
+        memset(&batches[s], 0, sizeof(batches[s]));
+        batches[s].data = (double*)pool_alloc(batch_bytes);
+        reqs[s].op = IO_SHUTDOWN;   // 标记为空闲槽位
+        if (!batches[s].data) ret = -1;
+    }
+    // 第 b 批读取提交后校验第 b-1 批；最后一轮只校验
+    for (long first = 0, b = 0; ret == 0 && first < (long)count + batch; first += batch, b++) {
+        if (first < (long)count) {
+            many_batch_t *mb = &batches[b % 2];
+            hdf5_io_req_t *req = &reqs[b % 2];
+            mb->group_id = group_id;
+            mb->first = (int)first;
+            mb->count = first + batch <= (long)count ? batch : (int)(count - first);
+            mb->n = n;
+            mb->index = index;
+            memset(req, 0, sizeof(*req));
+            req->op = IO_CALLBACK;
+            req->callback = many_read_callback;
+            req->arg = mb;
+            hdf5_io_submit(req);
+        }
+        if (b == 0)
+            continue;
+        many_batch_t *prev = &batches[(b - 1) % 2];
+        long bad = 0;
+        if (hdf5_io_wait(&reqs[(b - 1) % 2]) < 0)
+            ret = -1;
+        reqs[(b - 1) % 2].op = IO_SHUTDOWN;
+        #pragma omp parallel reduction(+:bad)
+        {
+            double *row = (double*)pool_alloc(n * sizeof(double));
+            #pragma omp for schedule(static)
+            for (int k = 0; k < prev->count; k++) {
+                for (int r = 0; row && r < n; r++) {
+                    philox_fill_row(row, RNG_SEED, (uint32_t)(prev->first + k), (uint32_t)r, n);
+                    if (memcmp(row, prev->data + ((size_t)k * n + r) * n, n * sizeof(double)) != 0) {
+                        bad++;
+                        break;
+                    }
+                }
+            }
+            pool_free(row, n * sizeof(double));
+        }
+        st.mismatched += bad;
+    }
+    for (int s = 0; s < 2; s++) {
+        if (reqs[s].op == IO_CALLBACK && hdf5_io_wait(&reqs[s]) < 0)
+            ret = -1;
+        st.open_time += batches[s].open_time;
+        st.read_time += batches[s].read_time;
+        pool_free(batches[s].data, batch_bytes);
+    }
+
+    if (group_id >= 0)
+        many_io_callback(many_group_callback, group_id, NULL, 2, 0, NULL, NULL);
+    if (file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    hdf5_direct_begin();
+    if (fapl != H5P_DEFAULT) H5Pclose(fapl);
+    hdf5_direct_end();
+    free(index);
+
+    st.datasets = (long)count;
+    st.total_time = omp_get_wtime() - t_start;
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Failed to read datasets from %s\n", filename);
+    return ret;
+}
+
+/**
+ * 打印海量数据集各阶段的 datasets/s
+ */
+void print_many_stats(const char *label, const many_stats_t *w, const many_stats_t *r) {
+    printf("%s: 创建 %.0f 个/秒, 写入 %.0f 个/秒, 打开 %.0f 个/秒, 读取 %.0f 个/秒\n", label,
+           w->create_time > 0 ? w->datasets / w->create_time : 0.0,
+           w->write_time > 0 ? w->datasets / w->write_time : 0.0,
+           r->open_time > 0 ? r->datasets / r->open_time : 0.0,
+           r->read_time > 0 ? r->datasets / r->read_time : 0.0);
+    printf("  端到端: 写 %.4f 秒 (%.0f 个/秒), 读 %.4f 秒 (%.0f 个/秒), 文件 %.2f MB\n",
+           w->total_time, w->datasets / w->total_time,
+           r->total_time, r->datasets / r->total_time, w->file_mb);
+}
+
+// ===================== 增量追加：可扩展数据集 =====================
+// 生产者持续产生行数据，数据集必须能在创建后增长：行维度的 maxdims 为 H5S_UNLIMITED，按行分块存储。
+// 生产者线程把行批提交到合并缓冲区（APPEND_RING_SIZE 个槽位的环）：预留行位置时持锁，拷贝时不持锁，
+// 最后一个完成拷贝的线程把写满的槽位提交给 I/O 线程，由 I/O 线程 H5Dset_extent + 超平面写入。
+// 刷新批大小向上取整到分块行数的整数倍，写入总是覆盖完整分块；槽位用尽时生产者等待最早的刷新完成（背压）。
+// 可选 SWMR：文件使用最新格式并在创建数据集后开始 SWMR 写入，每次刷新后 H5Dflush，
+// 其他进程可以用 H5F_ACC_SWMR_READ 打开文件并通过 H5Drefresh 追踪增长（见 append_tail_hdf5）。
+
+#define APPEND_DATASET "/stream"
+#define APPEND_RING_SIZE 4           // 合并缓冲区槽位数
+#define APPEND_CHUNK_ROWS 64         // 分块行数上限（批更小时使用批大小）
+#define APPEND_BATCH_ROWS 1024       // 默认刷新批大小（行），可由 --append-batch 覆盖
+#define APPEND_PRODUCER_ROWS 8       // 生产者每次提交的行数
+#define APPEND_TAIL_IDLE 2.0         // 追踪读取方在行数这么多秒不增长后退出
+
+enum { APPEND_SLOT_FREE, APPEND_SLOT_FILLING, APPEND_SLOT_SUBMITTED };
+
+struct append_stream;
+
+// 合并缓冲区槽位：batch_rows 行，从开始接收行到刷新完成为止不能复用
+typedef struct {
+    struct append_stream *stream;
+    double *rows;
+    hsize_t reserved;               // 已分配给生产者的行数（受 stream->lock 保护）
+    atomic_ulong copied;            // 已拷贝完成的行数
+    atomic_int state;
+    hdf5_io_req_t req;
+} append_slot_t;
+
+typedef struct append_stream {
+    hid_t file_id, dataset_id;
+    hsize_t cols, batch_rows, chunk_rows;
+    int swmr;
+    pthread_mutex_t lock;
+    int current;                    // 正在接收行的槽位
+    append_slot_t slots[APPEND_RING_SIZE];
+    hsize_t extent;                 // 已写入文件的行数（仅 I/O 线程修改）
+    long flushes;                   // 刷新次数（仅 I/O 线程修改）
+    double flush_time;              // I/O 线程上 H5Dset_extent + 写入累计耗时
+    double stall_time;              // 生产者等待空闲槽位的累计耗时（受 lock 保护）
+    double t_start;
+    atomic_int failed;
+} append_stream_t;
+
+// 追加统计
+typedef struct {
+    hsize_t rows;
+    long flushes;
+    int batch_rows;
+    double flush_time, stall_time, total_time;
+    double rows_per_s;
+} append_stats_t;
+
+static void append_create_callback(hdf5_io_req_t *req) {
+    append_stream_t *s = (append_stream_t*)req->arg;
+    hsize_t dims[2] = {0, s->cols};
+    hsize_t maxdims[2] = {H5S_UNLIMITED, s->cols};
+    hsize_t chunk[2] = {s->chunk_rows, s->cols};
+    hid_t space_id = H5Screate_simple(2, dims, maxdims);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, 2, chunk);
+    s->dataset_id = H5Dcreate(s->file_id, req->name, H5T_IEEE_F64LE, space_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(space_id);
+    if (s->dataset_id < 0 || (s->swmr && H5Fstart_swmr_write(s->file_id) < 0))
+        req->result = -1;
+}
+
+// 在文件末尾追加一个槽位的 req->rows 行；刷新按提交顺序执行，行不会留空洞
+static void append_flush_callback(hdf5_io_req_t *req) {
+    append_slot_t *slot = (append_slot_t*)req->arg;
+    append_stream_t *s = slot->stream;
+    double t0 = omp_get_wtime();
+    hsize_t dims[2] = {s->extent + req->rows, s->cols};
+    if (H5Dset_extent(s->dataset_id, dims) < 0 ||
+        hdf5_tile_io(s->dataset_id, 1, s->extent, 0, req->rows, s->cols, slot->rows, s->cols) < 0 ||
+        (s->swmr && H5Dflush(s->dataset_id) < 0)) {
+        req->result = -1;
+        return;
+    }
+    s->extent += req->rows;
+    s->flushes++;
+    s->flush_time += omp_get_wtime() - t0;
+}
+
+static void append_submit(append_slot_t *slot, hsize_t rows) {
+    memset(&slot->req, 0, sizeof(slot->req));
+    slot->req.op = IO_CALLBACK;
+    slot->req.callback = append_flush_callback;
+    slot->req.arg = slot;
+    slot->req.rows = rows;
+    hdf5_io_submit(&slot->req);
+    atomic_store_explicit(&slot->state, APPEND_SLOT_SUBMITTED, memory_order_release);
+    futex_wake_all(&slot->state);
+}
+
+// 等待槽位上的刷新完成并把它置为空闲；仍在拷贝中的槽位先等拷贝线程提交
+static void append_slot_drain(append_stream_t *s, append_slot_t *slot) {
+    futex_wait_while(&slot->state, APPEND_SLOT_FILLING);
+    if (atomic_load_explicit(&slot->state, memory_order_acquire) == APPEND_SLOT_SUBMITTED &&
+        hdf5_io_wait(&slot->req) < 0)
+        atomic_store(&s->failed, 1);
+    atomic_store_explicit(&slot->state, APPEND_SLOT_FREE, memory_order_relaxed);
+}
+
+// 当前槽位已预留满：切换到下一个槽位（调用者持有 s->lock）
+static void append_advance(append_stream_t *s) {
+    s->current = (s->current + 1) % APPEND_RING_SIZE;
+    append_slot_t *slot = &s->slots[s->current];
+    if (atomic_load_explicit(&slot->state, memory_order_acquire) != APPEND_SLOT_FREE) {
+        double t0 = omp_get_wtime();
+        append_slot_drain(s, slot);
+        s->stall_time += omp_get_wtime() - t0;
+    }
+    slot->reserved = 0;
+    atomic_store_explicit(&slot->copied, 0, memory_order_relaxed);
+    atomic_store_explicit(&slot->state, APPEND_SLOT_FILLING, memory_order_release);
+}
+
+/**
+ * 创建追加文件与可扩展数据集（0 x cols，行维度不限），需要 I/O 服务线程已启动
+ * 失败时同样需要调用 append_close 释放资源
+ *
+ * @param batch_rows 刷新批大小（行），向上取整到分块行数的整数倍
+ * @param swmr 非 0 时开启 SWMR 写入，读取方可以在写入过程中追踪文件
+ * @return 0 成功，-1 失败
+ */
+int append_open(append_stream_t *s, const char *filename, const char *dname, hsize_t cols,
+                int batch_rows, int swmr) {
+    memset(s, 0, sizeof(*s));
+    s->cols = cols;
+    s->chunk_rows = batch_rows < APPEND_CHUNK_ROWS ? (hsize_t)(batch_rows > 0 ? batch_rows : 1) : APPEND_CHUNK_ROWS;
+    s->batch_rows = (batch_rows + s->chunk_rows - 1) / s->chunk_rows * s->chunk_rows;
+    s->swmr = swmr;
+    s->dataset_id = -1;
+    s->t_start = omp_get_wtime();
+    pthread_mutex_init(&s->lock, NULL);
+    for (int i = 0; i < APPEND_RING_SIZE; i++) {
+        s->slots[i].stream = s;
+        s->slots[i].rows = (double*)pool_alloc(s->batch_rows * cols * sizeof(double));
+        atomic_init(&s->slots[i].copied, 0);
+        atomic_init(&s->slots[i].state, i == 0 ? APPEND_SLOT_FILLING : APPEND_SLOT_FREE);
+        if (!s->slots[i].rows)
+            atomic_store(&s->failed, 1);
+    }
+
+    hid_t fapl = H5P_DEFAULT;
+    if (swmr) {
+        hdf5_direct_begin();
+        fapl = H5Pcreate(H5P_FILE_ACCESS);
+        H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+        hdf5_direct_end();
+    }
+    hdf5_io_req_t req = {0};
+    req.op = IO_FILE_CREATE;
+    req.name = filename;
+    req.plist = fapl;
+    hdf5_io_submit(&req);
+    s->file_id = hdf5_io_wait(&req);
+    if (fapl != H5P_DEFAULT) {
+        hdf5_direct_begin();
+        H5Pclose(fapl);
+        hdf5_direct_end();
+    }
+    if (s->file_id < 0 || atomic_load(&s->failed) ||
+        many_io_callback(append_create_callback, s->file_id, dname, 0, 0, s, NULL) < 0) {
+        printf("Error: Failed to create extendible dataset %s in %s\n", dname, filename);
+        atomic_store(&s->failed, 1);
+        return -1;
+    }
+    progress_printf("  [Append] Stream %s%s: %llu columns, batch %llu rows, chunk %llu rows%s\n",
+                    filename, dname, (unsigned long long)cols, (unsigned long long)s->batch_rows,
+                    (unsigned long long)s->chunk_rows, swmr ? ", SWMR" : "");
+    return 0;
+}
+
+/**
+ * 追加 nrows 行（行主序，每行 cols 个 double），任意线程可并发调用
+ * 同一次调用的行在文件中保持连续顺序（除非跨越刷新批边界），不同调用之间的顺序不确定
+ *
+ * @return 0 成功，-1 之前的刷新失败
+ */
+int append_rows(append_stream_t *s, const double *rows, hsize_t nrows) {
+    while (nrows > 0 && !atomic_load_explicit(&s->failed, memory_order_relaxed)) {
+        pthread_mutex_lock(&s->lock);
+        append_slot_t *slot = &s->slots[s->current];
+        hsize_t offset = slot->reserved;
+        hsize_t take = s->batch_rows - offset < nrows ? s->batch_rows - offset : nrows;
+        slot->reserved += take;
+        if (slot->reserved == s->batch_rows)
+            append_advance(s);
+        pthread_mutex_unlock(&s->lock);
+
+        memcpy(slot->rows + offset * s->cols, rows, take * s->cols * sizeof(double));
+        if (atomic_fetch_add_explicit(&slot->copied, take, memory_order_acq_rel) + take == s->batch_rows)
+            append_submit(slot, s->batch_rows);
+        rows += take * s->cols;
+        nrows -= take;
+    }
+    return atomic_load(&s->failed) ? -1 : 0;
+}
+
+/**
+ * 刷新剩余的不满一批的行，等待全部刷新完成并关闭文件（调用时不能再有并发的 append_rows）
+ *
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int append_close(append_stream_t *s, append_stats_t *stats) {
+    append_slot_t *tail = &s->slots[s->current];
+    if (s->dataset_id >= 0 && tail->reserved > 0 && !atomic_load(&s->failed))
+        append_submit(tail, tail->reserved);
+    else
+        atomic_store(&tail->state, APPEND_SLOT_FREE);
+    for (int i = 0; i < APPEND_RING_SIZE; i++) {
+        append_slot_drain(s, &s->slots[i]);
+        pool_free(s->slots[i].rows, s->batch_rows * s->cols * sizeof(double));
+    }
+    if (s->dataset_id >= 0)
+        hdf5_io_call(IO_DATASET_CLOSE, s->dataset_id, NULL, 0, 0);
+    if (s->file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, s->file_id, NULL, 0, 0);
+    pthread_mutex_destroy(&s->lock);
+
+    append_stats_t st = {s->extent, s->flushes, (int)s->batch_rows, s->flush_time, s->stall_time,
+                         omp_get_wtime() - s->t_start, 0.0};
+    st.rows_per_s = st.total_time > 0 ? st.rows / st.total_time : 0.0;
+    if (stats)
+        *stats = st;
+    return atomic_load(&s->failed) ? -1 : 0;
+}
+
+/**
+ * 并行追加：所有矩阵的行被切成 APPEND_PRODUCER_ROWS 行的小批，由 OpenMP 线程动态领取并并发追加
+ * 文件中的行顺序取决于线程交错，用 verify_append_hdf5 做与顺序无关的校验
+ *
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int parallel_append_hdf5(const char *filename, double **matrices, int n, int num_matrices,
+                         int batch_rows, int swmr, append_stats_t *stats) {
+    append_stream_t stream;
+    int ret = append_open(&stream, filename, APPEND_DATASET, n, batch_rows, swmr);
+    long pieces = (n + APPEND_PRODUCER_ROWS - 1) / APPEND_PRODUCER_ROWS;
+    long total = ret < 0 ? 0 : pieces * num_matrices;
+    int failed = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(|:failed)
+    for (long p = 0; p < total; p++) {
+        int matrix = (int)(p % num_matrices);
+        int row = (int)(p / num_matrices) * APPEND_PRODUCER_ROWS;
+        int rows = row + APPEND_PRODUCER_ROWS <= n ? APPEND_PRODUCER_ROWS : n - row;
+        if (!failed && append_rows(&stream, matrices[matrix] + (size_t)row * n, rows) < 0)
+            failed = 1;
+    }
+    if (append_close(&stream, stats) < 0 || failed)
+        ret = -1;
+    if (ret < 0)
+        printf("Error: Failed to append rows to %s\n", filename);
+    return ret;
+}
+
+/**
+ * 串行追加（用于对比）：主线程按矩阵顺序每 batch_rows 行直接 H5Dset_extent + 写入一次，
+ * 没有合并缓冲区，也不与数据生成重叠
+ */
+int serial_append_hdf5(const char *filename, double **matrices, int n, int num_matrices,
+                       int batch_rows, append_stats_t *stats) {
+    progress_printf("  [Serial] Append %d %dx%d matrices in batches of %d rows...\n",
+                    num_matrices, n, n, batch_rows);
+    double t_start = omp_get_wtime();
+    hsize_t chunk_rows = batch_rows < APPEND_CHUNK_ROWS ? (hsize_t)batch_rows : APPEND_CHUNK_ROWS;
+    hsize_t dims[2] = {0, n}, maxdims[2] = {H5S_UNLIMITED, n}, chunk[2] = {chunk_rows, n};
+    append_stats_t st = {0};
+    int ret = 0;
+    hdf5_direct_begin();
+    hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, file_fapl);
+    if (file_id < 0) {
+        printf("Error: Failed to create HDF5 file\n");
+        hdf5_direct_end();
+        return -1;
+    }
+    hid_t space_id = H5Screate_simple(2, dims, maxdims);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, 2, chunk);
+    hid_t dataset_id = H5Dcreate(file_id, APPEND_DATASET, H5T_IEEE_F64LE, space_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(space_id);
+
+    for (int i = 0; dataset_id >= 0 && ret == 0 && i < num_matrices; i++) {
+        for (int row = 0; ret == 0 && row < n; row += batch_rows) {
+            hsize_t rows = row + batch_rows <= n ? (hsize_t)batch_rows : (hsize_t)(n - row);
+            double t0 = omp_get_wtime();
+            dims[0] = st.rows + rows;
+            if (H5Dset_extent(dataset_id, dims) < 0 ||
+                hdf5_tile_io(dataset_id, 1, st.rows, 0, rows, n, matrices[i] + (size_t)row * n, n) < 0)
+                ret = -1;
+            st.flush_time += omp_get_wtime() - t0;
+            st.rows += rows;
+            st.flushes++;
+        }
+    }
+    if (dataset_id < 0)
+        ret = -1;
+    else
+        H5Dclose(dataset_id);
+    H5Fclose(file_id);
+    hdf5_direct_end();
+
+    st.batch_rows = batch_rows;
+    st.total_time = omp_get_wtime() - t_start;
+    st.rows_per_s = st.total_time > 0 ? st.rows / st.total_time : 0.0;
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Failed to append rows to %s\n", filename);
+    return ret;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * 与行顺序无关的校验：文件中的行与源矩阵的行作为多重集合相等
+ * 分别计算每行的 CRC32C 后排序比较；行数不符或 CRC 不同都计为不匹配
+ *
+ * @param mismatched 输出不匹配的行数，可为 NULL
+ * @return 0 成功（可能有不匹配），-1 读取失败
+ */
+int verify_append_hdf5(const char *filename, double **matrices, int n, int num_matrices, long *mismatched) {
+    size_t total = (size_t)n * num_matrices;
+    uint32_t *expected = (uint32_t*)malloc(total * sizeof(uint32_t));
+    uint32_t *actual = (uint32_t*)malloc(total * sizeof(uint32_t));
+    double *block = (double*)pool_alloc((size_t)n * n * sizeof(double));
+    hid_t file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    hid_t dataset_id = file_id < 0 ? -1 : hdf5_io_call(IO_DATASET_OPEN, file_id, APPEND_DATASET, 0, 0);
+    hsize_t dims[2] = {0, 0};
+    int ret = expected && actual && block && dataset_id >= 0 ? 0 : -1;
+    long bad = 0;
+    if (ret == 0) {
+        // 主线程在没有在途请求时可以直接查询形状
+        hdf5_direct_begin();
+        hid_t space_id = H5Dget_space(dataset_id);
+        H5Sget_simple_extent_dims(space_id, dims, NULL);
+        H5Sclose(space_id);
+        hdf5_direct_end();
+    }
+    int shape_ok = ret == 0 && dims[0] == total && dims[1] == (hsize_t)n;
+    if (ret == 0 && !shape_ok) {
+        printf("Error: %s%s is %llux%llu, expected %zux%d\n", filename, APPEND_DATASET,
+               (unsigned long long)dims[0], (unsigned long long)dims[1], total, n);
+        bad = (long)total;
+    }
+
+    if (shape_ok) {
+        #pragma omp parallel for schedule(static)
+        for (size_t r = 0; r < total; r++)
+            expected[r] = crc32c_update(0, matrices[r / n] + (r % n) * n, n * sizeof(double));
+    }
+    for (size_t row = 0; shape_ok && ret == 0 && row < total; row += n) {
+        hdf5_io_req_t req;
+        hdf5_io_rows(&req, IO_READ, dataset_id, row, n, n, block);
+        hdf5_io_submit(&req);
+        if (hdf5_io_wait(&req) < 0) {
+            ret = -1;
+            break;
+        }
+        #pragma omp parallel for schedule(static)
+        for (int r = 0; r < n; r++)
+            actual[row + r] = crc32c_update(0, block + (size_t)r * n, n * sizeof(double));
+    }
+    if (shape_ok && ret == 0) {
+        qsort(expected, total, sizeof(uint32_t), compare_u32);
+        qsort(actual, total, sizeof(uint32_t), compare_u32);
+        for (size_t r = 0; r < total; r++)
+            bad += expected[r] != actual[r];
+    }
+
+    if (dataset_id >= 0)
+        hdf5_io_call(IO_DATASET_CLOSE, dataset_id, NULL, 0, 0);
+    if (file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    pool_free(block, (size_t)n * n * sizeof(double));
+    free(expected);
+    free(actual);
+    if (mismatched)
+        *mismatched = bad;
+    return ret;
+}
+
+/**
+ * SWMR 追踪读取方（在独立进程中运行，见 --tail）：以 H5F_ACC_SWMR_READ 打开正在写入的文件，
+ * 反复 H5Drefresh 观察行数增长，直到达到 expected_rows 或行数 APPEND_TAIL_IDLE 秒不再变化
+ *
+ * @param expected_rows 期望的最终行数，0 表示只等到不再增长
+ * @return 0 行数单调增长且达到期望值，-1 失败
+ */
+int append_tail_hdf5(const char *filename, long expected_rows) {
+    hid_t file_id = -1, dataset_id = -1;
+    double t_start = omp_get_wtime(), t_change = t_start;
+    // 写入方可能还没有开始 SWMR 写入，打开失败时重试
+    while (dataset_id < 0 && omp_get_wtime() - t_start < APPEND_TAIL_IDLE) {
+        H5E_BEGIN_TRY {
+            file_id = H5Fopen(filename, H5F_ACC_RDONLY | H5F_ACC_SWMR_READ, H5P_DEFAULT);
+            dataset_id = file_id < 0 ? -1 : H5Dopen(file_id, APPEND_DATASET, H5P_DEFAULT);
+        } H5E_END_TRY;
+        if (dataset_id < 0) {
+            if (file_id >= 0)
+                H5Fclose(file_id);
+            file_id = -1;
+            usleep(1000);
+        }
+    }
+    if (dataset_id < 0) {
+        printf("Error: Failed to open %s for SWMR read\n", filename);
+        return -1;
+    }
+
+    hsize_t dims[2] = {0, 0}, last = 0;
+    long refreshes = 0, growths = 0;
+    int monotonic = 1;
+    while ((expected_rows <= 0 || last < (hsize_t)expected_rows) &&
+           omp_get_wtime() - t_change < APPEND_TAIL_IDLE) {
+        if (H5Drefresh(dataset_id) < 0)
+            break;
+        hid_t space_id = H5Dget_space(dataset_id);
+        H5Sget_simple_extent_dims(space_id, dims, NULL);
+        H5Sclose(space_id);
+        refreshes++;
+        if (dims[0] < last)
+            monotonic = 0;
+        if (dims[0] != last) {
+            growths++;
+            last = dims[0];
+            t_change = omp_get_wtime();
+        } else {
+            usleep(200);
+        }
+    }
+    H5Dclose(dataset_id);
+    H5Fclose(file_id);
+    printf("  [Tail] %s%s: %ld refreshes, observed %ld extents, final %llu rows\n", filename, APPEND_DATASET,
+           refreshes, growths, (unsigned long long)last);
+    return monotonic && (expected_rows <= 0 || last == (hsize_t)expected_rows) ? 0 : -1;
+}
+
+/**
+ * 打印追加统计
+ */
+void print_append_stats(const char *label, const append_stats_t *st) {
+    printf("%-24s 批 %5d 行: %8.4f 秒, %10.0f 行/秒, 刷新 %4ld 次 (I/O %.4f 秒), 等待槽位 %.4f 秒\n",
+           label, st->batch_rows, st->total_time, st->rows_per_s, st->flushes, st->flush_time, st->stall_time);
+}
+
+// ===================== 分片写入与虚拟数据集 =====================
+// 即使是线程安全版本，libhdf5 内部也只有一把全局锁，同一进程内的所有 HDF5 调用都是串行的。
+// 分片模式把每个矩阵按行切成 shards 段，第 s 段写入自己的分片文件 <名称>_shard<s>.h5 中的 /matrix_i：
+//   - SHARD_THREADS：各线程通过本进程的 I/O 线程写自己的分片文件（仍受全局锁限制，但各文件元数据互不干扰）；
+//   - SHARD_PROCESSES：每个分片 fork 一个写进程，子进程启动自己的 I/O 线程独立写入，真正并行。
+// 主文件中的 /matrix_i 是虚拟数据集 (H5Pset_virtual)，每个分片一个映射，读取方（如 serial_read_hdf5）无需修改；
+// 子进程写入的同时父进程创建主文件并计算校验和，校验和属性写在虚拟数据集上。
+
+#define SHARD_MAX 64
+
+typedef enum {
+    SHARD_THREADS,
+    SHARD_PROCESSES
+} shard_mode_t;
+
+static const char *const shard_mode_names[] = {"threads", "processes"};
+
+// 分片写入统计
+typedef struct {
+    int shards;
+    shard_mode_t mode;
+    double shard_time;          // 从开始写分片到所有分片完成
+    double master_time;         // 创建主文件虚拟数据集与校验和属性
+    double total_time;
+    double bytes;
+} shard_stats_t;
+
+// 分片文件名：去掉 .h5 后缀后追加 _shard<s>.h5；VDS 源文件名中 % 有特殊含义，因此不允许出现
+static int shard_filename(char *buf, size_t size, const char *master, int shard) {
+    size_t len = strlen(master);
+    if (len > 3 && strcmp(master + len - 3, ".h5") == 0)
+        len -= 3;
+    snprintf(buf, size, "%.*s_shard%d.h5", (int)len, master, shard);
+    return strchr(buf, '%') ? -1 : 0;
+}
+
+// 分片 s 负责的行范围 [first, first + rows)
+static void shard_rows(int n, int shards, int shard, int *first, int *rows) {
+    *first = (int)((long)n * shard / shards);
+    *rows = (int)((long)n * (shard + 1) / shards) - *first;
+}
+
+/**
+ * 写一个分片文件：每个矩阵的 [first, first + rows) 行写到该文件的 /matrix_i（rows x n），
+ * 按 block_rows 行一块提交给 I/O 线程，全部提交后再等待
+ *
+ * @return 0 成功，-1 失败
+ */
+static int shard_write_file(const char *filename, double **matrices, int n, int num_matrices,
+                            int first, int rows, int block_rows) {
+    hid_t file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0);
+    if (file_id < 0)
+        return -1;
+    int blocks = rows > 0 ? (rows + block_rows - 1) / block_rows : 0;
+    hdf5_io_req_t *reqs = (hdf5_io_req_t*)calloc((size_t)blocks * num_matrices + 1, sizeof(hdf5_io_req_t));
+    hid_t dataset_ids[num_matrices];
+    int ret = reqs ? 0 : -1;
+    for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        dataset_ids[i] = hdf5_io_call(IO_DATASET_CREATE, file_id, dataset_name, rows, n);
+        for (int b = 0; ret == 0 && dataset_ids[i] >= 0 && b < blocks; b++) {
+            int row = b * block_rows;
+            int count = rows - row < block_rows ? rows - row : block_rows;
+            hdf5_io_rows(&reqs[(size_t)i * blocks + b], IO_WRITE, dataset_ids[i], row, count, n,
+                         matrices[i] + (size_t)(first + row) * n);
+            hdf5_io_submit(&reqs[(size_t)i * blocks + b]);
+        }
+        if (dataset_ids[i] < 0)
+            ret = -1;
+    }
+    for (int i = 0; i < num_matrices; i++) {
+        if (dataset_ids[i] < 0)
+            continue;
+        for (int b = 0; reqs && b < blocks; b++)
+            if (hdf5_io_wait(&reqs[(size_t)i * blocks + b]) < 0)
+                ret = -1;
+        hdf5_io_call(IO_DATASET_CLOSE, dataset_ids[i], NULL, 0, 0);
+    }
+    if (hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0) < 0)
+        ret = -1;
+    free(reqs);
+    return ret;
+}
+
+// 主文件中创建虚拟数据集的参数
+typedef struct {
+    const char *master;
+    int n, shards;
+    hid_t dataset_id;               // 输出
+} shard_vds_t;
+
+// 在 I/O 线程上创建 req->obj 文件中的虚拟数据集 req->name，每个分片一个映射
+static void shard_vds_callback(hdf5_io_req_t *req) {
+    shard_vds_t *v = (shard_vds_t*)req->arg;
+    hsize_t dims[2] = {v->n, v->n};
+    hid_t vspace = H5Screate_simple(2, dims, NULL);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    for (int s = 0; s < v->shards && req->result == 0; s++) {
+        char shard_name[256];
+        int first, rows;
+        shard_rows(v->n, v->shards, s, &first, &rows);
+        if (rows == 0)
+            continue;
+        // 源文件按主文件所在目录解析，只记录不含目录的文件名
+        shard_filename(shard_name, sizeof(shard_name), v->master, s);
+        const char *base = strrchr(shard_name, '/');
+        hsize_t src_dims[2] = {rows, v->n};
+        hsize_t start[2] = {first, 0};
+        hid_t src_space = H5Screate_simple(2, src_dims, NULL);
+        if (H5Sselect_hyperslab(vspace, H5S_SELECT_SET, start, NULL, src_dims, NULL) < 0 ||
+            H5Pset_virtual(dcpl, vspace, base ? base + 1 : shard_name, req->name, src_space) < 0)
+            req->result = -1;
+        H5Sclose(src_space);
+    }
+    H5Sselect_all(vspace);
+    v->dataset_id = req->result < 0 ? -1 :
+                    H5Dcreate(req->obj, req->name, H5T_IEEE_F64LE, vspace, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    if (v->dataset_id < 0)
+        req->result = -1;
+    H5Pclose(dcpl);
+    H5Sclose(vspace);
+}
+
+/**
+ * 分片并行写入：矩阵按行切成 shards 段分别写入分片文件，主文件 filename 用虚拟数据集拼接
+ * 主文件中每个 /matrix_i 的内容、形状与 parallel_write_hdf5 相同，并带有 "checksum" 属性
+ *
+ * @param shards 分片数，<= 0 时使用 OpenMP 线程数
+ * @param block_rows 分片内每个写请求的行数
+ * @param mode SHARD_THREADS 或 SHARD_PROCESSES
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int sharded_write_hdf5(const char *filename, double **matrices, int n, int num_matrices, int shards,
+                       int block_rows, shard_mode_t mode, shard_stats_t *stats) {
+    shard_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    if (shards <= 0)
+        shards = omp_get_max_threads();
+    shards = shards > SHARD_MAX ? SHARD_MAX : shards > n ? n : shards;
+    if (block_rows <= 0)
+        block_rows = n;
+    progress_printf("  [Shard] Write %d %dx%d matrices to %d shard files (%s)...\n",
+                    num_matrices, n, n, shards, shard_mode_names[mode]);
+    char names[SHARD_MAX][256];
+    for (int s = 0; s < shards; s++) {
+        if (shard_filename(names[s], sizeof(names[s]), filename, s) < 0) {
+            printf("Error: Shard file name of %s must not contain '%%'\n", filename);
+            return -1;
+        }
+    }
+
+    int failed = 0;
+    pid_t pids[SHARD_MAX];
+    if (mode == SHARD_PROCESSES) {
+        // fork 时本进程不能有在途的 HDF5 请求：I/O 线程此刻空闲，子进程继承的库状态是一致的
+        fflush(stdout);
+        for (int s = 0; s < shards; s++) {
+            int first, rows;
+            shard_rows(n, shards, s, &first, &rows);
+            pids[s] = fork();
+            if (pids[s] == 0) {
+                // 子进程只有 fork 它的线程：重新启动自己的 I/O 线程，结束时 _exit 跳过父进程注册的清理
+                trace_enabled = 0;
+                io_service.running = 0;
+                int ret = hdf5_io_start() < 0 ? -1 :
+                          shard_write_file(names[s], matrices, n, num_matrices, first, rows, block_rows);
+                hdf5_io_stop();
+                _exit(ret < 0 ? 1 : 0);
+            }
+            if (pids[s] < 0) {
+                printf("Error: Failed to fork shard writer %d\n", s);
+                failed++;
+            }
+        }
+    } else {
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:failed)
+        for (int s = 0; s < shards; s++) {
+            int first, rows;
+            shard_rows(n, shards, s, &first, &rows);
+            if (shard_write_file(names[s], matrices, n, num_matrices, first, rows, block_rows) < 0)
+                failed++;
+        }
+    }
+
+    // 分片写入（子进程）的同时创建主文件并计算校验和
+    double t_master = omp_get_wtime();
+    hid_t file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0);
+    shard_vds_t vds[num_matrices];
+    matrix_checksum_t sums[num_matrices];
+    if (file_id < 0) {
+        printf("Error: Failed to create HDF5 file\n");
+        failed++;
+    }
+    for (int i = 0; file_id >= 0 && i < num_matrices; i++) {
+        char dataset_name[50];
+        sprintf(dataset_name, "/matrix_%d", i);
+        vds[i] = (shard_vds_t){filename, n, shards, -1};
+        if (many_io_callback(shard_vds_callback, file_id, dataset_name, 0, 0, &vds[i], NULL) < 0) {
+            printf("Error: Failed to create virtual dataset %s\n", dataset_name);
+            failed++;
+        }
+        if (checksum_matrix(matrices[i], n, n, &sums[i]) < 0)
+            sums[i].count = 0;
+    }
+    for (int i = 0; file_id >= 0 && i < num_matrices; i++) {
+        if (vds[i].dataset_id < 0)
+            continue;
+        if (sums[i].count && hdf5_io_checksum(vds[i].dataset_id, &sums[i], 1) < 0)
+            failed++;
+        hdf5_io_call(IO_DATASET_CLOSE, vds[i].dataset_id, NULL, 0, 0);
+    }
+    if (file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    st.master_time = omp_get_wtime() - t_master;
+
+    if (mode == SHARD_PROCESSES) {
+        for (int s = 0; s < shards; s++) {
+            int status;
+            if (pids[s] > 0 && (waitpid(pids[s], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))) {
+                printf("Error: Shard writer %d failed\n", s);
+                failed++;
+            }
+        }
+    }
+    st.shard_time = omp_get_wtime() - t_start - (mode == SHARD_THREADS ? st.master_time : 0.0);
+    st.shards = shards;
+    st.mode = mode;
+    st.total_time = omp_get_wtime() - t_start;
+    st.bytes = (double)n * n * num_matrices * sizeof(double);
+    if (stats)
+        *stats = st;
+    if (failed)
+        printf("Error: Sharded write to %s failed (%d errors)\n", filename, failed);
+    return failed ? -1 : 0;
+}
+
+/**
+ * 打印分片写入统计
+ */
+void print_shard_stats(const char *label, const shard_stats_t *st) {
+    printf("%s: %d 个分片 (%s), 总计 %.4f 秒 (%.2f MB/s), 分片 %.4f 秒, 主文件 %.4f 秒\n", label,
+           st->shards, shard_mode_names[st->mode], st->total_time,
+           st->bytes / (1024 * 1024) / st->total_time, st->shard_time, st->master_time);
+}
+
+// ===================== 惰性表达式：逐块融合求值 =====================
+// 对 /matrix_i 做 alpha*A + B.*C、列归一化这类逐元素运算时，逐个算子求值要为每个中间结果物化一个
+// 与数据集同样大小的数组，并为每个算子完整扫一遍内存。这里先用 expr_* 构建惰性的表达式 DAG（只记录节点），
+// 求值时按行块以 hyperslab 从文件流式读入输入（经 I/O 线程与计算重叠），每个行块再切成 EXPR_TILE 个元素的瓦片，
+// 在瓦片上按拓扑序执行全部算子：中间结果只存在于每线程几个常驻缓存的瓦片槽位中，只有最终结果写回文件。
+// 列归约（EXPR_COL_SUM / EXPR_COL_MAX）得到 1 x n 行向量，在之后的遍中按列广播；
+// 每多一层归约嵌套就多扫描一遍输入（如列归一化 A ./ sqrt(col_sum(A .* A)) 需要两遍）。
+
+#define EXPR_MAX_NODES 32
+#define EXPR_MAX_INPUTS 8
+#define EXPR_TILE 1024              // 融合求值的瓦片元素数（每个中间结果槽位 8 KB）
+#define EXPR_BLOCK_MB 1             // block_rows <= 0 时每个输入行块的目标大小 (MB)
+
+typedef enum {
+    EXPR_INPUT,                                         // 数据集输入
+    EXPR_SCALAR,                                        // 常量
+    EXPR_ADD, EXPR_SUB, EXPR_MUL, EXPR_DIV, EXPR_MAX,   // 逐元素二元运算
+    EXPR_NEG, EXPR_ABS, EXPR_SQRT,                      // 逐元素一元运算
+    EXPR_COL_SUM, EXPR_COL_MAX,                         // 按列归约 -> 1 x n
+    EXPR_OP_COUNT
+} expr_op_t;
+
+static const char *const expr_op_names[EXPR_OP_COUNT] = {
+    "input", "scalar", "+", "-", ".*", "./", "max", "-", "abs", "sqrt", "col_sum", "col_max"
+};
+
+// 节点取值的形状：常量 < 行向量 (1 x n) < 完整矩阵 (m x n)
+typedef enum { EXPR_KIND_SCALAR, EXPR_KIND_ROW, EXPR_KIND_FULL } expr_kind_t;
+
+typedef struct {
+    expr_op_t op;
+    expr_kind_t kind;
+    int a, b;                   // 子节点下标，-1 表示无
+    int input;                  // EXPR_INPUT：输入序号
+    double value;               // EXPR_SCALAR：常量值
+    int level;                  // 从第 level 遍（从 0 起）开始可用；行向量在第 level - 1 遍结束后求出
+} expr_node_t;
+
+// 表达式 DAG：节点按创建顺序存放，子节点下标总小于父节点（即拓扑序）
+typedef struct {
+    expr_node_t nodes[EXPR_MAX_NODES];
+    int count;
+    const char *inputs[EXPR_MAX_INPUTS];    // 输入数据集名（与结果在同一文件中）
+    int num_inputs;
+    int error;                              // 构建时出错：节点/输入过多、子节点非法或不支持的组合
+} expr_t;
+
+// 表达式求值统计
+typedef struct {
+    int passes;                 // 融合：输入扫描遍数；逐算子：完整大小数组上的算子遍数
+    int block_rows;             // 融合求值的 I/O 行块大小
+    double elements;            // 结果元素个数
+    double bytes_read;          // 从文件读取的字节数
+    double bytes_written;       // 写入文件的字节数
+    double bytes_moved;         // 完整大小数组的搬运量：文件读写 + 物化中间结果的读写（不计 1 x n 向量）
+    double peak_buffer_mb;      // 同时存在的数据缓冲区峰值 (MB)
+    double io_wait_time;        // 计算线程等待 I/O 线程的时间
+    double compute_time;
+    double total_time;
+} expr_stats_t;
+
+// 逐元素算子的操作数：p 非 NULL 时为长度 len 的数组，否则为广播的常量 s
+typedef struct {
+    const double *p;
+    double s;
+} expr_arg_t;
+
+#define EXPR_BINARY_LOOP(F) do {                                                        \
+        if (x.p && y.p) {                                                               \
+            _Pragma("omp simd")                                                         \
+            for (int i = 0; i < len; i++) { double u = x.p[i], v = y.p[i]; dst[i] = (F); } \
+        } else if (x.p) {                                                               \
+            double v = y.s;                                                             \
+            _Pragma("omp simd")                                                         \
+            for (int i = 0; i < len; i++) { double u = x.p[i]; dst[i] = (F); }          \
+        } else {                                                                        \
+            double u = x.s;                                                             \
+            _Pragma("omp simd")                                                         \
+            for (int i = 0; i < len; i++) { double v = y.p[i]; dst[i] = (F); }          \
+        }                                                                               \
+    } while (0)
+
+#define EXPR_UNARY_LOOP(F) do {                                                         \
+        _Pragma("omp simd")                                                             \
+        for (int i = 0; i < len; i++) { double u = x.p[i]; dst[i] = (F); }              \
+    } while (0)
+
+// 逐元素算子内核；二元算子至少一个操作数是数组，一元算子的操作数总是数组
+static void expr_kernel(expr_op_t op, double *restrict dst, expr_arg_t x, expr_arg_t y, int len) {
+    switch (op) {
+    case EXPR_ADD:  EXPR_BINARY_LOOP(u + v); break;
+    case EXPR_SUB:  EXPR_BINARY_LOOP(u - v); break;
+    case EXPR_MUL:  EXPR_BINARY_LOOP(u * v); break;
+    case EXPR_DIV:  EXPR_BINARY_LOOP(u / v); break;
+    case EXPR_MAX:  EXPR_BINARY_LOOP(u > v ? u : v); break;
+    case EXPR_NEG:  EXPR_UNARY_LOOP(-u); break;
+    case EXPR_ABS:  EXPR_UNARY_LOOP(fabs(u)); break;
+    case EXPR_SQRT: EXPR_UNARY_LOOP(sqrt(u)); break;
+    default: break;
+    }
+}
+
+// 列归约累加：acc[i] 与 x[i] 合并
+static void expr_reduce(expr_op_t op, double *restrict acc, const double *restrict x, int len) {
+    if (op == EXPR_COL_SUM) {
+        #pragma omp simd
+        for (int i = 0; i < len; i++)
+            acc[i] += x[i];
+    } else {
+        #pragma omp simd
+        for (int i = 0; i < len; i++)
+            acc[i] = x[i] > acc[i] ? x[i] : acc[i];
+    }
+}
+
+static double expr_reduce_identity(expr_op_t op) {
+    return op == EXPR_COL_SUM ? 0.0 : -INFINITY;
+}
+
+/**
+ * 初始化空表达式
+ */
+void expr_init(expr_t *e) {
+    memset(e, 0, sizeof(*e));
+}
+
+static int expr_push(expr_t *e, expr_node_t node) {
+    if (e->count >= EXPR_MAX_NODES) {
+        e->error = 1;
+        return -1;
+    }
+    e->nodes[e->count] = node;
+    return e->count++;
+}
+
+/**
+ * 数据集输入节点；同名数据集只读一次
+ *
+ * @param dataset_name 数据集名（字符串需在求值结束前保持有效）
+ * @return 节点下标，-1 表示失败
+ */
+int expr_input(expr_t *e, const char *dataset_name) {
+    int k = 0;
+    while (k < e->num_inputs && strcmp(e->inputs[k], dataset_name) != 0)
+        k++;
+    for (int i = 0; i < e->count; i++)
+        if (e->nodes[i].op == EXPR_INPUT && e->nodes[i].input == k)
+            return i;
+    if (k >= EXPR_MAX_INPUTS) {
+        e->error = 1;
+        return -1;
+    }
+    e->inputs[e->num_inputs++] = dataset_name;
+    return expr_push(e, (expr_node_t){EXPR_INPUT, EXPR_KIND_FULL, -1, -1, k, 0.0, 0});
+}
+
+/**
+ * 常量节点
+ */
+int expr_scalar(expr_t *e, double value) {
+    return expr_push(e, (expr_node_t){EXPR_SCALAR, EXPR_KIND_SCALAR, -1, -1, -1, value, 0});
+}
+
+/**
+ * 逐元素二元运算节点 (EXPR_ADD .. EXPR_MAX)，常量与行向量按元素广播；两个常量直接折叠
+ *
+ * @return 节点下标，-1 表示失败（子节点为 -1 时同样返回 -1，错误沿构建过程传递）
+ */
+int expr_binary(expr_t *e, expr_op_t op, int a, int b) {
+    if (op < EXPR_ADD || op > EXPR_MAX || a < 0 || b < 0 || a >= e->count || b >= e->count) {
+        e->error = 1;
+        return -1;
+    }
+    const expr_node_t *x = &e->nodes[a], *y = &e->nodes[b];
+    if (x->kind == EXPR_KIND_SCALAR && y->kind == EXPR_KIND_SCALAR) {
+        double r;
+        expr_kernel(op, &r, (expr_arg_t){&x->value, 0.0}, (expr_arg_t){NULL, y->value}, 1);
+        return expr_scalar(e, r);
+    }
+    expr_kind_t kind = x->kind > y->kind ? x->kind : y->kind;
+    int level = x->level > y->level ? x->level : y->level;
+    return expr_push(e, (expr_node_t){op, kind, a, b, -1, 0.0, level});
+}
+
+/**
+ * 逐元素一元运算 (EXPR_NEG .. EXPR_SQRT) 或按列归约 (EXPR_COL_SUM / EXPR_COL_MAX) 节点
+ * 对完整矩阵归约需要先扫描一遍，结果在下一遍才可用；不支持对常量归约（结果依赖行数）
+ *
+ * @return 节点下标，-1 表示失败
+ */
+int expr_unary(expr_t *e, expr_op_t op, int a) {
+    if (op < EXPR_NEG || op > EXPR_COL_MAX || a < 0 || a >= e->count) {
+        e->error = 1;
+        return -1;
+    }
+    const expr_node_t *x = &e->nodes[a];
+    int reduce = op >= EXPR_COL_SUM;
+    if (x->kind == EXPR_KIND_SCALAR) {
+        if (reduce) {
+            e->error = 1;
+            return -1;
+        }
+        double r;
+        expr_kernel(op, &r, (expr_arg_t){&x->value, 0.0}, (expr_arg_t){NULL, 0.0}, 1);
+        return expr_scalar(e, r);
+    }
+    expr_node_t node = {op, x->kind, a, -1, -1, 0.0, x->level};
+    if (reduce) {
+        node.kind = EXPR_KIND_ROW;
+        if (x->kind == EXPR_KIND_FULL)
+            node.level++;
+    }
+    return expr_push(e, node);
+}
+
+static void expr_append(char *buf, size_t size, const char *s) {
+    size_t len = strlen(buf);
+    if (len + 1 < size)
+        snprintf(buf + len, size - len, "%s", s);
+}
+
+/**
+ * 把以 node 为根的表达式格式化为中缀形式（追加到 buf）
+ */
+void expr_format(const expr_t *e, int node, char *buf, size_t size) {
+    const expr_node_t *x = &e->nodes[node];
+    char tmp[32];
+    switch (x->op) {
+    case EXPR_INPUT:
+        expr_append(buf, size, e->inputs[x->input]);
+        return;
+    case EXPR_SCALAR:
+        snprintf(tmp, sizeof(tmp), "%g", x->value);
+        expr_append(buf, size, tmp);
+        return;
+    case EXPR_NEG:
+        expr_append(buf, size, "-");
+        expr_format(e, x->a, buf, size);
+        return;
+    default:
+        break;
+    }
+    if (x->b >= 0 && x->op != EXPR_MAX) {
+        expr_append(buf, size, "(");
+        expr_format(e, x->a, buf, size);
+        snprintf(tmp, sizeof(tmp), " %s ", expr_op_names[x->op]);
+        expr_append(buf, size, tmp);
+        expr_format(e, x->b, buf, size);
+    } else {
+        expr_append(buf, size, expr_op_names[x->op]);
+        expr_append(buf, size, "(");
+        expr_format(e, x->a, buf, size);
+        if (x->b >= 0) {
+            expr_append(buf, size, ", ");
+            expr_format(e, x->b, buf, size);
+        }
+    }
+    expr_append(buf, size, ")");
+}
+
+// 标记从 root 可达的节点
+static void expr_reachable(const expr_t *e, int root, int *reach) {
+    memset(reach, 0, EXPR_MAX_NODES * sizeof(int));
+    reach[root] = 1;
+    for (int k = root; k >= 0; k--) {
+        if (!reach[k])
+            continue;
+        if (e->nodes[k].a >= 0) reach[e->nodes[k].a] = 1;
+        if (e->nodes[k].b >= 0) reach[e->nodes[k].b] = 1;
+    }
+}
+
+static int expr_is_full_reduce(const expr_t *e, int k) {
+    const expr_node_t *x = &e->nodes[k];
+    return (x->op == EXPR_COL_SUM || x->op == EXPR_COL_MAX) && e->nodes[x->a].kind == EXPR_KIND_FULL;
+}
+
+// 行向量 / 常量操作数（求值完整矩阵节点时只取 [c0, c0 + len) 列）
+static expr_arg_t expr_row_arg(const expr_t *e, int k, double *const *vec, int c0) {
+    expr_arg_t arg = {NULL, e->nodes[k].value};
+    if (e->nodes[k].kind == EXPR_KIND_ROW)
+        arg.p = vec[k] + c0;
+    return arg;
+}
+
+// 求出行向量节点 k（子节点都已求出）：逐元素运算直接在 1 x n 上计算；
+// 对行向量的列归约等价于对 m 个相同行归约
+static void expr_eval_row(const expr_t *e, int k, double *const *vec, int m, int n) {
+    const expr_node_t *x = &e->nodes[k];
+    if (x->op == EXPR_COL_SUM) {
+        for (int j = 0; j < n; j++)
+            vec[k][j] = (double)m * vec[x->a][j];
+    } else if (x->op == EXPR_COL_MAX) {
+        memcpy(vec[k], vec[x->a], (size_t)n * sizeof(double));
+    } else {
+        expr_arg_t y = x->b >= 0 ? expr_row_arg(e, x->b, vec, 0) : (expr_arg_t){NULL, 0.0};
+        expr_kernel(x->op, vec[k], expr_row_arg(e, x->a, vec, 0), y, n);
+    }
+}
+
+// 一遍扫描的求值计划
+typedef struct {
+    int nodes[EXPR_MAX_NODES], count;           // 在瓦片上求值的完整矩阵节点（拓扑序，不含输入）
+    int slot[EXPR_MAX_NODES];                   // 节点 -> 瓦片槽位
+    int slots;
+    int reduce[EXPR_MAX_NODES], num_reduce;     // 本遍累加的列归约节点
+    int uses_input[EXPR_MAX_INPUTS];
+    int output;                                 // 直接写入输出行块的节点，-1 表示本遍不输出
+} expr_pass_t;
+
+// 生成第 pass 遍的计划：需要的节点是本遍归约的子表达式与（最后一遍的）根节点，
+// 槽位按最后一次使用贪心复用，父节点先分配再释放子节点，保证输出不与操作数重叠
+static void expr_plan_pass(const expr_t *e, const int *reach, int root, int pass, int final,
+                           expr_pass_t *p) {
+    int needed[EXPR_MAX_NODES] = {0}, last_use[EXPR_MAX_NODES], free_slots[EXPR_MAX_NODES], nfree = 0;
+    memset(p, 0, sizeof(*p));
+    p->output = -1;
+    for (int k = 0; k < e->count; k++) {
+        last_use[k] = -1;
+        if (reach[k] && expr_is_full_reduce(e, k) && e->nodes[k].level == pass + 1) {
+            p->reduce[p->num_reduce++] = k;
+            needed[e->nodes[k].a] = 1;
+            last_use[e->nodes[k].a] = INT_MAX;
+        }
+    }
+    if (final && e->nodes[root].kind == EXPR_KIND_FULL) {
+        p->output = root;
+        needed[root] = 1;
+    }
+    for (int k = e->count - 1; k >= 0; k--) {
+        const expr_node_t *x = &e->nodes[k];
+        if (!needed[k] || x->kind != EXPR_KIND_FULL)
+            continue;
+        if (x->op == EXPR_INPUT) {
+            p->uses_input[x->input] = 1;
+            continue;
+        }
+        if (x->a >= 0 && e->nodes[x->a].kind == EXPR_KIND_FULL) needed[x->a] = 1;
+        if (x->b >= 0 && e->nodes[x->b].kind == EXPR_KIND_FULL) needed[x->b] = 1;
+    }
+    for (int k = 0; k < e->count; k++) {
+        const expr_node_t *x = &e->nodes[k];
+        if (!needed[k] || x->kind != EXPR_KIND_FULL || x->op == EXPR_INPUT)
+            continue;
+        p->nodes[p->count++] = k;
+        if (x->a >= 0 && last_use[x->a] < k) last_use[x->a] = k;
+        if (x->b >= 0 && last_use[x->b] < k) last_use[x->b] = k;
+    }
+    for (int i = 0; i < p->count; i++) {
+        int k = p->nodes[i];
+        const expr_node_t *x = &e->nodes[k];
+        if (k != p->output)
+            p->slot[k] = nfree > 0 ? free_slots[--nfree] : p->slots++;
+        for (int c = 0; c < 2; c++) {
+            int child = c ? x->b : x->a;
+            if (child < 0 || (c && child == x->a) || last_use[child] != k || child == p->output ||
+                e->nodes[child].kind != EXPR_KIND_FULL || e->nodes[child].op == EXPR_INPUT)
+                continue;
+            free_slots[nfree++] = p->slot[child];
+        }
+    }
+}
+
+// 瓦片上的操作数：输入取行块缓冲区，中间结果取槽位，行向量 / 常量广播
+static expr_arg_t expr_tile_arg(const expr_t *e, const expr_pass_t *p, int k, double *const *in,
+                                double *const *vec, double *scratch, size_t offset, int c0) {
+    const expr_node_t *x = &e->nodes[k];
+    if (x->op == EXPR_INPUT)
+        return (expr_arg_t){in[x->input] + offset, 0.0};
+    if (x->kind == EXPR_KIND_FULL)
+        return (expr_arg_t){scratch + (size_t)p->slot[k] * EXPR_TILE, 0.0};
+    return expr_row_arg(e, k, vec, c0);
+}
+
+// 在一个瓦片（行块内 offset 处的 len 个元素，从第 c0 列开始）上执行本遍的全部算子与归约累加
+static void expr_eval_tile(const expr_t *e, const expr_pass_t *p, double *const *in, double *const *vec,
+                           double *scratch, double *out, double *partial, size_t offset, int c0, int len, int n) {
+    for (int i = 0; i < p->count; i++) {
+        int k = p->nodes[i];
+        const expr_node_t *x = &e->nodes[k];
+        double *dst = k == p->output ? out + offset : scratch + (size_t)p->slot[k] * EXPR_TILE;
+        expr_arg_t y = x->b >= 0 ? expr_tile_arg(e, p, x->b, in, vec, scratch, offset, c0)
+                                 : (expr_arg_t){NULL, 0.0};
+        expr_kernel(x->op, dst, expr_tile_arg(e, p, x->a, in, vec, scratch, offset, c0), y, len);
+    }
+    for (int r = 0; r < p->num_reduce; r++) {
+        const expr_node_t *x = &e->nodes[p->reduce[r]];
+        expr_reduce(x->op, partial + (size_t)r * n + c0,
+                    expr_tile_arg(e, p, x->a, in, vec, scratch, offset, c0).p, len);
+    }
+}
+
+// 在 I/O 线程上打开输入数据集：obj = file_id, name -> result = dataset_id, rows x cols = 维度
+static void expr_open_callback(hdf5_io_req_t *req) {
+    hsize_t dims[2] = {0, 0};
+    req->result = H5Dopen(req->obj, req->name, H5P_DEFAULT);
+    if (req->result < 0)
+        return;
+    hid_t space_id = H5Dget_space(req->result);
+    if (space_id < 0 || H5Sget_simple_extent_ndims(space_id) != 2 ||
+        H5Sget_simple_extent_dims(space_id, dims, NULL) < 0) {
+        H5Dclose(req->result);
+        req->result = -1;
+    }
+    if (space_id >= 0)
+        H5Sclose(space_id);
+    req->rows = dims[0];
+    req->cols = dims[1];
+}
+
+// 在 I/O 线程上准备结果数据集：已存在且形状相同则直接覆盖写（避免重复运行时文件增长），否则删除后重建
+static void expr_create_callback(hdf5_io_req_t *req) {
+    if (H5Lexists(req->obj, req->name, H5P_DEFAULT) > 0) {
+        hsize_t rows = req->rows, cols = req->cols;
+        expr_open_callback(req);
+        if (req->result >= 0 && req->rows == rows && req->cols == cols)
+            return;
+        if (req->result >= 0)
+            H5Dclose(req->result);
+        req->rows = rows;
+        req->cols = cols;
+        H5Ldelete(req->obj, req->name, H5P_DEFAULT);
+    }
+    hsize_t dims[2] = {req->rows, req->cols};
+    hid_t space_id = H5Screate_simple(2, dims, NULL);
+    req->result = H5Dcreate(req->obj, req->name, H5T_IEEE_F64LE, space_id,
+                            H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Sclose(space_id);
+}
+
+// 融合 / 逐算子求值共用的文件与数据集句柄
+typedef struct {
+    hid_t file_id, result_id;
+    hid_t input_ids[EXPR_MAX_INPUTS];
+    int m, n;
+} expr_files_t;
+
+static void expr_close_files(expr_files_t *f, const expr_t *e) {
+    for (int k = 0; k < e->num_inputs; k++)
+        if (f->input_ids[k] >= 0)
+            hdf5_io_call(IO_DATASET_CLOSE, f->input_ids[k], NULL, 0, 0);
+    if (f->result_id >= 0)
+        hdf5_io_call(IO_DATASET_CLOSE, f->result_id, NULL, 0, 0);
+    if (f->file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, f->file_id, NULL, 0, 0);
+}
+
+// 以读写方式打开文件与全部输入（维度必须一致），并准备结果数据集
+static int expr_open_files(const char *filename, const expr_t *e, int root, const char *result_name,
+                           expr_files_t *f) {
+    hdf5_io_req_t req = {0};
+    f->result_id = -1;
+    f->m = f->n = 0;
+    for (int k = 0; k < EXPR_MAX_INPUTS; k++)
+        f->input_ids[k] = -1;
+    if (e->error || root < 0 || root >= e->count || e->nodes[root].kind == EXPR_KIND_SCALAR ||
+        e->nodes[root].op == EXPR_INPUT) {
+        printf("Error: Invalid expression for %s\n", result_name);
+        f->file_id = -1;
+        return -1;
+    }
+    req.op = IO_FILE_OPEN;
+    req.name = filename;
+    req.flags = H5F_ACC_RDWR;
+    hdf5_io_submit(&req);
+    f->file_id = hdf5_io_wait(&req);
+    if (f->file_id < 0) {
+        printf("Error: Failed to open HDF5 file %s\n", filename);
+        return -1;
+    }
+    for (int k = 0; k < e->num_inputs; k++) {
+        memset(&req, 0, sizeof(req));
+        req.op = IO_CALLBACK;
+        req.obj = f->file_id;
+        req.name = e->inputs[k];
+        req.callback = expr_open_callback;
+        hdf5_io_submit(&req);
+        f->input_ids[k] = hdf5_io_wait(&req);
+        if (k == 0) {
+            f->m = (int)req.rows;
+            f->n = (int)req.cols;
+        }
+        if (f->input_ids[k] < 0 || (int)req.rows != f->m || (int)req.cols != f->n) {
+            printf("Error: Input dataset %s is missing or does not match %dx%d\n", e->inputs[k], f->m, f->n);
+            return -1;
+        }
+    }
+    memset(&req, 0, sizeof(req));
+    req.op = IO_CALLBACK;
+    req.obj = f->file_id;
+    req.name = result_name;
+    req.rows = e->nodes[root].kind == EXPR_KIND_FULL ? f->m : 1;
+    req.cols = f->n;
+    req.callback = expr_create_callback;
+    hdf5_io_submit(&req);
+    f->result_id = hdf5_io_wait(&req);
+    if (f->result_id < 0) {
+        printf("Error: Failed to create dataset %s\n", result_name);
+        return -1;
+    }
+    return 0;
+}
+
+// 为从根可达的行向量节点分配 1 x n 缓冲区
+static int expr_alloc_vectors(const expr_t *e, const int *reach, int n, double **vec) {
+    int ret = 0;
+    for (int k = 0; k < e->count; k++) {
+        vec[k] = NULL;
+        if (reach[k] && e->nodes[k].kind == EXPR_KIND_ROW && !(vec[k] = (double*)malloc((size_t)n * sizeof(double))))
+            ret = -1;
+    }
+    return ret;
+}
+
+static void expr_free_vectors(const expr_t *e, double **vec) {
+    for (int k = 0; k < e->count; k++)
+        free(vec[k]);
+}
+
+// 把 nthreads 份局部归约结果按线程顺序合并到 vec
+static void expr_merge_partials(const expr_t *e, const expr_pass_t *p, double *partials, int nthreads,
+                                double *const *vec, int n) {
+    for (int r = 0; r < p->num_reduce; r++) {
+        int k = p->reduce[r];
+        expr_op_t op = e->nodes[k].op;
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < n; j++) {
+            double acc = expr_reduce_identity(op);
+            for (int t = 0; t < nthreads; t++) {
+                double v = partials[((size_t)t * p->num_reduce + r) * n + j];
+                acc = op == EXPR_COL_SUM ? acc + v : (v > acc ? v : acc);
+            }
+            vec[k][j] = acc;
+        }
+    }
+}
+
+/**
+ * 融合求值：按行块从 filename 流式读取输入，在常驻缓存的瓦片上一次执行整棵 DAG，只把根节点写到 result_name
+ * （根为完整矩阵时 m x n，为行向量时 1 x n）；最多 PIPELINE_RING_SIZE 个行块的读请求在途，读与计算重叠。
+ * 含列归约时每层归约多扫描一遍输入，归约结果保存在 1 x n 向量中
+ *
+ * @param filename 文件名（需可写），输入与结果数据集都在其中
+ * @param root 结果节点下标
+ * @param block_rows 每个 I/O 行块的行数，<= 0 时按 EXPR_BLOCK_MB 选取
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int expr_eval_hdf5(const char *filename, const expr_t *e, int root, const char *result_name,
+                   int block_rows, expr_stats_t *stats) {
+    expr_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    expr_files_t f;
+    int reach[EXPR_MAX_NODES];
+    double *vec[EXPR_MAX_NODES] = {0};
+    int ret = expr_open_files(filename, e, root, result_name, &f);
+    int m = f.m, n = f.n;
+
+    if (ret == 0) {
+        expr_reachable(e, root, reach);
+        ret = expr_alloc_vectors(e, reach, n, vec);
+    }
+    if (block_rows <= 0 && n > 0)
+        block_rows = (int)((size_t)EXPR_BLOCK_MB * 1024 * 1024 / ((size_t)n * sizeof(double)));
+    if (block_rows < 1) block_rows = 1;
+    if (block_rows > m && m > 0) block_rows = m;
+    int full = ret == 0 && e->nodes[root].kind == EXPR_KIND_FULL;
+    int passes = ret < 0 ? 0 : e->nodes[root].level + (full ? 1 : 0);
+    int nthreads = omp_get_max_threads();
+    size_t block_bytes = (size_t)block_rows * n * sizeof(double);
+    double *in[PIPELINE_RING_SIZE][EXPR_MAX_INPUTS] = {{0}}, *out[PIPELINE_RING_SIZE] = {0};
+    hdf5_io_req_t reads[PIPELINE_RING_SIZE][EXPR_MAX_INPUTS], writes[PIPELINE_RING_SIZE];
+    int write_pending[PIPELINE_RING_SIZE] = {0};
+    double fixed_bytes = 0.0, peak_bytes = 0.0;
+
+    for (int s = 0; ret == 0 && s < PIPELINE_RING_SIZE; s++) {
+        for (int k = 0; k < e->num_inputs; k++)
+            if (!(in[s][k] = (double*)pool_alloc(block_bytes)))
+                ret = -1;
+        if (full && !(out[s] = (double*)pool_alloc(block_bytes)))
+            ret = -1;
+        fixed_bytes += (double)block_bytes * (e->num_inputs + full);
+    }
+    for (int k = 0; k < e->count; k++)
+        fixed_bytes += vec[k] ? (double)n * sizeof(double) : 0.0;
+    if (ret == 0) {
+        char text[512] = "";
+        expr_format(e, root, text, sizeof(text));
+        progress_printf("  [Expr] %s = %s (fused, %d pass%s, block %d rows)...\n", result_name, text,
+                        passes, passes == 1 ? "" : "es", block_rows);
+    }
+
+    int blocks = m > 0 ? (m + block_rows - 1) / block_rows : 0;
+    int segs = (n + EXPR_TILE - 1) / EXPR_TILE;
+    for (int pass = 0; ret == 0 && pass < passes; pass++) {
+        expr_pass_t plan;
+        expr_plan_pass(e, reach, root, pass, pass == passes - 1, &plan);
+        size_t scratch_bytes = (size_t)nthreads * (plan.slots > 0 ? plan.slots : 1) * EXPR_TILE * sizeof(double);
+        size_t partial_bytes = (size_t)nthreads * (plan.num_reduce > 0 ? plan.num_reduce : 1) * n * sizeof(double);
+        double *scratch = (double*)pool_alloc(scratch_bytes);
+        double *partials = (double*)pool_alloc(partial_bytes);
+        if (!scratch || !partials) {
+            printf("Error: Failed to allocate expression scratch buffers\n");
+            pool_free(scratch, scratch_bytes);
+            pool_free(partials, partial_bytes);
+            ret = -1;
+            break;
+        }
+        if ((double)scratch_bytes + partial_bytes + fixed_bytes > peak_bytes)
+            peak_bytes = (double)scratch_bytes + partial_bytes + fixed_bytes;
+        for (int t = 0; t < nthreads; t++)
+            for (int r = 0; r < plan.num_reduce; r++)
+                for (int j = 0; j < n; j++)
+                    partials[((size_t)t * plan.num_reduce + r) * n + j] = expr_reduce_identity(e->nodes[plan.reduce[r]].op);
+
+        // 预先提交前 PIPELINE_RING_SIZE 个行块的读请求，每处理完一块就把它的槽位交给后面的块
+        for (int b = 0; b < blocks + PIPELINE_RING_SIZE; b++) {
+            if (b >= PIPELINE_RING_SIZE) {
+                int d = b - PIPELINE_RING_SIZE, s = d % PIPELINE_RING_SIZE;
+                int row = d * block_rows, rows = m - row < block_rows ? m - row : block_rows;
+                double t0 = omp_get_wtime();
+                for (int k = 0; k < e->num_inputs; k++)
+                    if (plan.uses_input[k] && hdf5_io_wait(&reads[s][k]) < 0)
+                        ret = -1;
+                if (write_pending[s] && hdf5_io_wait(&writes[s]) < 0)
+                    ret = -1;
+                write_pending[s] = 0;
+                double t1 = omp_get_wtime();
+                st.io_wait_time += t1 - t0;
+                if (ret == 0) {
+                    uint64_t tr = trace_begin();
+                    long units = (long)rows * segs;
+                    #pragma omp parallel
+                    {
+                        int t = omp_get_thread_num();
+                        double *my_scratch = scratch + (size_t)t * (plan.slots > 0 ? plan.slots : 1) * EXPR_TILE;
+                        double *my_partial = partials + (size_t)t * plan.num_reduce * n;
+                        #pragma omp for schedule(static)
+                        for (long u = 0; u < units; u++) {
+                            int r = (int)(u / segs), c0 = (int)(u % segs) * EXPR_TILE;
+                            int len = n - c0 < EXPR_TILE ? n - c0 : EXPR_TILE;
+                            expr_eval_tile(e, &plan, in[s], vec, my_scratch, out[s], my_partial,
+                                           (size_t)r * n + c0, c0, len, n);
+                        }
+                    }
+                    trace_end(TRACE_EXPR, tr, (uint64_t)rows * n * sizeof(double));
+                    st.compute_time += omp_get_wtime() - t1;
+                    if (plan.output >= 0) {
+                        hdf5_io_rows(&writes[s], IO_WRITE, f.result_id, row, rows, n, out[s]);
+                        hdf5_io_submit(&writes[s]);
+                        write_pending[s] = 1;
+                        st.bytes_written += (double)rows * n * sizeof(double);
+                    }
+                }
+            }
+            if (b < blocks) {
+                int s = b % PIPELINE_RING_SIZE;
+                int row = b * block_rows, rows = m - row < block_rows ? m - row : block_rows;
+                for (int k = 0; k < e->num_inputs; k++) {
+                    if (!plan.uses_input[k])
+                        continue;
+                    hdf5_io_rows(&reads[s][k], IO_READ, f.input_ids[k], row, rows, n, in[s][k]);
+                    hdf5_io_submit(&reads[s][k]);
+                    st.bytes_read += (double)rows * n * sizeof(double);
+                }
+            }
+        }
+        for (int s = 0; s < PIPELINE_RING_SIZE; s++) {
+            if (write_pending[s] && hdf5_io_wait(&writes[s]) < 0)
+                ret = -1;
+            write_pending[s] = 0;
+        }
+
+        // 本遍的归约结果合并后，求出依赖它们的行向量节点
+        double t0 = omp_get_wtime();
+        expr_merge_partials(e, &plan, partials, nthreads, vec, n);
+        for (int k = 0; ret == 0 && k < e->count; k++)
+            if (vec[k] && e->nodes[k].level == pass + 1 && !expr_is_full_reduce(e, k))
+                expr_eval_row(e, k, vec, m, n);
+        st.compute_time += omp_get_wtime() - t0;
+        pool_free(scratch, scratch_bytes);
+        pool_free(partials, partial_bytes);
+    }
+
+    // 根节点是行向量时写出 1 x n 结果
+    if (ret == 0 && !full) {
+        hdf5_io_req_t req;
+        hdf5_io_rows(&req, IO_WRITE, f.result_id, 0, 1, n, vec[root]);
+        hdf5_io_submit(&req);
+        if (hdf5_io_wait(&req) < 0)
+            ret = -1;
+        st.bytes_written += (double)n * sizeof(double);
+    }
+
+    for (int s = 0; s < PIPELINE_RING_SIZE; s++) {
+        for (int k = 0; k < e->num_inputs; k++)
+            pool_free(in[s][k], block_bytes);
+        pool_free(out[s], block_bytes);
+    }
+    expr_free_vectors(e, vec);
+    expr_close_files(&f, e);
+
+    st.passes = passes;
+    st.block_rows = block_rows;
+    st.elements = full ? (double)m * n : (double)n;
+    st.bytes_moved = st.bytes_read + st.bytes_written;
+    st.peak_buffer_mb = peak_bytes / (1024 * 1024);
+    st.total_time = omp_get_wtime() - t_start;
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Failed to evaluate expression into %s\n", result_name);
+    return ret;
+}
+
+/**
+ * 逐算子求值（用于对比）：先把输入整体读入内存，每个算子在完整大小的数组上并行执行一遍并物化结果，
+ * 中间结果在最后一次使用后释放；算子内核与融合求值相同
+ *
+ * @return 0 成功，-1 失败
+ */
+int expr_eval_unfused_hdf5(const char *filename, const expr_t *e, int root, const char *result_name,
+                           expr_stats_t *stats) {
+    expr_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    expr_files_t f;
+    int reach[EXPR_MAX_NODES], last_use[EXPR_MAX_NODES];
+    double *vec[EXPR_MAX_NODES] = {0}, *buf[EXPR_MAX_NODES] = {0};
+    int ret = expr_open_files(filename, e, root, result_name, &f);
+    int m = f.m, n = f.n;
+    size_t full_bytes = (size_t)m * n * sizeof(double);
+    double live_bytes = 0.0, peak_bytes = 0.0;
+
+    if (ret == 0) {
+        expr_reachable(e, root, reach);
+        ret = expr_alloc_vectors(e, reach, n, vec);
+        for (int k = 0; k < e->count; k++)
+            live_bytes += vec[k] ? (double)n * sizeof(double) : 0.0;
+        peak_bytes = live_bytes;
+        char text[512] = "";
+        expr_format(e, root, text, sizeof(text));
+        progress_printf("  [Expr] %s = %s (unfused)...\n", result_name, text);
+    }
+    for (int k = 0; ret == 0 && k < e->count; k++) {
+        last_use[k] = k == root ? INT_MAX : -1;
+        if (reach[k] && e->nodes[k].a >= 0) last_use[e->nodes[k].a] = k;
+        if (reach[k] && e->nodes[k].b >= 0) last_use[e->nodes[k].b] = k;
+    }
+
+    int segs = (n + EXPR_TILE - 1) / EXPR_TILE;
+    int nthreads = omp_get_max_threads();
+    for (int k = 0; ret == 0 && k < e->count; k++) {
+        const expr_node_t *x = &e->nodes[k];
+        if (!reach[k] || x->op == EXPR_SCALAR)
+            continue;
+        if (x->kind == EXPR_KIND_ROW && !expr_is_full_reduce(e, k)) {
+            expr_eval_row(e, k, vec, m, n);
+            continue;
+        }
+        if (x->kind == EXPR_KIND_FULL) {
+            if (!(buf[k] = (double*)pool_alloc(full_bytes))) {
+                ret = -1;
+                break;
+            }
+            live_bytes += full_bytes;
+            if (live_bytes > peak_bytes)
+                peak_bytes = live_bytes;
+        }
+        if (x->op == EXPR_INPUT) {
+            hdf5_io_req_t req;
+            double t0 = omp_get_wtime();
+            hdf5_io_rows(&req, IO_READ, f.input_ids[x->input], 0, m, n, buf[k]);
+            hdf5_io_submit(&req);
+            if (hdf5_io_wait(&req) < 0)
+                ret = -1;
+            st.io_wait_time += omp_get_wtime() - t0;
+            st.bytes_read += full_bytes;
+            st.bytes_moved += full_bytes;
+            continue;
+        }
+
+        // 完整大小数组上的一遍：逐元素算子读操作数、写结果；列归约读子节点并按线程累加
+        double t0 = omp_get_wtime();
+        int reduce = expr_is_full_reduce(e, k);
+        size_t partial_bytes = reduce ? (size_t)nthreads * n * sizeof(double) : 0;
+        double *partials = reduce ? (double*)pool_alloc(partial_bytes) : NULL;
+        if (reduce && !partials) {
+            ret = -1;
+            break;
+        }
+        for (size_t j = 0; reduce && j < (size_t)nthreads * n; j++)
+            partials[j] = expr_reduce_identity(x->op);
+        long units = (long)m * segs;
+        #pragma omp parallel
+        {
+            int t = omp_get_thread_num();
+            #pragma omp for schedule(static)
+            for (long u = 0; u < units; u++) {
+                int r = (int)(u / segs), c0 = (int)(u % segs) * EXPR_TILE;
+                int len = n - c0 < EXPR_TILE ? n - c0 : EXPR_TILE;
+                size_t offset = (size_t)r * n + c0;
+                if (reduce) {
+                    expr_reduce(x->op, partials + (size_t)t * n + c0, buf[x->a] + offset, len);
+                    continue;
+                }
+                expr_arg_t a = e->nodes[x->a].kind == EXPR_KIND_FULL ? (expr_arg_t){buf[x->a] + offset, 0.0}
+                                                                    : expr_row_arg(e, x->a, vec, c0);
+                expr_arg_t b = {NULL, 0.0};
+                if (x->b >= 0)
+                    b = e->nodes[x->b].kind == EXPR_KIND_FULL ? (expr_arg_t){buf[x->b] + offset, 0.0}
+                                                             : expr_row_arg(e, x->b, vec, c0);
+                expr_kernel(x->op, buf[k] + offset, a, b, len);
+            }
+        }
+        if (reduce) {
+            expr_pass_t plan = {.num_reduce = 1};
+            plan.reduce[0] = k;
+            expr_merge_partials(e, &plan, partials, nthreads, vec, n);
+            pool_free(partials, partial_bytes);
+        }
+        st.compute_time += omp_get_wtime() - t0;
+        st.passes++;
+        st.bytes_moved += (double)full_bytes * ((x->a >= 0 && e->nodes[x->a].kind == EXPR_KIND_FULL) +
+                                                (x->b >= 0 && e->nodes[x->b].kind == EXPR_KIND_FULL) + !reduce);
+
+        // 释放最后一次使用在本节点的中间结果
+        for (int c = 0; c < 2; c++) {
+            int child = c ? x->b : x->a;
+            if (child >= 0 && buf[child] && last_use[child] == k) {
+                pool_free(buf[child], full_bytes);
+                buf[child] = NULL;
+                live_bytes -= full_bytes;
+            }
+        }
+    }
+
+    if (ret == 0) {
+        int full = e->nodes[root].kind == EXPR_KIND_FULL;
+        hdf5_io_req_t req;
+        double t0 = omp_get_wtime();
+        hdf5_io_rows(&req, IO_WRITE, f.result_id, 0, full ? m : 1, n, full ? buf[root] : vec[root]);
+        hdf5_io_submit(&req);
+        if (hdf5_io_wait(&req) < 0)
+            ret = -1;
+        st.io_wait_time += omp_get_wtime() - t0;
+        st.bytes_written = full ? (double)full_bytes : (double)n * sizeof(double);
+        st.bytes_moved += st.bytes_written;
+        st.elements = full ? (double)m * n : (double)n;
+    }
+    for (int k = 0; k < e->count; k++)
+        if (buf[k])
+            pool_free(buf[k], full_bytes);
+    expr_free_vectors(e, vec);
+    expr_close_files(&f, e);
+
+    st.block_rows = m;
+    st.peak_buffer_mb = peak_bytes / (1024 * 1024);
+    st.total_time = omp_get_wtime() - t_start;
+    if (stats)
+        *stats = st;
+    if (ret < 0)
+        printf("Error: Failed to evaluate expression into %s\n", result_name);
+    return ret;
+}
+
+// 演示与基准测试使用的表达式
+typedef enum { EXPR_DEMO_AXPY, EXPR_DEMO_COLNORM, EXPR_DEMO_COUNT } expr_demo_t;
+
+static const char *const expr_demo_names[EXPR_DEMO_COUNT] = {"axpy", "colnorm"};
+
+/**
+ * 构建演示表达式：axpy = alpha * A + B .* C，colnorm = A ./ sqrt(col_sum(A .* A))（按列 L2 归一化）
+ *
+ * @return 根节点下标，-1 表示失败
+ */
+int expr_build_demo(expr_t *e, expr_demo_t which, const char *a_name, const char *b_name,
+                    const char *c_name, double alpha) {
+    expr_init(e);
+    int a = expr_input(e, a_name);
+    if (which == EXPR_DEMO_COLNORM)
+        return expr_binary(e, EXPR_DIV, a,
+                           expr_unary(e, EXPR_SQRT, expr_unary(e, EXPR_COL_SUM, expr_binary(e, EXPR_MUL, a, a))));
+    return expr_binary(e, EXPR_ADD, expr_binary(e, EXPR_MUL, expr_scalar(e, alpha), a),
+                       expr_binary(e, EXPR_MUL, expr_input(e, b_name), expr_input(e, c_name)));
+}
+
+/**
+ * 在内存中直接计算演示表达式（朴素循环），用于校验 n x n 结果
+ */
+void expr_reference_demo(expr_demo_t which, const double *A, const double *B, const double *C, int n,
+                         double alpha, double *out) {
+    size_t count = (size_t)n * n;
+    if (which == EXPR_DEMO_AXPY) {
+        #pragma omp parallel for
+        for (size_t k = 0; k < count; k++)
+            out[k] = alpha * A[k] + B[k] * C[k];
+        return;
+    }
+    double *norms = (double*)calloc(n, sizeof(double));
+    if (!norms)
+        return;
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            norms[j] += A[(size_t)i * n + j] * A[(size_t)i * n + j];
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            out[(size_t)i * n + j] = A[(size_t)i * n + j] / sqrt(norms[j]);
+    free(norms);
+}
+
+/**
+ * 读回 rows x n 的结果数据集
+ *
+ * @return 0 成功，-1 失败
+ */
+int expr_read_result(const char *filename, const char *result_name, double *buf, int rows, int n) {
+    hid_t file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    hid_t dataset_id = file_id < 0 ? -1 : hdf5_io_call(IO_DATASET_OPEN, file_id, result_name, 0, 0);
+    int ret = dataset_id >= 0 ? 0 : -1;
+    if (ret == 0) {
+        hdf5_io_req_t req;
+        hdf5_io_rows(&req, IO_READ, dataset_id, 0, rows, n, buf);
+        hdf5_io_submit(&req);
+        if (hdf5_io_wait(&req) < 0)
+            ret = -1;
+        hdf5_io_call(IO_DATASET_CLOSE, dataset_id, NULL, 0, 0);
+    }
+    if (file_id >= 0)
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    if (ret < 0)
+        printf("Error: Failed to read %s from %s\n", result_name, filename);
+    return ret;
+}
+
+/**
+ * 打印表达式求值统计
+ */
+void print_expr_stats(const char *label, const expr_stats_t *st) {
+    printf("%s: %.4f 秒 (等待 I/O %.4f 秒, 计算 %.4f 秒), %d 遍, 每个结果元素搬运 %.1f 字节, 缓冲区峰值 %.2f MB\n",
+           label, st->total_time, st->io_wait_time, st->compute_time, st->passes,
+           st->elements > 0 ? st->bytes_moved / st->elements : 0.0, st->peak_buffer_mb);
+}
+
+// ===================== 稀疏矩阵：CSR 存储与 SpMV/SpMM =====================
+// 非零元素很少的矩阵以 CSR 形式保存，按 basic_operation.c 的分组方式放在 /csr/matrix_i 组下：
+//   indptr  (int64, rows + 1)：第 i 行的非零元素位于 [indptr[i], indptr[i + 1])
+//   indices (int32, nnz)：列号，每行内递增
+//   values  (float64, nnz)：非零值
+// 组上的 "dimensions" 属性记录 {rows, cols}。稠密 -> CSR 转换先并行统计每行非零数、求前缀和，再并行填充；
+// 读取时先读 indptr，再把行按非零数均分给各线程，每个线程提交自己那段 indices/values 的 hyperslab 读请求；
+// SpMV/SpMM 使用同样按非零数均衡的行划分，存储、I/O 与乘法开销都大致与密度成正比。
+
+#define CSR_GROUP "/csr"
+#define CSR_DENSITY 0.01            // 演示中稀疏矩阵的非零密度，可由 --density 覆盖
+#define SPMM_COLS 64                // SpMM 右端稠密矩阵的列数
+
+typedef struct {
+    int rows, cols;
+    int64_t nnz;
+    int64_t *indptr;                // rows + 1
+    int32_t *indices;               // nnz
+    double *values;                 // nnz
+} csr_matrix_t;
+
+// CSR 读写统计
+typedef struct {
+    double total_time;
+    double stored_bytes;            // indptr + indices + values 的字节数
+} csr_stats_t;
+
+/**
+ * 生成密度约为 density 的稀疏矩阵（稠密形式）：非零值与 init_matrix_parallel 相同，
+ * 是否保留由另一条 Philox 流决定，结果与线程数无关
+ */
+void init_matrix_sparse(double *matrix, int n, int matrix_id, double density) {
+    #pragma omp parallel
+    {
+        double *mask = (double*)malloc((size_t)n * sizeof(double));
+        uint64_t t0 = trace_begin();
+        int rows = 0;
+        #pragma omp for schedule(static)
+        for (int i = 0; i < n; i++) {
+            double *row = matrix + (size_t)i * n;
+            philox_fill_row(row, RNG_SEED, (uint32_t)matrix_id, (uint32_t)i, n);
+            if (mask) {
+                philox_fill_row(mask, RNG_SEED, (uint32_t)matrix_id | 0x80000000u, (uint32_t)i, n);
+                #pragma omp simd
+                for (int j = 0; j < n; j++)
+                    row[j] = mask[j] < density ? row[j] : 0.0;
+            }
+            rows++;
+        }
+        trace_end(TRACE_INIT, t0, (uint64_t)rows * n * sizeof(double));
+        free(mask);
+    }
+}
+
+static size_t csr_indptr_bytes(const csr_matrix_t *csr) { return ((size_t)csr->rows + 1) * sizeof(int64_t); }
+static size_t csr_indices_bytes(const csr_matrix_t *csr) { return (size_t)csr->nnz * sizeof(int32_t); }
+static size_t csr_values_bytes(const csr_matrix_t *csr) { return (size_t)csr->nnz * sizeof(double); }
+
+/**
+ * CSR 数组在文件中占用的字节数
+ */
+double csr_stored_bytes(const csr_matrix_t *csr) {
+    return (double)csr_indptr_bytes(csr) + csr_indices_bytes(csr) + csr_values_bytes(csr);
+}
+
+// 按 csr->nnz 分配 indices / values（indptr 已分配）
+static int csr_alloc_entries(csr_matrix_t *csr) {
+    csr->indices = (int32_t*)pool_alloc(csr_indices_bytes(csr) ? csr_indices_bytes(csr) : 1);
+    csr->values = (double*)pool_alloc(csr_values_bytes(csr) ? csr_values_bytes(csr) : 1);
+    return csr->indices && csr->values ? 0 : -1;
+}
+
+/**
+ * 释放 CSR 矩阵的数组
+ */
+void csr_free(csr_matrix_t *csr) {
+    pool_free(csr->indptr, csr_indptr_bytes(csr));
+    pool_free(csr->indices, csr_indices_bytes(csr) ? csr_indices_bytes(csr) : 1);
+    pool_free(csr->values, csr_values_bytes(csr) ? csr_values_bytes(csr) : 1);
+    memset(csr, 0, sizeof(*csr));
+}
+
+/**
+ * 并行稠密 -> CSR 转换：第一遍各线程统计自己行的非零数，前缀和得到 indptr，第二遍各行独立填充
+ *
+ * @return 0 成功，-1 失败
+ */
+int dense_to_csr_parallel(const double *dense, int rows, int cols, csr_matrix_t *csr) {
+    memset(csr, 0, sizeof(*csr));
+    csr->rows = rows;
+    csr->cols = cols;
+    if (!(csr->indptr = (int64_t*)pool_alloc(csr_indptr_bytes(csr))))
+        return -1;
+    csr->indptr[0] = 0;
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        const double *row = dense + (size_t)i * cols;
+        int64_t count = 0;
+        #pragma omp simd reduction(+:count)
+        for (int j = 0; j < cols; j++)
+            count += row[j] != 0.0;
+        csr->indptr[i + 1] = count;
+    }
+    for (int i = 0; i < rows; i++)
+        csr->indptr[i + 1] += csr->indptr[i];
+    csr->nnz = csr->indptr[rows];
+    if (csr_alloc_entries(csr) < 0) {
+        csr_free(csr);
+        return -1;
+    }
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        const double *row = dense + (size_t)i * cols;
+        int64_t k = csr->indptr[i];
+        for (int j = 0; j < cols; j++) {
+            if (row[j] != 0.0) {
+                csr->indices[k] = j;
+                csr->values[k++] = row[j];
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * 串行稠密 -> CSR 转换（用于对比）：单遍扫描，数组按需倍增
+ *
+ * @return 0 成功，-1 失败
+ */
+int dense_to_csr_serial(const double *dense, int rows, int cols, csr_matrix_t *csr) {
+    size_t capacity = 1024;
+    memset(csr, 0, sizeof(*csr));
+    csr->rows = rows;
+    csr->cols = cols;
+    csr->indptr = (int64_t*)pool_alloc(csr_indptr_bytes(csr));
+    int32_t *indices = (int32_t*)malloc(capacity * sizeof(int32_t));
+    double *values = (double*)malloc(capacity * sizeof(double));
+    int ret = csr->indptr && indices && values ? 0 : -1;
+    int64_t k = 0;
+    for (int i = 0; ret == 0 && i < rows; i++) {
+        csr->indptr[i] = k;
+        for (int j = 0; ret == 0 && j < cols; j++) {
+            double v = dense[(size_t)i * cols + j];
+            if (v == 0.0)
+                continue;
+            if ((size_t)k == capacity) {
+                int32_t *ni = (int32_t*)realloc(indices, 2 * capacity * sizeof(int32_t));
+                if (ni) indices = ni;
+                double *nv = (double*)realloc(values, 2 * capacity * sizeof(double));
+                if (nv) values = nv;
+                if (!ni || !nv) {
+                    ret = -1;
+                    break;
+                }
+                capacity *= 2;
+            }
+            indices[k] = j;
+            values[k++] = v;
+        }
+    }
+    if (ret == 0) {
+        csr->indptr[rows] = csr->nnz = k;
+        ret = csr_alloc_entries(csr);
+    }
+    if (ret == 0) {
+        memcpy(csr->indices, indices, csr_indices_bytes(csr));
+        memcpy(csr->values, values, csr_values_bytes(csr));
+    }
+    free(indices);
+    free(values);
+    if (ret < 0)
+        csr_free(csr);
+    return ret;
+}
+
+/**
+ * 两个 CSR 矩阵是否完全相同（形状、结构与数值逐位比较）
+ */
+int csr_equal(const csr_matrix_t *a, const csr_matrix_t *b) {
+    return a->rows == b->rows && a->cols == b->cols && a->nnz == b->nnz &&
+           memcmp(a->indptr, b->indptr, csr_indptr_bytes(a)) == 0 &&
+           memcmp(a->indices, b->indices, csr_indices_bytes(a)) == 0 &&
+           memcmp(a->values, b->values, csr_values_bytes(a)) == 0;
+}
+
+/**
+ * 按非零数均衡的行划分：返回第 part 段（共 parts 段）的起始行
+ * 权重取 indptr[i] + i，行本身的开销也计入，全空的行不会都落到同一段
+ */
+int csr_partition_row(const csr_matrix_t *csr, int part, int parts) {
+    if (part <= 0)
+        return 0;
+    if (part >= parts)
+        return csr->rows;
+    int64_t target = (int64_t)((double)(csr->nnz + csr->rows) * part / parts);
+    int lo = 0, hi = csr->rows;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (csr->indptr[mid] + mid < target)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * 并行 SpMV：y = A * x，每个线程处理一段非零数均衡的连续行
+ */
+void spmv_csr_parallel(const csr_matrix_t *A, const double *x, double *y) {
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), threads = omp_get_num_threads();
+        int r0 = csr_partition_row(A, t, threads), r1 = csr_partition_row(A, t + 1, threads);
+        for (int i = r0; i < r1; i++) {
+            double sum = 0.0;
+            #pragma omp simd reduction(+:sum)
+            for (int64_t k = A->indptr[i]; k < A->indptr[i + 1]; k++)
+                sum += A->values[k] * x[A->indices[k]];
+            y[i] = sum;
+        }
+    }
+}
+
+/**
+ * 串行 SpMV（用于对比）
+ */
+void spmv_csr_serial(const csr_matrix_t *A, const double *x, double *y) {
+    for (int i = 0; i < A->rows; i++) {
+        double sum = 0.0;
+        for (int64_t k = A->indptr[i]; k < A->indptr[i + 1]; k++)
+            sum += A->values[k] * x[A->indices[k]];
+        y[i] = sum;
+    }
+}
+
+/**
+ * 并行 SpMM：C (rows x k) = A * B (cols x k)，行主序；
+ * 每个非零元素把 B 的一整行按 SIMD 累加到 C 的对应行，行划分与 SpMV 相同
+ */
+void spmm_csr_parallel(const csr_matrix_t *A, const double *B, int k, double *C) {
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), threads = omp_get_num_threads();
+        int r0 = csr_partition_row(A, t, threads), r1 = csr_partition_row(A, t + 1, threads);
+        for (int i = r0; i < r1; i++) {
+            double *restrict c = C + (size_t)i * k;
+            memset(c, 0, (size_t)k * sizeof(double));
+            for (int64_t p = A->indptr[i]; p < A->indptr[i + 1]; p++) {
+                const double *restrict b = B + (size_t)A->indices[p] * k;
+                double v = A->values[p];
+                #pragma omp simd
+                for (int j = 0; j < k; j++)
+                    c[j] += v * b[j];
+            }
+        }
+    }
+}
+
+/**
+ * 串行 SpMM（用于对比）
+ */
+void spmm_csr_serial(const csr_matrix_t *A, const double *B, int k, double *C) {
+    memset(C, 0, (size_t)A->rows * k * sizeof(double));
+    for (int i = 0; i < A->rows; i++)
+        for (int64_t p = A->indptr[i]; p < A->indptr[i + 1]; p++)
+            for (int j = 0; j < k; j++)
+                C[(size_t)i * k + j] += A->values[p] * B[(size_t)A->indices[p] * k + j];
+}
+
+/**
+ * 稠密矩阵向量乘 y = A * x（rows x cols，作为 SpMV 的对照）
+ */
+void dense_matvec_parallel(const double *A, int rows, int cols, const double *x, double *y) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        const double *row = A + (size_t)i * cols;
+        double sum = 0.0;
+        #pragma omp simd reduction(+:sum)
+        for (int j = 0; j < cols; j++)
+            sum += row[j] * x[j];
+        y[i] = sum;
+    }
+}
+
+// 在 I/O 线程上创建 1 维数据集 name 并整体写入 count 个元素
+static herr_t csr_write_array(hid_t group_id, const char *name, hid_t file_type, hid_t mem_type,
+                              hsize_t count, const void *buf) {
+    hid_t space_id = H5Screate_simple(1, &count, NULL);
+    hid_t dataset_id = H5Dcreate(group_id, name, file_type, space_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    herr_t status = dataset_id >= 0 ? 0 : -1;
+    uint64_t t0 = trace_begin();
+    if (status == 0 && count > 0)
+        status = H5Dwrite(dataset_id, mem_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf);
+    trace_end(TRACE_H5_WRITE, t0, count * H5Tget_size(mem_type));
+    if (dataset_id >= 0)
+        H5Dclose(dataset_id);
+    H5Sclose(space_id);
+    return status;
+}
+
+// 在 I/O 线程上写一个 CSR 矩阵：obj = file_id, name = 组路径, arg = csr_matrix_t
+static void csr_write_callback(hdf5_io_req_t *req) {
+    const csr_matrix_t *csr = (const csr_matrix_t*)req->arg;
+    hsize_t attr_dims[1] = {2};
+    int dims[2] = {csr->rows, csr->cols};
+    hid_t group_id = H5Gcreate(req->obj, req->name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    if (group_id < 0) {
+        req->result = -1;
+        return;
+    }
+    hid_t attr_space = H5Screate_simple(1, attr_dims, NULL);
+    hid_t attr_id = H5Acreate(group_id, "dimensions", H5T_STD_I32LE, attr_space, H5P_DEFAULT, H5P_DEFAULT);
+    if (attr_id < 0 || H5Awrite(attr_id, H5T_NATIVE_INT, dims) < 0 ||
+        csr_write_array(group_id, "indptr", H5T_STD_I64LE, H5T_NATIVE_INT64, (hsize_t)csr->rows + 1, csr->indptr) < 0 ||
+        csr_write_array(group_id, "indices", H5T_STD_I32LE, H5T_NATIVE_INT32, (hsize_t)csr->nnz, csr->indices) < 0 ||
+        csr_write_array(group_id, "values", H5T_IEEE_F64LE, H5T_NATIVE_DOUBLE, (hsize_t)csr->nnz, csr->values) < 0)
+        req->result = -1;
+    if (attr_id >= 0)
+        H5Aclose(attr_id);
+    H5Sclose(attr_space);
+    H5Gclose(group_id);
+}
+
+// 在 I/O 线程上创建 /csr 组
+static void csr_group_callback(hdf5_io_req_t *req) {
+    hid_t group_id = H5Gcreate(req->obj, CSR_GROUP, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    req->result = group_id < 0 ? -1 : H5Gclose(group_id);
+}
+
+/**
+ * 把 num_matrices 个 CSR 矩阵写入新文件的 /csr/matrix_i 组，各矩阵的写请求一次提交给 I/O 线程
+ *
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败
+ */
+int csr_write_hdf5(const char *filename, const csr_matrix_t *csrs, int num_matrices, csr_stats_t *stats) {
+    csr_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    progress_printf("  [CSR] Write %d sparse matrices to %s...\n", num_matrices, filename);
+    hid_t file_id = hdf5_io_call(IO_FILE_CREATE, -1, filename, 0, 0);
+    if (file_id < 0) {
+        printf("Error: Failed to create HDF5 file %s\n", filename);
+        return -1;
+    }
+    hdf5_io_req_t group_req = {0};
+    group_req.op = IO_CALLBACK;
+    group_req.obj = file_id;
+    group_req.callback = csr_group_callback;
+    hdf5_io_submit(&group_req);
+    int ret = hdf5_io_wait(&group_req) < 0 ? -1 : 0;
+
+    hdf5_io_req_t reqs[num_matrices > 0 ? num_matrices : 1];
+    char names[num_matrices > 0 ? num_matrices : 1][64];
+    for (int i = 0; ret == 0 && i < num_matrices; i++) {
+        snprintf(names[i], sizeof(names[i]), CSR_GROUP "/matrix_%d", i);
+        memset(&reqs[i], 0, sizeof(reqs[i]));
+        reqs[i].op = IO_CALLBACK;
+        reqs[i].obj = file_id;
+        reqs[i].name = names[i];
+        reqs[i].arg = (void*)&csrs[i];
+        reqs[i].callback = csr_write_callback;
+        hdf5_io_submit(&reqs[i]);
+        st.stored_bytes += csr_stored_bytes(&csrs[i]);
+    }
+    for (int i = 0; ret == 0 && i < num_matrices; i++)
+        if (hdf5_io_wait(&reqs[i]) < 0) {
+            printf("Error: Failed to write %s\n", names[i]);
+            ret = -1;
+        }
+    if (hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0) < 0)
+        ret = -1;
+    st.total_time = omp_get_wtime() - t_start;
+    if (stats)
+        *stats = st;
+    return ret;
+}
+
+// 打开的 CSR 组
+typedef struct {
+    hid_t group_id, indptr_id, indices_id, values_id;
+    int rows, cols;
+    int64_t nnz;
+} csr_handles_t;
+
+// 1 维数据集的 hyperslab 读取参数
+typedef struct {
+    hid_t dataset_id, mem_type;
+    hsize_t offset, count;
+    void *buf;
+} csr_slice_t;
+
+// 在 I/O 线程上打开 CSR 组：obj = file_id, name = 组路径, arg = csr_handles_t
+static void csr_open_callback(hdf5_io_req_t *req) {
+    csr_handles_t *h = (csr_handles_t*)req->arg;
+    int dims[2] = {0, 0};
+    hsize_t count = 0;
+    h->group_id = H5Gopen(req->obj, req->name, H5P_DEFAULT);
+    h->indptr_id = h->indices_id = h->values_id = -1;
+    if (h->group_id < 0) {
+        req->result = -1;
+        return;
+    }
+    hid_t attr_id = H5Aopen(h->group_id, "dimensions", H5P_DEFAULT);
+    if (attr_id < 0 || H5Aread(attr_id, H5T_NATIVE_INT, dims) < 0)
+        req->result = -1;
+    if (attr_id >= 0)
+        H5Aclose(attr_id);
+    h->indptr_id = H5Dopen(h->group_id, "indptr", H5P_DEFAULT);
+    h->indices_id = H5Dopen(h->group_id, "indices", H5P_DEFAULT);
+    h->values_id = H5Dopen(h->group_id, "values", H5P_DEFAULT);
+    hid_t space_id = h->values_id >= 0 ? H5Dget_space(h->values_id) : -1;
+    if (space_id < 0 || H5Sget_simple_extent_dims(space_id, &count, NULL) != 1 ||
+        h->indptr_id < 0 || h->indices_id < 0)
+        req->result = -1;
+    if (space_id >= 0)
+        H5Sclose(space_id);
+    h->rows = dims[0];
+    h->cols = dims[1];
+    h->nnz = (int64_t)count;
+}
+
+// 在 I/O 线程上关闭 CSR 组
+static void csr_close_callback(hdf5_io_req_t *req) {
+    csr_handles_t *h = (csr_handles_t*)req->arg;
+    if (h->values_id >= 0) H5Dclose(h->values_id);
+    if (h->indices_id >= 0) H5Dclose(h->indices_id);
+    if (h->indptr_id >= 0) H5Dclose(h->indptr_id);
+    if (h->group_id >= 0) H5Gclose(h->group_id);
+}
+
+// 在 I/O 线程上读取 1 维数据集的 [offset, offset + count) 段
+static void csr_slice_callback(hdf5_io_req_t *req) {
+    csr_slice_t *s = (csr_slice_t*)req->arg;
+    hid_t file_space = H5Dget_space(s->dataset_id);
+    hid_t mem_space = H5Screate_simple(1, &s->count, NULL);
+    uint64_t t0 = trace_begin();
+    req->result = -1;
+    if (file_space >= 0 && mem_space >= 0 &&
+        H5Sselect_hyperslab(file_space, H5S_SELECT_SET, &s->offset, NULL, &s->count, NULL) >= 0)
+        req->result = H5Dread(s->dataset_id, s->mem_type, mem_space, file_space, H5P_DEFAULT, s->buf);
+    trace_end(TRACE_H5_READ, t0, s->count * H5Tget_size(s->mem_type));
+    if (mem_space >= 0) H5Sclose(mem_space);
+    if (file_space >= 0) H5Sclose(file_space);
+}
+
+// 提交一个 1 维段读取请求
+static void csr_submit_slice(hdf5_io_req_t *req, csr_slice_t *slice, hid_t dataset_id, hid_t mem_type,
+                             hsize_t offset, hsize_t count, void *buf) {
+    *slice = (csr_slice_t){dataset_id, mem_type, offset, count, buf};
+    memset(req, 0, sizeof(*req));
+    req->op = IO_CALLBACK;
+    req->callback = csr_slice_callback;
+    req->arg = slice;
+    hdf5_io_submit(req);
+}
+
+/**
+ * 读取 /csr/matrix_<index>：先读 indptr，再按非零数把行均分为 parts 段，
+ * 各线程并行提交自己那段 indices / values 的 hyperslab 读请求，直接读到结果数组的对应位置
+ *
+ * @param parts 行划分段数，<= 0 时取线程数
+ * @param stats 输出统计，可为 NULL
+ * @return 0 成功，-1 失败（失败时 csr 已释放）
+ */
+int csr_read_hdf5(const char *filename, int index, csr_matrix_t *csr, int parts, csr_stats_t *stats) {
+    csr_stats_t st = {0};
+    double t_start = omp_get_wtime();
+    char group_name[64];
+    csr_handles_t h = {-1, -1, -1, -1, 0, 0, 0};
+    memset(csr, 0, sizeof(*csr));
+    if (parts <= 0)
+        parts = omp_get_max_threads();
+    snprintf(group_name, sizeof(group_name), CSR_GROUP "/matrix_%d", index);
+
+    hid_t file_id = hdf5_io_call(IO_FILE_OPEN, -1, filename, 0, 0);
+    int ret = file_id >= 0 ? 0 : -1;
+    if (ret == 0) {
+        hdf5_io_req_t req = {0};
+        req.op = IO_CALLBACK;
+        req.obj = file_id;
+        req.name = group_name;
+        req.arg = &h;
+        req.callback = csr_open_callback;
+        hdf5_io_submit(&req);
+        if (hdf5_io_wait(&req) < 0 || h.rows < 0 || h.cols < 0)
+            ret = -1;
+    }
+    if (ret == 0) {
+        csr->rows = h.rows;
+        csr->cols = h.cols;
+        csr->nnz = h.nnz;
+        csr->indptr = (int64_t*)pool_alloc(csr_indptr_bytes(csr));
+        if (!csr->indptr || csr_alloc_entries(csr) < 0)
+            ret = -1;
+    }
+    if (ret == 0) {
+        hdf5_io_req_t req;
+        csr_slice_t slice;
+        csr_submit_slice(&req, &slice, h.indptr_id, H5T_NATIVE_INT64, 0, (hsize_t)csr->rows + 1, csr->indptr);
+        if (hdf5_io_wait(&req) < 0 || csr->indptr[0] != 0 || csr->indptr[csr->rows] != csr->nnz)
+            ret = -1;
+    }
+    if (ret == 0) {
+        progress_printf("  [CSR] Read %s (%dx%d, nnz %lld) in %d row partitions...\n", group_name,
+                        csr->rows, csr->cols, (long long)csr->nnz, parts);
+        int failed = 0;
+        #pragma omp parallel for schedule(static) reduction(+:failed)
+        for (int p = 0; p < parts; p++) {
+            int r0 = csr_partition_row(csr, p, parts), r1 = csr_partition_row(csr, p + 1, parts);
+            int64_t k0 = csr->indptr[r0], count = csr->indptr[r1] - k0;
+            hdf5_io_req_t reqs[2];
+            csr_slice_t slices[2];
+            if (count <= 0)
+                continue;
+            csr_submit_slice(&reqs[0], &slices[0], h.indices_id, H5T_NATIVE_INT32, k0, count, csr->indices + k0);
+            csr_submit_slice(&reqs[1], &slices[1], h.values_id, H5T_NATIVE_DOUBLE, k0, count, csr->values + k0);
+            failed += hdf5_io_wait(&reqs[0]) < 0;
+            failed += hdf5_io_wait(&reqs[1]) < 0;
+        }
+        if (failed)
+            ret = -1;
+    }
+    if (file_id >= 0) {
+        hdf5_io_req_t req = {0};
+        req.op = IO_CALLBACK;
+        req.arg = &h;
+        req.callback = csr_close_callback;
+        hdf5_io_submit(&req);
+        hdf5_io_wait(&req);
+        hdf5_io_call(IO_FILE_CLOSE, file_id, NULL, 0, 0);
+    }
+    st.stored_bytes = ret == 0 ? csr_stored_bytes(csr) : 0.0;
+    st.total_time = omp_get_wtime() - t_start;
+    if (ret < 0) {
+        printf("Error: Failed to read %s from %s\n", group_name, filename);
+        csr_free(csr);
+    }
+    if (stats)
+        *stats = st;
+    return ret;
+}
+
+// ===================== 可配置基准测试框架 =====================
+// 通过命令行指定矩阵大小、数据集数量、线程数、分块大小和存储布局（均可为逗号分隔的列表），
+// 对每种组合的每个阶段执行 warmup 次预热和 trials 次计时，报告 min/median/p95 以及 MB/s、GFLOP/s，
+// 结果以 text/CSV/JSON 格式输出，便于绘制强/弱扩展曲线。
+
+#define MAX_SWEEP 16
+
+typedef enum { FORMAT_TEXT, FORMAT_CSV, FORMAT_JSON } output_format_t;
+
+enum {
+    PHASE_INIT   = 1 << 0,
+    PHASE_WRITE  = 1 << 1,
+    PHASE_READ   = 1 << 2,
+    PHASE_VERIFY = 1 << 3,
+    PHASE_GEMM   = 1 << 4,
+    PHASE_MANY   = 1 << 5,
+    PHASE_APPEND = 1 << 6,
+    PHASE_EXPR   = 1 << 7,
+    PHASE_SPARSE = 1 << 8,
+    PHASE_ALL    = (1 << 9) - 1
+};
+
+// 基准测试的存储布局（--layout），下标即 bench_config_t.layouts 中的取值
+#define NUM_BENCH_LAYOUTS 4
+static const char *const bench_layout_names[NUM_BENCH_LAYOUTS] = {"contiguous", "chunked", "tiled", "sharded"};
+
+typedef struct {
+    int sizes[MAX_SWEEP], n_sizes;
+    int datasets[MAX_SWEEP], n_datasets;
+    int threads[MAX_SWEEP], n_threads;
+    int chunks[MAX_SWEEP], n_chunks;
+    int layouts[NUM_BENCH_LAYOUTS], n_layouts;  // bench_layout_names 下标：contiguous, chunked, tiled, sharded
+    int shards;                     // sharded 布局的分片数，0 表示线程数
+    shard_mode_t shard_mode;
+    int tile[2];                    // tiled 布局的分块形状（行 x 列）
+    int many[MAX_SWEEP], n_many;    // 海量小数据集阶段的数据集数量
+    int many_size;                  // 海量小数据集的矩阵维度
+    unsigned profiles;              // 海量小数据集阶段测试的文件配置（file_profiles 下标位掩码）
+    unsigned precisions;            // contiguous 布局读写阶段的存储精度（storage_precision_t 位掩码）
+    int append_batches[MAX_SWEEP], n_append_batches;  // 追加阶段的刷新批大小（行）
+    double densities[MAX_SWEEP]; int n_densities;     // 稀疏阶段的非零密度
+    vfd_mode_t vfds[VFD_COUNT]; int n_vfds;           // 读写阶段依次测试的文件驱动，其他阶段使用第一个
+    unsigned queue_depth;           // uring 驱动的在途请求数上限
+    const char *tail;               // 非 NULL 时作为 SWMR 追踪读取方运行（--tail）
+    long tail_rows;                 // 追踪读取方期望的最终行数，0 表示等到不再增长
+    int warmup, trials;
+    unsigned phases;
+    int bench;                      // 0 = 演示模式，1 = 基准测试模式
+    int bind;                       // 线程绑定：-1 不绑定，0 = close，1 = spread
+    int lazy_zero;                  // 1 = 缓冲池惰性清零
+    int tasks;                      // 1 = 并行变体使用 (数据集, 行块) 任务调度
+    int cache_mb;                   // 区域读取瓦片缓存预算 (MB)
+    const char *trace;              // trace JSON 输出文件，NULL 表示不埋点
+    output_format_t format;
+    const char *output;             // 结果输出文件，NULL 表示 stdout
+} bench_config_t;
+
+// 一组参数下的一个计时结果
+typedef struct {
+    const char *phase, *variant, *layout, *precision;
+    int size, datasets, threads, chunk, trials;
+    double min, median, p95;
+    double mb_per_s, gflop_per_s;   // 基于中位数
+    double peak_rss_mb;             // 该记录结束时的进程峰值常驻内存
+    double minor_faults, major_faults;  // 每次计时运行的平均缺页次数
+    double datasets_per_s;          // 基于中位数，仅海量小数据集阶段
+    double rows_per_s;              // 基于中位数，仅追加阶段
+    double max_err;                 // 读回数据相对源矩阵的最大绝对误差，仅读阶段与表达式阶段
+    double bytes_per_elem;          // 每个结果元素搬运的字节数，仅表达式阶段
+    double density;                 // 稀疏矩阵的非零密度，仅稀疏阶段
+    const char *vfd;                // 文件驱动（vfd_names），计算阶段为 "-"
+} bench_record_t;
+
+// 解析 [min, max] 区间内的十进制整数，整个参数必须是一个数字，出错返回 -1
+static int parse_long(const char *arg, long min, long max, long *value) {
+    char *end;
+    errno = 0;
+    long v = strtol(arg, &end, 10);
+    if (end == arg || *end || errno == ERANGE || v < min || v > max)
+        return -1;
+    *value = v;
+    return 0;
+}
+
+// 解析逗号分隔的正整数列表，返回个数；超过 max 个值或出错返回 -1
+static int parse_int_list(const char *arg, int *values, int max) {
+    int count = 0;
+    const char *p = arg;
+    while (*p) {
+        char *end;
+        errno = 0;
+        long v = strtol(p, &end, 10);
+        if (end == p || v <= 0 || v > INT_MAX || errno == ERANGE || count == max)
+            return -1;
+        values[count++] = (int)v;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',')
+            return -1;
+    }
+    return count;
+}
+
+// 解析逗号分隔的 (0, 1] 区间小数列表，返回个数；超过 max 个值或出错返回 -1
+static int parse_double_list(const char *arg, double *values, int max) {
+    int count = 0;
+    const char *p = arg;
+    while (*p) {
+        char *end;
+        double v = strtod(p, &end);
+        if (end == p || !(v > 0.0 && v <= 1.0) || count == max)
+            return -1;
+        values[count++] = v;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',')
+            return -1;
+    }
+    return count;
+}
+
+// 解析 "RxC" 形式的分块形状，单个数字表示方形分块
+static int parse_tile(const char *arg, int tile[2]) {
+    char *end;
+    long r = strtol(arg, &end, 10), c = r;
+    if (end == arg || r <= 0)
+        return -1;
+    if (*end == 'x' || *end == 'X') {
+        const char *p = end + 1;
+        c = strtol(p, &end, 10);
+        if (end == p || c <= 0)
+            return -1;
+    }
+    if (*end)
+        return -1;
+    tile[0] = (int)r;
+    tile[1] = (int)c;
+    return 0;
+}
+
+// 解析逗号分隔的文件配置名称，返回 file_profiles 下标位掩码，出错返回 0
+static unsigned parse_profiles(const char *arg) {
+    unsigned profiles = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        unsigned bit = 0;
+        for (int i = 0; i < NUM_FILE_PROFILES; i++)
+            if (strcmp(tok, file_profiles[i].name) == 0)
+                bit = 1u << i;
+        if (!bit)
+            return 0;
+        profiles |= bit;
+    }
+    return profiles;
+}
+
+// 解析逗号分隔的存储布局名称（按给出的顺序），返回个数，出错返回 -1
+static int parse_layouts(const char *arg, int *layouts) {
+    int count = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        int layout = -1;
+        for (int i = 0; i < NUM_BENCH_LAYOUTS; i++)
+            if (strcmp(tok, bench_layout_names[i]) == 0)
+                layout = i;
+        if (layout < 0 || count == NUM_BENCH_LAYOUTS)
+            return -1;
+        layouts[count++] = layout;
+    }
+    return count;
+}
+
+// 解析逗号分隔的文件驱动名称（按给出的顺序），返回个数，出错返回 -1
+static int parse_vfds(const char *arg, vfd_mode_t *vfds) {
+    int count = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        int mode = -1;
+        for (int i = 0; i < VFD_COUNT; i++)
+            if (strcmp(tok, vfd_names[i]) == 0)
+                mode = i;
+        if (mode < 0 || count == VFD_COUNT)
+            return -1;
+        vfds[count++] = (vfd_mode_t)mode;
+    }
+    return count;
+}
+
+// 解析逗号分隔的存储精度名称，返回 storage_precision_t 位掩码，出错返回 0
+static unsigned parse_precisions(const char *arg) {
+    unsigned precisions = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        unsigned bit = 0;
+        for (int i = 0; i < PRECISION_COUNT; i++)
+            if (strcmp(tok, precision_info[i].name) == 0)
+                bit = 1u << i;
+        if (!bit)
+            return 0;
+        precisions |= bit;
+    }
+    return precisions;
+}
+
+static unsigned parse_phases(const char *arg) {
+    static const struct { const char *name; unsigned bit; } names[] = {
+        {"init", PHASE_INIT}, {"write", PHASE_WRITE}, {"read", PHASE_READ},
+        {"verify", PHASE_VERIFY}, {"gemm", PHASE_GEMM}, {"many", PHASE_MANY},
+        {"append", PHASE_APPEND}, {"expr", PHASE_EXPR}, {"sparse", PHASE_SPARSE},
+        {"all", PHASE_ALL}
+    };
+    unsigned phases = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        unsigned bit = 0;
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+            if (strcmp(tok, names[i].name) == 0)
+                bit = names[i].bit;
+        if (!bit)
+            return 0;
+        phases |= bit;
+    }
+    return phases;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --bench                 run the benchmark harness instead of the demo\n");
+    printf("  --size N[,N...]         matrix dimension (default %d)\n", MATRIX_SIZE);
+    printf("  --datasets N[,N...]     number of datasets (default %d)\n", NUM_DATASETS);
+    printf("  --threads N[,N...]      OpenMP thread counts (default: omp_get_max_threads)\n");
+    printf("  --chunk N[,N...]        rows per read block / chunk edge (default %d)\n", CHUNK_SIZE);
+    printf("  --layout L[,L...]       contiguous, chunked, tiled and/or sharded (default contiguous)\n");
+    printf("  --shards N              shard files of the sharded layout (default: thread count)\n");
+    printf("  --shard-mode M          sharded writers: threads or processes (default processes)\n");
+    printf("  --many N[,N...]         number of small datasets in the many phase (default %d)\n", MANY_DATASET_COUNT);
+    printf("  --many-size N           dimension of each small dataset (default %d)\n", MANY_DATASET_SIZE);
+    printf("  --profile P[,P...]      file profiles for the many phase: default, many, many-latest (default all)\n");
+    printf("  --precision P[,P...]    on-disk precision for contiguous write/read: f64, f32, f16, bf16 (default f64)\n");
+    printf("  --append-batch N[,N...] flush batch sizes (rows) for the append phase (default %d)\n", APPEND_BATCH_ROWS);
+    printf("  --density D[,D...]      nonzero densities for the sparse phase (default %g)\n", CSR_DENSITY);
+    printf("  --vfd V[,V...]          file drivers for write/read: sec2, uring, uring-direct (default sec2)\n");
+    printf("  --queue-depth N         requests in flight for the uring drivers (default %d)\n", URING_QUEUE_DEPTH);
+    printf("  --tail FILE             follow an appending file as a SWMR reader and exit\n");
+    printf("  --tail-rows N           rows the SWMR reader waits for (default: until growth stops)\n");
+    printf("  --tile RxC              tile shape of the tiled layout (default %dx%d)\n", TILE_ROWS, TILE_COLS);
+    printf("  --phases P[,P...]       init,write,read,verify,gemm,many,append,expr,sparse or all (default all)\n");
+    printf("  --warmup N              untimed warmup runs per phase (default 1)\n");
+    printf("  --trials N              timed runs per phase (default 5)\n");
+    printf("  --format text|csv|json  result format (default text)\n");
+    printf("  --output FILE           write results to FILE instead of stdout\n");
+    printf("  --bind close|spread     pin OpenMP threads to CPUs (default: no pinning)\n");
+    printf("  --scheduler loop|task   parallel init/write/read/verify as parallel-for loops or (dataset, block) tasks (default loop)\n");
+    printf("  --lazy-zero             clear pooled buffers by dropping pages instead of memset\n");
+    printf("  --cache-mb N            tile cache budget for region reads (default %d)\n", TILE_CACHE_BUDGET_MB);
+    printf("  --trace FILE            record spans and write a Chrome/Perfetto trace JSON\n");
+}
+
+/**
+ * 解析命令行参数
+ * 未指定的参数使用编译期默认值（MATRIX_SIZE、NUM_DATASETS、CHUNK_SIZE）
+ *
+ * @return 0 成功，1 已打印帮助，-1 参数错误
+ */
+int parse_bench_config(int argc, char **argv, bench_config_t *cfg) {
+    static const struct option long_opts[] = {
+        {"bench",    no_argument,       NULL, 'b'},
+        {"size",     required_argument, NULL, 's'},
+        {"datasets", required_argument, NULL, 'd'},
+        {"threads",  required_argument, NULL, 't'},
+        {"chunk",    required_argument, NULL, 'c'},
+        {"layout",   required_argument, NULL, 'l'},
+        {"phases",   required_argument, NULL, 'p'},
+        {"warmup",   required_argument, NULL, 'w'},
+        {"trials",   required_argument, NULL, 'n'},
+        {"format",   required_argument, NULL, 'f'},
+        {"output",   required_argument, NULL, 'o'},
+        {"bind",     required_argument, NULL, 'B'},
+        {"lazy-zero", no_argument,      NULL, 'z'},
+        {"scheduler", required_argument, NULL, 'K'},
+        {"shards",   required_argument, NULL, 'H'},
+        {"shard-mode", required_argument, NULL, 'D'},
+        {"cache-mb", required_argument, NULL, 'm'},
+        {"trace",    required_argument, NULL, 'T'},
+        {"tile",     required_argument, NULL, 'x'},
+        {"many",     required_argument, NULL, 'M'},
+        {"many-size", required_argument, NULL, 'S'},
+        {"profile",  required_argument, NULL, 'P'},
+        {"precision", required_argument, NULL, 'F'},
+        {"append-batch", required_argument, NULL, 'A'},
+        {"density",  required_argument, NULL, 'Y'},
+        {"vfd",      required_argument, NULL, 'V'},
+        {"queue-depth", required_argument, NULL, 'Q'},
+        {"tail",     required_argument, NULL, 'L'},
+        {"tail-rows", required_argument, NULL, 'R'},
+        {"help",     no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->sizes[0] = MATRIX_SIZE;     cfg->n_sizes = 1;
+    cfg->datasets[0] = NUM_DATASETS; cfg->n_datasets = 1;
+    cfg->threads[0] = omp_get_max_threads(); cfg->n_threads = 1;
+    cfg->chunks[0] = CHUNK_SIZE;     cfg->n_chunks = 1;
+    cfg->layouts[0] = 0;             cfg->n_layouts = 1;
+    cfg->warmup = 1;
+    cfg->trials = 5;
+    cfg->phases = PHASE_ALL;
+    cfg->format = FORMAT_TEXT;
+    cfg->bind = -1;
+    cfg->cache_mb = TILE_CACHE_BUDGET_MB;
+    cfg->tile[0] = TILE_ROWS;
+    cfg->tile[1] = TILE_COLS;
+    cfg->many[0] = MANY_DATASET_COUNT; cfg->n_many = 1;
+    cfg->many_size = MANY_DATASET_SIZE;
+    cfg->profiles = (1u << NUM_FILE_PROFILES) - 1;
+    cfg->precisions = 1u << PRECISION_F64;
+    cfg->append_batches[0] = APPEND_BATCH_ROWS; cfg->n_append_batches = 1;
+    cfg->densities[0] = CSR_DENSITY; cfg->n_densities = 1;
+    cfg->vfds[0] = VFD_SEC2;         cfg->n_vfds = 1;
+    cfg->queue_depth = URING_QUEUE_DEPTH;
+    cfg->shard_mode = SHARD_PROCESSES;
+
+    int opt, count;
+    long num;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'b': cfg->bench = 1; break;
+        case 's': if ((count = parse_int_list(optarg, cfg->sizes, MAX_SWEEP)) < 1) goto bad; cfg->n_sizes = count; break;
+        case 'd': if ((count = parse_int_list(optarg, cfg->datasets, MAX_SWEEP)) < 1) goto bad; cfg->n_datasets = count; break;
+        case 't': if ((count = parse_int_list(optarg, cfg->threads, MAX_SWEEP)) < 1) goto bad; cfg->n_threads = count; break;
+        case 'c': if ((count = parse_int_list(optarg, cfg->chunks, MAX_SWEEP)) < 1) goto bad; cfg->n_chunks = count; break;
+        case 'l': if ((count = parse_layouts(optarg, cfg->layouts)) < 1) goto bad; cfg->n_layouts = count; break;
+        case 'p': if (!(cfg->phases = parse_phases(optarg))) goto bad; break;
+        case 'w': if (parse_long(optarg, 0, INT_MAX, &num) < 0) goto bad; cfg->warmup = (int)num; break;
+        case 'n': if (parse_long(optarg, 1, INT_MAX, &num) < 0) goto bad; cfg->trials = (int)num; break;
+        case 'f':
+            if (strcmp(optarg, "text") == 0) cfg->format = FORMAT_TEXT;
+            else if (strcmp(optarg, "csv") == 0) cfg->format = FORMAT_CSV;
+            else if (strcmp(optarg, "json") == 0) cfg->format = FORMAT_JSON;
+            else goto bad;
+            break;
+        case 'o': cfg->output = optarg; break;
+        case 'B':
+            if (strcmp(optarg, "close") == 0) cfg->bind = 0;
+            else if (strcmp(optarg, "spread") == 0) cfg->bind = 1;
+            else goto bad;
+            break;
+        case 'z': cfg->lazy_zero = 1; break;
+        case 'H': if (parse_long(optarg, 0, INT_MAX, &num) < 0) goto bad; cfg->shards = (int)num; break;
+        case 'D':
+            if (strcmp(optarg, "threads") == 0) cfg->shard_mode = SHARD_THREADS;
+            else if (strcmp(optarg, "processes") == 0) cfg->shard_mode = SHARD_PROCESSES;
+            else goto bad;
+            break;
+        case 'K':
+            if (strcmp(optarg, "loop") == 0) cfg->tasks = 0;
+            else if (strcmp(optarg, "task") == 0) cfg->tasks = 1;
+            else goto bad;
+            break;
+        case 'T': cfg->trace = optarg; break;
+        case 'M': if ((count = parse_int_list(optarg, cfg->many, MAX_SWEEP)) < 1) goto bad; cfg->n_many = count; break;
+        case 'S': if (parse_long(optarg, 1, INT_MAX, &num) < 0) goto bad; cfg->many_size = (int)num; break;
+        case 'P': if (!(cfg->profiles = parse_profiles(optarg))) goto bad; break;
+        case 'F': if (!(cfg->precisions = parse_precisions(optarg))) goto bad; break;
+        case 'A':
+            if ((count = parse_int_list(optarg, cfg->append_batches, MAX_SWEEP)) < 1) goto bad;
+            cfg->n_append_batches = count;
+            break;
+        case 'Y':
+            if ((count = parse_double_list(optarg, cfg->densities, MAX_SWEEP)) < 1) goto bad;
+            cfg->n_densities = count;
+            break;
+        case 'V': if ((count = parse_vfds(optarg, cfg->vfds)) < 1) goto bad; cfg->n_vfds = count; break;
+        case 'Q':
+            if (parse_long(optarg, 1, URING_MAX_QUEUE_DEPTH, &num) < 0) goto bad;
+            cfg->queue_depth = (unsigned)num;
+            break;
+        case 'L': cfg->tail = optarg; break;
+        case 'R': if (parse_long(optarg, 0, LONG_MAX, &cfg->tail_rows) < 0) goto bad; break;
+        case 'x': if (parse_tile(optarg, cfg->tile) < 0) goto bad; break;
+        case 'm': if (parse_long(optarg, 0, INT_MAX, &num) < 0) goto bad; cfg->cache_mb = (int)num; break;
+        case 'h': print_usage(argv[0]); return 1;
+        default: goto bad;
+        }
+    }
+    return 0;
+
+bad:
+    print_usage(argv[0]);
+    return -1;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// 对排序后的计时结果取 min / median / p95（最近秩法）
+static void summarize_times(double *times, int trials, bench_record_t *rec) {
+    qsort(times, trials, sizeof(double), compare_double);
+    rec->min = times[0];
+    rec->median = trials % 2 ? times[trials / 2] : 0.5 * (times[trials / 2 - 1] + times[trials / 2]);
+    int p95 = (int)ceil(0.95 * trials) - 1;
+    rec->p95 = times[p95 < 0 ? 0 : p95];
+}
+
+static void emit_record(FILE *out, output_format_t format, const bench_record_t *r, int first) {
+    switch (format) {
+    case FORMAT_CSV:
+        if (first)
+            fprintf(out, "phase,variant,layout,precision,size,datasets,threads,chunk,trials,"
+                         "min_s,median_s,p95_s,mb_per_s,gflop_per_s,peak_rss_mb,minor_faults,major_faults,"
+                         "datasets_per_s,rows_per_s,max_err,bytes_per_elem,density,vfd\n");
+        fprintf(out, "%s,%s,%s,%s,%d,%d,%d,%d,%d,%.6f,%.6f,%.6f,%.2f,%.2f,%.1f,%.0f,%.0f,%.1f,%.1f,%.3e,%.1f,%g,%s\n",
+                r->phase, r->variant, r->layout, r->precision, r->size, r->datasets, r->threads, r->chunk,
+                r->trials, r->min, r->median, r->p95, r->mb_per_s, r->gflop_per_s,
+                r->peak_rss_mb, r->minor_faults, r->major_faults, r->datasets_per_s, r->rows_per_s, r->max_err,
+                r->bytes_per_elem, r->density, r->vfd);
+        break;
+    case FORMAT_JSON:
+        fprintf(out, "%s  {\"phase\": \"%s\", \"variant\": \"%s\", \"layout\": \"%s\", "
+                     "\"precision\": \"%s\", \"size\": %d, \"datasets\": %d, \"threads\": %d, \"chunk\": %d, \"trials\": %d, "
+                     "\"min_s\": %.6f, \"median_s\": %.6f, \"p95_s\": %.6f, "
+                     "\"mb_per_s\": %.2f, \"gflop_per_s\": %.2f, \"peak_rss_mb\": %.1f, "
+                     "\"minor_faults\": %.0f, \"major_faults\": %.0f, \"datasets_per_s\": %.1f, "
+                     "\"rows_per_s\": %.1f, \"max_err\": %.3e, \"bytes_per_elem\": %.1f, \"density\": %g, \"vfd\": \"%s\"}",
+                first ? "[\n" : ",\n", r->phase, r->variant, r->layout, r->precision, r->size, r->datasets,
+                r->threads, r->chunk, r->trials, r->min, r->median, r->p95,
+                r->mb_per_s, r->gflop_per_s, r->peak_rss_mb, r->minor_faults, r->major_faults,
+                r->datasets_per_s, r->rows_per_s, r->max_err, r->bytes_per_elem, r->density, r->vfd);
+        break;
+    case FORMAT_TEXT:
+        if (first)
+            fprintf(out, "%-8s %-9s %-10s %-5s %6s %6s %4s %6s %10s %10s %10s %10s %8s %9s %9s %7s %10s %10s %9s %7s %7s %-12s\n",
+                    "phase", "variant", "layout", "prec", "size", "ds", "thr", "chunk",
+                    "min(s)", "median(s)", "p95(s)", "MB/s", "GFLOP/s", "RSS(MB)", "minflt", "majflt", "ds/s",
+                    "rows/s", "max_err", "B/elem", "density", "vfd");
+        fprintf(out, "%-8s %-9s %-10s %-5s %6d %6d %4d %6d %10.4f %10.4f %10.4f %10.2f %8.2f %9.1f %9.0f %7.0f %10.0f "
+                     "%10.0f %9.2e %7.1f %7g %-12s\n",
+                r->phase, r->variant, r->layout, r->precision, r->size, r->datasets, r->threads, r->chunk,
+                r->min, r->median, r->p95, r->mb_per_s, r->gflop_per_s,
+                r->peak_rss_mb, r->minor_faults, r->major_faults, r->datasets_per_s, r->rows_per_s, r->max_err,
+                r->bytes_per_elem, r->density, r->vfd);
+        break;
+    }
+    fflush(out);
+}
+
+// 一组参数下单次运行所需的上下文
+typedef struct {
+    int n, datasets, chunk, layout;
+    double **matrices, **copies;
+    const hdf5_layout_t *lay;
+    storage_precision_t precision;  // 仅 contiguous 布局的读写阶段使用
+    int tasks;                      // 并行变体使用任务调度（读写阶段仅 contiguous f64）
+    int shards;                     // sharded 布局
+    shard_mode_t shard_mode;
+} bench_ctx_t;
+
+// 该阶段的并行变体是否走任务调度
+static int bench_uses_tasks(const bench_ctx_t *c, unsigned phase) {
+    if (!c->tasks)
+        return 0;
+    if (phase == PHASE_WRITE || phase == PHASE_READ)
+        return !c->layout && c->precision == PRECISION_F64;
+    return phase == PHASE_INIT || phase == PHASE_VERIFY;
+}
+
+// 执行一次阶段变体，耗时（秒）写入 *elapsed
+// @return 0 成功，-1 阶段失败（文件缺失、读写出错等），此时耗时无意义
+static int run_phase_once(const bench_ctx_t *c, unsigned phase, int parallel, double *elapsed) {
+    double t0 = omp_get_wtime();
+    int ret = 0;
+    switch (phase) {
+    case PHASE_INIT:
+        if (parallel && bench_uses_tasks(c, phase)) {
+            task_init_matrices(c->matrices, c->n, c->datasets, c->chunk, NULL);
+            break;
+        }
+        for (int i = 0; i < c->datasets; i++) {
+            if (parallel) init_matrix_parallel(c->matrices[i], c->n, i);
+            else init_matrix_serial(c->copies[i], c->n, i);
+        }
+        break;
+    case PHASE_WRITE:
+        if (!parallel && c->precision != PRECISION_F64)
+            ret = serial_write_hdf5_precision("bench_serial.h5", c->matrices, c->n, c->datasets, c->precision);
+        else if (!parallel)
+            ret = serial_write_hdf5_layout("bench_serial.h5", c->matrices, c->n, c->datasets,
+                                           c->layout == 1 || c->layout == 2 ? c->lay : NULL);
+        else if (c->layout == 3)
+            ret = sharded_write_hdf5("bench_parallel.h5", c->matrices, c->n, c->datasets, c->shards, c->chunk,
+                                     c->shard_mode, NULL);
+        else if (bench_uses_tasks(c, phase))
+            ret = task_write_hdf5("bench_parallel.h5", c->matrices, c->n, c->datasets, c->chunk, NULL);
+        else if (c->precision != PRECISION_F64)
+            ret = parallel_write_hdf5_precision("bench_parallel.h5", c->matrices, c->n, c->datasets, c->chunk,
+                                                c->precision, NULL);
+        else if (c->layout)
+            ret = parallel_write_hdf5_compressed("bench_parallel.h5", c->matrices, c->n, c->datasets, c->lay, NULL);
+        else
+            ret = parallel_write_hdf5("bench_parallel.h5", c->matrices, c->n, c->datasets);
+        break;
+    case PHASE_READ:
+        if (!parallel)
+            ret = serial_read_hdf5("bench_serial.h5", c->copies, c->n, c->datasets);
+        else if (bench_uses_tasks(c, phase))
+            ret = task_read_hdf5("bench_parallel.h5", c->copies, c->n, c->datasets, c->chunk, NULL, NULL);
+        else if (c->precision != PRECISION_F64)
+            ret = parallel_read_hdf5_precision("bench_parallel.h5", c->copies, c->n, c->datasets, c->chunk,
+                                               NULL, NULL, NULL);
+        else if (c->layout == 1 || c->layout == 2)
+            ret = parallel_read_hdf5_chunks("bench_parallel.h5", c->copies, c->n, c->datasets, NULL);
+        else
+            ret = parallel_read_hdf5("bench_parallel.h5", c->copies, c->n, c->datasets, c->chunk);
+        break;
+    case PHASE_VERIFY:
+        if (bench_uses_tasks(c, phase)) {
+            matrix_checksum_t sums[c->datasets];
+            ret = task_checksum_matrices(c->copies, c->n, c->datasets, c->chunk, sums, NULL);
+            break;
+        }
+        for (int i = 0; i < c->datasets; i++)
+            verify_matrix(c->copies[i], c->n);
+        break;
+    case PHASE_GEMM:
+        matrix_multiply_parallel(c->matrices[0], c->matrices[c->datasets > 1 ? 1 : 0], c->copies[0], c->n);
+        break;
+    }
+    *elapsed = omp_get_wtime() - t0;
+    return ret < 0 ? -1 : 0;
+}
+
+/**
+ * 海量小数据集阶段：每种数据集数量与文件配置各运行 warmup + trials 次写入/读取，
+ * 分别输出 create / write / open / read 四条记录（datasets/s 基于 I/O 线程上的累计耗时）
+ *
+ * @return 0 成功，-1 失败
+ */
+static int run_many_benchmark(const bench_config_t *cfg, FILE *out, int *first) {
+    static const char *names[4] = {"create", "write", "open", "read"};
+    int n = cfg->many_size, ret = 0;
+    double *times[4];
+    for (int p = 0; p < 4; p++)
+        times[p] = (double*)malloc(cfg->trials * sizeof(double));
+    omp_set_num_threads(cfg->threads[0]);
+
+    for (int mi = 0; mi < cfg->n_many; mi++)
+    for (int pi = 0; pi < NUM_FILE_PROFILES; pi++) {
+        const hdf5_file_profile_t *profile = &file_profiles[pi];
+        int count = cfg->many[mi];
+        mem_usage_t mem0, mem1;
+        if (!(cfg->profiles & (1u << pi)) || !times[0] || !times[1] || !times[2] || !times[3])
+            continue;
+        for (int t = -cfg->warmup; t < cfg->trials; t++) {
+            many_stats_t ws, rs;
+            if (t == 0)
+                get_mem_usage(&mem0);
+            if (many_write_hdf5("bench_many.h5", count, n, profile, &ws) < 0 ||
+                many_read_hdf5("bench_many.h5", n, profile, &rs) < 0 || rs.mismatched) {
+                printf("Error: Many-datasets run failed (profile %s)\n", profile->name);
+                ret = -1;
+                break;
+            }
+            if (t >= 0) {
+                times[0][t] = ws.create_time;
+                times[1][t] = ws.write_time;
+                times[2][t] = rs.open_time;
+                times[3][t] = rs.read_time;
+            }
+        }
+        if (ret < 0)
+            break;
+        get_mem_usage(&mem1);
+        for (int p = 0; p < 4; p++) {
+            bench_record_t rec = {names[p], profile->name, "many", "f64", n, count, cfg->threads[0],
+                                  profile->batch, cfg->trials, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                  mem1.peak_rss_kb / 1024.0,
+                                  (double)(mem1.minor_faults - mem0.minor_faults) / cfg->trials,
+                                  (double)(mem1.major_faults - mem0.major_faults) / cfg->trials, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                  vfd_names[file_vfd]};
+            summarize_times(times[p], cfg->trials, &rec);
+            rec.mb_per_s = (double)count * n * n * sizeof(double) / (1024 * 1024) / rec.median;
+            rec.datasets_per_s = count / rec.median;
+            emit_record(out, cfg->format, &rec, *first);
+            *first = 0;
+        }
+    }
+    for (int p = 0; p < 4; p++)
+        free(times[p]);
+    return ret;
+}
+
+/**
+ * 追加阶段：每种线程数与刷新批大小各运行 warmup + trials 次并行追加（合并缓冲区）与串行追加，
+ * 输出 rows/s；最后一次并行追加的文件做与顺序无关的校验
+ *
+ * @return 0 成功，-1 失败
+ */
+static int run_append_benchmark(const bench_config_t *cfg, FILE *out, int *first,
+                                double **matrices, int n, int datasets, double *times) {
+    for (int ti = 0; ti < cfg->n_threads; ti++)
+    for (int bi = 0; bi < cfg->n_append_batches; bi++) {
+        int batch = cfg->append_batches[bi] < 1 ? 1 : cfg->append_batches[bi];
+        omp_set_num_threads(cfg->threads[ti]);
+        if (cfg->bind >= 0)
+            pin_omp_threads(cfg->bind);
+        for (int variant = 1; variant >= 0; variant--) {
+            mem_usage_t mem0, mem1;
+            for (int t = -cfg->warmup; t < cfg->trials; t++) {
+                append_stats_t st;
+                if (t == 0)
+                    get_mem_usage(&mem0);
+                if ((variant ? parallel_append_hdf5("bench_append.h5", matrices, n, datasets, batch, 0, &st)
+                             : serial_append_hdf5("bench_append.h5", matrices, n, datasets, batch, &st)) < 0)
+                    return -1;
+                if (t >= 0)
+                    times[t] = st.total_time;
+            }
+            get_mem_usage(&mem1);
+            long mismatched = 0;
+            if (variant && (verify_append_hdf5("bench_append.h5", matrices, n, datasets, &mismatched) < 0 ||
+                            mismatched)) {
+                printf("Error: Appended rows do not match the source (%ld mismatched)\n", mismatched);
+                return -1;
+            }
+
+            bench_record_t rec = {"append", variant ? "parallel" : "serial", "extendible", "f64",
+                                  n, datasets, cfg->threads[ti], batch, cfg->trials,
+                                  0.0, 0.0, 0.0, 0.0, 0.0, mem1.peak_rss_kb / 1024.0,
+                                  (double)(mem1.minor_faults - mem0.minor_faults) / cfg->trials,
+                                  (double)(mem1.major_faults - mem0.major_faults) / cfg->trials, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                  vfd_names[file_vfd]};
+            summarize_times(times, cfg->trials, &rec);
+            rec.mb_per_s = (double)n * n * datasets * sizeof(double) / (1024 * 1024) / rec.median;
+            rec.rows_per_s = (double)n * datasets / rec.median;
+            emit_record(out, cfg->format, &rec, *first);
+            *first = 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 表达式阶段：把矩阵写入 bench_expr.h5 后，对每个演示表达式、线程数与行块大小各运行 warmup + trials 次
+ * 融合求值，逐算子求值只与线程数有关；layout 列为表达式名，chunk 列为行块行数，
+ * 输出每个结果元素搬运的字节数，并把最后一次结果与内存中直接计算的结果比对
+ *
+ * @return 0 成功，-1 失败
+ */
+static int run_expr_benchmark(const bench_config_t *cfg, FILE *out, int *first,
+                              double **matrices, double **copies, int n, int datasets, double *times) {
+    static const char *input_names[3] = {"/matrix_0", "/matrix_1", "/matrix_2"};
+    const double alpha = 2.5;
+    double *reference = matrix_alloc(n, n);
+    if (!reference) {
+        printf("Error: Failed to allocate expression reference buffer\n");
+        return -1;
+    }
+    if (parallel_write_hdf5("bench_expr.h5", matrices, n, datasets) < 0) {
+        matrix_free(reference, n, n);
+        return -1;
+    }
+    for (int ti = 0; ti < cfg->n_threads; ti++)
+    for (int x = 0; x < EXPR_DEMO_COUNT; x++) {
+        expr_t e;
+        int root = expr_build_demo(&e, (expr_demo_t)x, input_names[0], input_names[datasets > 1 ? 1 : 0],
+                                   input_names[datasets > 2 ? 2 : 0], alpha);
+        expr_reference_demo((expr_demo_t)x, matrices[0], matrices[datasets > 1 ? 1 : 0],
+                            matrices[datasets > 2 ? 2 : 0], n, alpha, reference);
+        omp_set_num_threads(cfg->threads[ti]);
+        if (cfg->bind >= 0)
+            pin_omp_threads(cfg->bind);
+        for (int ci = 0; ci <= cfg->n_chunks; ci++) {
+            // ci == n_chunks 时运行逐算子求值
+            int fused = ci < cfg->n_chunks;
+            int chunk = fused ? (cfg->chunks[ci] < n ? cfg->chunks[ci] : n) : n;
+            expr_stats_t st = {0};
+            mem_usage_t mem0, mem1;
+            for (int t = -cfg->warmup; t < cfg->trials; t++) {
+                if (t == 0)
+                    get_mem_usage(&mem0);
+                if ((fused ? expr_eval_hdf5("bench_expr.h5", &e, root, "/expr_result", chunk, &st)
+                           : expr_eval_unfused_hdf5("bench_expr.h5", &e, root, "/expr_result", &st)) < 0) {
+                    matrix_free(reference, n, n);
+                    return -1;
+                }
+                if (t >= 0)
+                    times[t] = st.total_time;
+            }
+            get_mem_usage(&mem1);
+
+            bench_record_t rec = {"expr", fused ? "fused" : "unfused", expr_demo_names[x], "f64",
+                                  n, datasets, cfg->threads[ti], chunk, cfg->trials,
+                                  0.0, 0.0, 0.0, 0.0, 0.0, mem1.peak_rss_kb / 1024.0,
+                                  (double)(mem1.minor_faults - mem0.minor_faults) / cfg->trials,
+                                  (double)(mem1.major_faults - mem0.major_faults) / cfg->trials, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                  vfd_names[file_vfd]};
+            summarize_times(times, cfg->trials, &rec);
+            rec.mb_per_s = (st.bytes_read + st.bytes_written) / (1024 * 1024) / rec.median;
+            rec.bytes_per_elem = st.bytes_moved / st.elements;
+            if (expr_read_result("bench_expr.h5", "/expr_result", copies[0], n, n) < 0) {
+                matrix_free(reference, n, n);
+                return -1;
+            }
+            for (size_t k = 0; k < (size_t)n * n; k++)
+                rec.max_err = fmax(rec.max_err, fabs(copies[0][k] - reference[k]));
+            emit_record(out, cfg->format, &rec, *first);
+            *first = 0;
+        }
+    }
+    matrix_free(reference, n, n);
+    return 0;
+}
+
+/**
+ * 稀疏阶段：每种线程数与密度下，把同一个稀疏矩阵分别以稠密（contiguous）和 CSR 形式测试
+ * write / read / spmv / spmm（spmm 右端为 n x SPMM_COLS 稠密矩阵），另测并行与串行的稠密 -> CSR 转换；
+ * MB/s 按各自的存储字节数计算，GFLOP/s 按各自实际执行的浮点运算数计算
+ *
+ * @return 0 成功，-1 失败
+ */
+static int run_sparse_benchmark(const bench_config_t *cfg, FILE *out, int *first,
+                                double **matrices, double **copies, int n, int datasets, double *times) {
+    enum { SP_CONVERT, SP_WRITE, SP_READ, SP_SPMV, SP_SPMM, SP_COUNT };
+    static const char *names[SP_COUNT] = {"convert", "write", "read", "spmv", "spmm"};
+    int k = n < SPMM_COLS ? n : SPMM_COLS, ret = 0;
+    double *x = (double*)malloc((size_t)n * sizeof(double));
+    double *y = (double*)malloc((size_t)n * sizeof(double));
+    double *C = matrix_alloc(n, k);
+    if (!x || !y || !C) {
+        printf("Error: Failed to allocate sparse benchmark buffers\n");
+        ret = -1;
+    }
+    if (ret == 0)
+        philox_fill_row(x, RNG_SEED, 0x7fffffffu, 0, n);
+
+    for (int ti = 0; ret == 0 && ti < cfg->n_threads; ti++)
+    for (int di = 0; ret == 0 && di < cfg->n_densities; di++) {
+        double density = cfg->densities[di];
+        csr_matrix_t csr;
+        omp_set_num_threads(cfg->threads[ti]);
+        if (cfg->bind >= 0)
+            pin_omp_threads(cfg->bind);
+        init_matrix_sparse(copies[0], n, 0, density);
+        if (dense_to_csr_parallel(copies[0], n, n, &csr) < 0) {
+            ret = -1;
+            break;
+        }
+        double dense_bytes = (double)n * n * sizeof(double), csr_bytes = csr_stored_bytes(&csr);
+        for (int phase = 0; ret == 0 && phase < SP_COUNT; phase++)
+        for (int variant = 0; ret == 0 && variant < 2; variant++) {
+            // variant 0 = 稠密 / 串行转换，1 = CSR / 并行转换
+            mem_usage_t mem0, mem1;
+            for (int t = -cfg->warmup; ret == 0 && t < cfg->trials; t++) {
+                csr_matrix_t tmp;
+                if (t == 0)
+                    get_mem_usage(&mem0);
+                double t0 = omp_get_wtime();
+                switch (phase) {
+                case SP_CONVERT:
+                    ret = (variant ? dense_to_csr_parallel : dense_to_csr_serial)(copies[0], n, n, &tmp);
+                    if (ret == 0)
+                        csr_free(&tmp);
+                    break;
+                case SP_WRITE:
+                    if (variant)
+                        ret = csr_write_hdf5("bench_sparse_csr.h5", &csr, 1, NULL);
+                    else
+                        ret = parallel_write_hdf5("bench_sparse_dense.h5", copies, n, 1);
+                    break;
+                case SP_READ:
+                    if (variant && (ret = csr_read_hdf5("bench_sparse_csr.h5", 0, &tmp, 0, NULL)) == 0) {
+                        if (!csr_equal(&csr, &tmp)) {
+                            printf("Error: CSR read back does not match\n");
+                            ret = -1;
+                        }
+                        csr_free(&tmp);
+                    } else if (!variant) {
+                        ret = parallel_read_hdf5("bench_sparse_dense.h5", &copies[datasets > 1 ? 1 : 0], n, 1,
+                                                 cfg->chunks[0]);
+                    }
+                    break;
+                case SP_SPMV:
+                    if (variant) spmv_csr_parallel(&csr, x, y);
+                    else dense_matvec_parallel(copies[0], n, n, x, y);
+                    break;
+                case SP_SPMM:
+                    if (variant) {
+                        spmm_csr_parallel(&csr, matrices[0], k, C);
+                    } else {
+                        matrix_zero(C, n, k);
+                        if (gemm_blocked(n, k, n, copies[0], n, matrices[0], k, C, k) < 0)
+                            ret = -1;
+                    }
+                    break;
+                }
+                if (t >= 0)
+                    times[t] = omp_get_wtime() - t0;
+            }
+            if (ret < 0)
+                break;
+            get_mem_usage(&mem1);
+
+            bench_record_t rec = {names[phase], phase == SP_CONVERT ? (variant ? "parallel" : "serial") : "parallel",
+                                  phase == SP_CONVERT || variant ? "csr" : "contiguous", "f64",
+                                  n, 1, cfg->threads[ti], phase == SP_SPMM ? k : cfg->chunks[0], cfg->trials,
+                                  0.0, 0.0, 0.0, 0.0, 0.0, mem1.peak_rss_kb / 1024.0,
+                                  (double)(mem1.minor_faults - mem0.minor_faults) / cfg->trials,
+                                  (double)(mem1.major_faults - mem0.major_faults) / cfg->trials, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                  vfd_names[file_vfd]};
+            summarize_times(times, cfg->trials, &rec);
+            rec.density = density;
+            double flops = phase == SP_SPMV ? 2.0 : phase == SP_SPMM ? 2.0 * k : 0.0;
+            flops *= phase == SP_CONVERT || variant ? (double)csr.nnz : (double)n * n;
+            rec.gflop_per_s = flops / 1e9 / rec.median;
+            rec.mb_per_s = (phase == SP_CONVERT ? dense_bytes : variant ? csr_bytes : dense_bytes) /
+                           (1024 * 1024) / rec.median;
+            emit_record(out, cfg->format, &rec, *first);
+            *first = 0;
+        }
+        csr_free(&csr);
+    }
+    free(x);
+    free(y);
+    matrix_free(C, n, k);
+    return ret;
+}
+
+/**
+ * 基准测试主循环：遍历所有参数组合与阶段，输出统计记录
+ *
+ * @return 0 成功，-1 失败
+ */
+int run_benchmark(const bench_config_t *cfg) {
+    static const struct { unsigned phase; const char *name; int has_serial; } phases[] = {
+        {PHASE_INIT, "init", 1}, {PHASE_WRITE, "write", 1}, {PHASE_READ, "read", 1},
+        {PHASE_VERIFY, "verify", 0}, {PHASE_GEMM, "gemm", 0}
+    };
+    FILE *out = cfg->output ? fopen(cfg->output, "w") : stdout;
+    if (!out) {
+        printf("Error: Failed to open output file %s\n", cfg->output);
+        return -1;
+    }
+    // 结果写到 stdout 时关闭进度输出，保证 CSV/JSON 可直接解析
+    if (out == stdout && cfg->format != FORMAT_TEXT)
+        verbose_progress = 0;
+
+    int first = 1, ret = 0;
+    double *times = (double*)malloc(cfg->trials * sizeof(double));
+    if (!times || set_file_driver(cfg->vfds[0], cfg->queue_depth) < 0 || hdf5_io_start() < 0) {
+        printf("Error: Failed to initialize benchmark\n");
+        free(times);
+        if (out != stdout) fclose(out);
+        return -1;
+    }
+
+    // 只测海量小数据集阶段时不需要分配大矩阵
+    for (int si = 0; si < cfg->n_sizes && (cfg->phases & ~PHASE_MANY); si++)
+    for (int di = 0; di < cfg->n_datasets; di++) {
+        int n = cfg->sizes[si], datasets = cfg->datasets[di];
+        size_t matrix_bytes = (size_t)n * n * sizeof(double);
+        double **matrices = (double**)calloc(datasets, sizeof(double*));
+        double **copies = (double**)calloc(datasets, sizeof(double*));
+        int ok = matrices && copies;
+        for (int i = 0; ok && i < datasets; i++) {
+            matrices[i] = matrix_alloc(n, n);
+            copies[i] = matrix_alloc(n, n);
+            ok = matrices[i] && copies[i];
+        }
+        if (!ok) {
+            printf("Error: Failed to allocate %d %dx%d matrices\n", datasets, n, n);
+            ret = -1;
+        }
+        for (int i = 0; ok && i < datasets; i++)
+            init_matrix_parallel(matrices[i], n, i);
+
+        for (int ti = 0; ok && ti < cfg->n_threads; ti++)
+        for (int ci = 0; ci < cfg->n_chunks; ci++)
+        for (int li = 0; li < cfg->n_layouts; li++)
+        for (int pi = 0; pi < PRECISION_COUNT; pi++)
+        for (int vi = 0; vi < cfg->n_vfds; vi++) {
+            // 存储精度只作用于 contiguous 布局，其他布局总是 f64
+            if (cfg->layouts[li] != 0 ? pi != PRECISION_F64 : !(cfg->precisions & (1u << pi)))
+                continue;
+            if (set_file_driver(cfg->vfds[vi], cfg->queue_depth) < 0) {
+                ret = -1;
+                continue;
+            }
+            int first_precision = cfg->layouts[li] != 0 || !(cfg->precisions & ((1u << pi) - 1));
+            int chunk = cfg->chunks[ci] < n ? cfg->chunks[ci] : n;
+            hdf5_layout_t lay = {1, {chunk, chunk}, USE_SHUFFLE, DEFLATE_LEVEL, 0, 0};
+            // tiled：不压缩的 Z-order 分块，同一遍写出转置副本和分块索引
+            if (cfg->layouts[li] == 2)
+                lay = (hdf5_layout_t){1, {cfg->tile[0] < n ? cfg->tile[0] : n, cfg->tile[1] < n ? cfg->tile[1] : n},
+                                      0, 0, 1, 1};
+            bench_ctx_t ctx = {n, datasets, chunk, cfg->layouts[li], matrices, copies, &lay,
+                               (storage_precision_t)pi, cfg->tasks, cfg->shards, cfg->shard_mode};
+            omp_set_num_threads(cfg->threads[ti]);
+            if (cfg->bind >= 0)
+                pin_omp_threads(cfg->bind);
+
+            for (size_t p = 0; p < sizeof(phases) / sizeof(phases[0]); p++) {
+                int io_phase = phases[p].phase == PHASE_WRITE || phases[p].phase == PHASE_READ;
+                if (!(cfg->phases & phases[p].phase))
+                    continue;
+                // 计算阶段与存储布局、分块大小、存储精度、文件驱动无关，只测一次
+                if (!io_phase && (ci > 0 || li > 0 || vi > 0 || !first_precision))
+                    continue;
+                for (int variant = 1; variant >= (phases[p].has_serial ? 0 : 1); variant--) {
+                    // 读阶段依赖对应写阶段生成的文件；任何一次运行失败时丢弃该记录，整体以非零状态退出
+                    double elapsed;
+                    int failed = phases[p].phase == PHASE_READ && !(cfg->phases & PHASE_WRITE) &&
+                                 run_phase_once(&ctx, PHASE_WRITE, variant, &elapsed) < 0;
+                    for (int w = 0; !failed && w < cfg->warmup; w++)
+                        failed = run_phase_once(&ctx, phases[p].phase, variant, &elapsed) < 0;
+                    mem_usage_t mem0, mem1;
+                    get_mem_usage(&mem0);
+                    for (int t = 0; !failed && t < cfg->trials; t++)
+                        failed = run_phase_once(&ctx, phases[p].phase, variant, &times[t]) < 0;
+                    get_mem_usage(&mem1);
+                    if (failed) {
+                        printf("Error: Phase %s (%s, %s, %s) failed, record dropped\n", phases[p].name,
+                               variant ? "parallel" : "serial", bench_layout_names[ctx.layout], vfd_names[cfg->vfds[vi]]);
+                        ret = -1;
+                        continue;
+                    }
+
+                    bench_record_t rec = {phases[p].name,
+                                          !variant ? "serial" : bench_uses_tasks(&ctx, phases[p].phase) ? "task" : "parallel",
+                                          !io_phase ? "-" : bench_layout_names[ctx.layout],
+                                          !io_phase ? "-" : precision_info[ctx.precision].name, n, datasets, cfg->threads[ti], chunk, cfg->trials,
+                                          0.0, 0.0, 0.0, 0.0, 0.0, mem1.peak_rss_kb / 1024.0,
+                                          (double)(mem1.minor_faults - mem0.minor_faults) / cfg->trials,
+                                          (double)(mem1.major_faults - mem0.major_faults) / cfg->trials, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                          !io_phase ? "-" : vfd_names[cfg->vfds[vi]]};
+                    summarize_times(times, cfg->trials, &rec);
+                    for (int i = 0; phases[p].phase == PHASE_READ && i < datasets; i++)
+                        for (size_t k = 0; k < (size_t)n * n; k++)
+                            rec.max_err = fmax(rec.max_err, fabs(copies[i][k] - matrices[i][k]));
+                    double mb = (double)matrix_bytes * datasets / (1024 * 1024);
+                    if (phases[p].phase == PHASE_GEMM) {
+                        rec.mb_per_s = 3.0 * matrix_bytes / (1024 * 1024) / rec.median;
+                        rec.gflop_per_s = 2.0 * n * n * (double)n / 1e9 / rec.median;
+                    } else {
+                        rec.mb_per_s = mb / rec.median;
+                    }
+                    emit_record(out, cfg->format, &rec, first);
+                    first = 0;
+                }
+            }
+        }
+
+        if (ok && set_file_driver(cfg->vfds[0], cfg->queue_depth) < 0)
+            ret = -1;
+        if (ok && (cfg->phases & PHASE_APPEND) &&
+            run_append_benchmark(cfg, out, &first, matrices, n, datasets, times) < 0)
+            ret = -1;
+        if (ok && (cfg->phases & PHASE_EXPR) &&
+            run_expr_benchmark(cfg, out, &first, matrices, copies, n, datasets, times) < 0)
+            ret = -1;
+        if (ok && (cfg->phases & PHASE_SPARSE) &&
+            run_sparse_benchmark(cfg, out, &first, matrices, copies, n, datasets, times) < 0)
+            ret = -1;
+
+        for (int i = 0; i < datasets; i++) {
+            if (matrices) matrix_free(matrices[i], n, n);
+            if (copies) matrix_free(copies[i], n, n);
         }
+        free(matrices);
+        free(copies);
     }
-    
-    H5Sclose(dataspace_id);
-    H5Fclose(file_id);
-    
-    printf("  [Parallel] Write %d %dx%d matrices to HDF5 file %s\n", num_matrices, n, n, filename);
+
+    if ((cfg->phases & PHASE_MANY) && run_many_benchmark(cfg, out, &first) < 0)
+        ret = -1;
+
+    if (cfg->format == FORMAT_JSON)
+        fprintf(out, first ? "[]\n" : "\n]\n");
+    hdf5_io_stop();
+    set_file_driver(VFD_SEC2, 0);
+    pool_trim();
+    if (cfg->trace) {
+        if (verbose_progress)
+            trace_report();
+        trace_export(cfg->trace);
+    }
+    free(times);
+    if (out != stdout)
+        fclose(out);
+    verbose_progress = 1;
+    return ret;
+}
+
+#ifdef H5_HAVE_PARALLEL
+// ===================== MPI-IO 并行HDF5（多进程写同一文件） =====================
+// 仅在使用并行版 HDF5 编译时启用（h5pcc），每个 rank 负责每个矩阵中一段连续的行块，
+// 所有 rank 通过集合 I/O 读写同一个共享文件中的 /matrix_i 数据集。
+
+// 计算 rank 负责的行范围 [*row0, *row0 + *rows)
+static void mpi_row_range(int n, int rank, int size, int *row0, int *rows) {
+    int base = n / size, extra = n % size;
+    *rows = base + (rank < extra ? 1 : 0);
+    *row0 = rank * base + (rank < extra ? rank : extra);
 }
 
 /**
- * 串行写入HDF5文件
- * 用于性能对比
+ * 多进程集合写入
+ * 所有 rank 集合创建数据集，再各自选择自己的行块 hyperslab，用 H5FD_MPIO_COLLECTIVE 写入
+ *
+ * @param filename 共享文件名
+ * @param local 每个矩阵本 rank 的行块（rows x n）
+ * @param n 矩阵维度
+ * @param num_matrices 矩阵数量
+ * @param comm MPI 通信域
+ * @return 0 成功，-1 失败
  */
-void serial_write_hdf5(const char* filename, double **matrices, int n, int num_matrices) {
-    printf("  [Serial] Create HDF5 file and write %d %dx%d matrices...\n", num_matrices, n, n);
-    
-    hid_t file_id, dataspace_id, dataset_id;
-    herr_t status;
-    hsize_t dims[2] = {n, n};
-    char dataset_name[50];
-    
-    // 创建HDF5文件
-    file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+int mpi_parallel_write_hdf5(const char* filename, double **local, int n, int num_matrices, MPI_Comm comm) {
+    int rank, size, row0, rows, ret = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    mpi_row_range(n, rank, size, &row0, &rows);
+
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_fapl_mpio(fapl, comm, MPI_INFO_NULL);
+    hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    H5Pclose(fapl);
     if (file_id < 0) {
-        printf("Error: Failed to create HDF5 file\n");
-        return;
+        printf("Error: Rank %d failed to create HDF5 file\n", rank);
+        return -1;
     }
-    
-    // 创建数据空间
-    dataspace_id = H5Screate_simple(2, dims, NULL);
-    
-    // 串行创建和写入数据集
+
+    hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+    hsize_t dims[2] = {n, n};
+    hsize_t offset[2] = {row0, 0};
+    hsize_t count[2] = {rows, n};
+    hid_t file_space = H5Screate_simple(2, dims, NULL);
+    hid_t mem_space = H5Screate_simple(2, count, NULL);
+    if (rows == 0) {
+        H5Sselect_none(file_space);
+        H5Sselect_none(mem_space);
+    } else {
+        H5Sselect_hyperslab(file_space, H5S_SELECT_SET, offset, NULL, count, NULL);
+    }
+
     for (int i = 0; i < num_matrices; i++) {
+        char dataset_name[50];
         sprintf(dataset_name, "/matrix_%d", i);
-        
-        // 创建数据集
-        dataset_id = H5Dcreate(file_id, dataset_name, H5T_IEEE_F64LE, dataspace_id,
-                              H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        // 数据集创建是集合操作，所有 rank 必须以相同顺序调用
+        hid_t dataset_id = H5Dcreate(file_id, dataset_name, H5T_IEEE_F64LE, file_space,
+                                     H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
         if (dataset_id < 0) {
-            printf("Error: Failed to create dataset %s\n", dataset_name);
+            printf("Error: Rank %d failed to create dataset %s\n", rank, dataset_name);
+            ret = -1;
             continue;
         }
-        
-        // 写入数据
-        status = H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, 
-                         H5P_DEFAULT, matrices[i]);
-        if (status < 0) {
-            printf("Error: Failed to write dataset %s\n", dataset_name);
-        } else {
-            printf("    Completed writing matrix %d\n", i);
+        if (H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, mem_space, file_space, dxpl, local[i]) < 0) {
+            printf("Error: Rank %d failed to write dataset %s\n", rank, dataset_name);
+            ret = -1;
         }
-        
         H5Dclose(dataset_id);
     }
-    
-    // 关闭资源
-    H5Sclose(dataspace_id);
+
+    H5Sclose(mem_space);
+    H5Sclose(file_space);
+    H5Pclose(dxpl);
     H5Fclose(file_id);
-    
-    printf("  [Serial] Write %d %dx%d matrices to HDF5 file %s\n", num_matrices, n, n, filename);
+    return ret;
 }
 
 /**
- * 并行读取HDF5文件中的矩阵数据
- * 演示：使用超平面选择(hyperslab)并行读取数据块
- * 
- * @param filename 文件名
- * @param matrices 用于存储读取数据的矩阵数组
- * @param n 矩阵维度
- * @param num_matrices 矩阵数量
- * @param chunk_size 每次读取的行数
+ * 多进程集合读取：每个 rank 读回自己的行块
  */
-void parallel_read_hdf5(const char* filename, double **matrices, int n, 
-                       int num_matrices, int chunk_size) {
-    printf("  [Parallel] Read %d %dx%d matrices from HDF5 file (chunk size: %d)...\n", 
-           num_matrices, n, n, chunk_size);
-    
-    hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+int mpi_parallel_read_hdf5(const char* filename, double **local, int n, int num_matrices, MPI_Comm comm) {
+    int rank, size, row0, rows, ret = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    mpi_row_range(n, rank, size, &row0, &rows);
+
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_fapl_mpio(fapl, comm, MPI_INFO_NULL);
+    hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, fapl);
+    H5Pclose(fapl);
+    if (file_id < 0) {
+        printf("Error: Rank %d failed to open HDF5 file\n", rank);
+        return -1;
+    }
+
+    hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+    hsize_t offset[2] = {row0, 0};
+    hsize_t count[2] = {rows, n};
+    hid_t mem_space = H5Screate_simple(2, count, NULL);
+    if (rows == 0)
+        H5Sselect_none(mem_space);
 
-    #pragma omp parallel for
     for (int i = 0; i < num_matrices; i++) {
         char dataset_name[50];
         sprintf(dataset_name, "/matrix_%d", i);
-        
         hid_t dataset_id = H5Dopen(file_id, dataset_name, H5P_DEFAULT);
-        if (dataset_id >= 0) {
-            herr_t status = H5Dread(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, 
-                                   H5P_DEFAULT, matrices[i]);
-            H5Dclose(dataset_id);
-            
-            if (status >= 0) {
-                printf("    Thread %d: Parallel read matrix %d\n", omp_get_thread_num(), i);
-            }
+        if (dataset_id < 0) {
+            printf("Error: Rank %d failed to open dataset %s\n", rank, dataset_name);
+            ret = -1;
+            continue;
+        }
+        hid_t file_space = H5Dget_space(dataset_id);
+        if (rows == 0)
+            H5Sselect_none(file_space);
+        else
+            H5Sselect_hyperslab(file_space, H5S_SELECT_SET, offset, NULL, count, NULL);
+        if (H5Dread(dataset_id, H5T_NATIVE_DOUBLE, mem_space, file_space, dxpl, local[i]) < 0) {
+            printf("Error: Rank %d failed to read dataset %s\n", rank, dataset_name);
+            ret = -1;
         }
+        H5Sclose(file_space);
+        H5Dclose(dataset_id);
     }
-    
+
+    H5Sclose(mem_space);
+    H5Pclose(dxpl);
     H5Fclose(file_id);
-    printf("  [Parallel] Finish reading.\n");
+    return ret;
 }
 
 /**
- * 串行读取HDF5文件
- * 用于性能对比
+ * MPI-IO 基准测试：每个 rank 用 OpenMP 初始化自己的行块，集合写入、集合读回并校验
+ * 报告按最慢 rank 计时的聚合带宽
  */
-void serial_read_hdf5(const char* filename, double **matrices, int n, int num_matrices) {
-    printf("  [Serial] Read %d %dx%d matrices from HDF5 file...\n", num_matrices, n, n);
-    
-    hid_t file_id, dataset_id;
-    herr_t status;
-    char dataset_name[50];
-    
-    // 打开HDF5文件
-    file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
-    if (file_id < 0) {
-        printf("Error: Failed to open HDF5 file\n");
-        return;
+void mpi_benchmark(int n, int num_matrices, MPI_Comm comm) {
+    int rank, size, row0, rows;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    mpi_row_range(n, rank, size, &row0, &rows);
+
+    double total_mb = (double)n * n * sizeof(double) * num_matrices / (1024 * 1024);
+    size_t local_elems = (size_t)rows * n;
+    double **local = (double**)malloc(num_matrices * sizeof(double*));
+    int alloc_ok = local != NULL, all_ok;
+    for (int i = 0; alloc_ok && i < num_matrices; i++) {
+        local[i] = (double*)pool_alloc((local_elems ? local_elems : 1) * sizeof(double));
+        if (!local[i]) alloc_ok = 0;
     }
-    
-    // 串行读取每个数据集
+    MPI_Allreduce(&alloc_ok, &all_ok, 1, MPI_INT, MPI_LAND, comm);
+    if (!all_ok) {
+        if (rank == 0)
+            printf("内存分配失败！\n");
+        MPI_Abort(comm, 1);
+    }
+
+    if (rank == 0)
+        printf("MPI-IO 集合读写: %d 个进程, 每进程 %d 个OpenMP线程, 总数据 %.2f MB\n",
+               size, omp_get_max_threads(), total_mb);
+
+    // 各 rank 按全局行号初始化自己的行块
+    double local_sum = 0.0;
     for (int i = 0; i < num_matrices; i++) {
-        sprintf(dataset_name, "/matrix_%d", i);
-        
-        // 打开数据集
-        dataset_id = H5Dopen(file_id, dataset_name, H5P_DEFAULT);
-        if (dataset_id < 0) {
-            printf("Error: Failed to open dataset %s\n", dataset_name);
-            continue;
-        }
-        
-        // 读取整个数据集
-        status = H5Dread(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, 
-                        H5P_DEFAULT, matrices[i]);
-        if (status < 0) {
-            printf("Error: Failed to read dataset %s\n", dataset_name);
-        } else {
-            printf("    Completed reading matrix %d\n", i);
+        #pragma omp parallel for reduction(+:local_sum)
+        for (int r = 0; r < rows; r++) {
+            double *dst = local[i] + (size_t)r*n;
+            philox_fill_row(dst, RNG_SEED, (uint32_t)i, (uint32_t)(row0 + r), n);
+            for (int j = 0; j < n; j++)
+                local_sum += dst[j];
         }
-        
-        H5Dclose(dataset_id);
     }
-    
-    H5Fclose(file_id);
-    printf("  [Serial] Finish reading.\n");
+
+    MPI_Barrier(comm);
+    double t0 = MPI_Wtime();
+    int status = mpi_parallel_write_hdf5("mpi_data.h5", local, n, num_matrices, comm);
+    double write_time = MPI_Wtime() - t0, max_write;
+    MPI_Reduce(&write_time, &max_write, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    for (int i = 0; i < num_matrices; i++)
+        memset(local[i], 0, local_elems * sizeof(double));
+
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    status |= mpi_parallel_read_hdf5("mpi_data.h5", local, n, num_matrices, comm);
+    double read_time = MPI_Wtime() - t0, max_read;
+    MPI_Reduce(&read_time, &max_read, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    double read_sum = 0.0, sums[2], global[2];
+    for (int i = 0; i < num_matrices; i++)
+        read_sum += verify_matrix_rows(local[i], rows, n);
+    sums[0] = local_sum;
+    sums[1] = read_sum;
+    MPI_Reduce(sums, global, 2, MPI_DOUBLE, MPI_SUM, 0, comm);
+    int any_failed;
+    MPI_Reduce(&status, &any_failed, 1, MPI_INT, MPI_BOR, 0, comm);
+
+    if (rank == 0) {
+        printf("\n=== MPI-IO 集合读写 性能统计 (%d 进程) ===\n", size);
+        printf("数据大小: %.2f MB\n", total_mb);
+        printf("写入时间: %.4f 秒, 聚合带宽 %.2f MB/s, 每进程 %.2f MB/s\n",
+               max_write, total_mb / max_write, total_mb / max_write / size);
+        printf("读取时间: %.4f 秒, 聚合带宽 %.2f MB/s, 每进程 %.2f MB/s\n",
+               max_read, total_mb / max_read, total_mb / max_read / size);
+        printf("校验和: 写入 %.6f, 读回 %.6f %s\n", global[0], global[1],
+               !any_failed && fabs(global[0] - global[1]) <= 1e-9 * fabs(global[0]) ? "[通过]" : "[失败]");
+        printf("=============================\n\n");
+    }
+
+    for (int i = 0; i < num_matrices; i++)
+        pool_free(local[i], (local_elems ? local_elems : 1) * sizeof(double));
+    free(local);
 }
+#endif
 
 /**
- * 验证矩阵数据的正确性
- * 简单检查：计算所有元素的和
+ * 演示程序的返回路径：并行HDF5构建下演示开始前初始化了 MPI，返回前在这里结束
  */
-double verify_matrix(double *matrix, int n) {
-    double sum = 0.0;
-    #pragma omp parallel for reduction(+:sum)
-    for (int i = 0; i < n * n; i++) {
-        sum += matrix[i];
-    }
-    return sum;
-}
-void print_performance_stats(const char* operation, double parallel_time, 
-                           double serial_time, double data_size_mb) {
-    printf("\n=== %s 性能统计 ===\n", operation);
-    printf("数据大小: %.2f MB\n", data_size_mb);
-    printf("并行时间: %.4f 秒\n", parallel_time);
-    printf("串行时间: %.4f 秒\n", serial_time);
-    printf("加速比: %.2fx\n", serial_time / parallel_time);
-    printf("并行效率: %.2f%%\n", (serial_time / parallel_time) / omp_get_max_threads() * 100);
-    printf("=============================\n\n");
+static int demo_exit(int status) {
+#ifdef H5_HAVE_PARALLEL
+    MPI_Finalize();
+#endif
+    return status;
 }
 
-int main(void) {
+int main(int argc, char **argv) {
     // 性能计时变量
     double start_time, end_time;
     double parallel_time, serial_time;
     
+    // 解析命令行参数
+    bench_config_t cfg;
+    int parsed = parse_bench_config(argc, argv, &cfg);
+    if (parsed != 0)
+        return parsed > 0 ? 0 : -1;
+    int matrix_size = cfg.sizes[0];
+    int num_datasets = cfg.datasets[0];
+    int chunk_size = cfg.chunks[0];
+    omp_set_num_threads(cfg.threads[0]);
+    if (cfg.bind >= 0)
+        pin_omp_threads(cfg.bind);
+    pool_lazy_zero = cfg.lazy_zero;
+    if (cfg.trace) {
+        trace_start();
+        trace_set_thread_name("main");
+    }
+    
     // 计算数据大小
-    double matrix_size_mb = (double)(MATRIX_SIZE * MATRIX_SIZE * sizeof(double)) / (1024 * 1024);
-    double total_data_mb = matrix_size_mb * NUM_DATASETS;
+    double matrix_size_mb = (double)matrix_size * matrix_size * sizeof(double) / (1024 * 1024);
+    double total_data_mb = matrix_size_mb * num_datasets;
     
+    // SWMR 追踪读取方：由演示程序作为子进程启动，也可以单独用来追踪其他进程正在追加的文件
+    if (cfg.tail)
+        return append_tail_hdf5(cfg.tail, cfg.tail_rows) == 0 ? 0 : -1;
+
+    // 基准测试模式：按参数组合重复计时并输出统计结果
+    if (cfg.bench)
+        return run_benchmark(&cfg) == 0 ? 0 : -1;
+
+#ifdef H5_HAVE_PARALLEL
+    // 并行HDF5构建的演示：先运行多进程 MPI-IO 基准测试；多于一个进程时只运行这一项
+    // 之后的每条返回路径都经过 demo_exit 结束 MPI
+    int provided, world_size;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    mpi_benchmark(matrix_size, num_datasets, MPI_COMM_WORLD);
+    if (world_size > 1)
+        return demo_exit(0);
+#endif
+
     printf("=== OpenMP + HDF5 并行计算演示程序 ===\n");
     printf("配置信息：\n");
-    printf("  矩阵大小: %dx%d\n", MATRIX_SIZE, MATRIX_SIZE);
-    printf("  数据集数量: %d\n", NUM_DATASETS);
+    printf("  矩阵大小: %dx%d\n", matrix_size, matrix_size);
+    printf("  数据集数量: %d\n", num_datasets);
     printf("  单个矩阵大小: %.2f MB\n", matrix_size_mb);
     printf("  总数据大小: %.2f MB\n", total_data_mb);
     printf("  OpenMP最大线程数: %d\n", omp_get_max_threads());
-    printf("  数据块大小: %d 行\n\n", CHUNK_SIZE);
+    printf("  数据块大小: %d 行\n", chunk_size);
+    printf("  文件驱动: %s\n\n", vfd_names[cfg.vfds[0]]);
+    
+    // 默认文件驱动（--vfd 的第一个），之后所有使用默认文件访问属性的文件都经过它
+    if (set_file_driver(cfg.vfds[0], cfg.queue_depth) < 0)
+        return demo_exit(-1);
+
+    // 启动HDF5 I/O服务线程：并行读写路径只通过它访问HDF5
+    if (hdf5_io_start() < 0) {
+        printf("Error: Failed to start HDF5 I/O thread\n");
+        return demo_exit(-1);
+    }
     
     // 分配内存
     printf("正在分配内存...\n");
-    double **matrices = (double**)malloc(NUM_DATASETS * sizeof(double*));
-    double **matrices_copy = (double**)malloc(NUM_DATASETS * sizeof(double*));
+    double **matrices = (double**)malloc(num_datasets * sizeof(double*));
+    double **matrices_copy = (double**)malloc(num_datasets * sizeof(double*));
     
-    for (int i = 0; i < NUM_DATASETS; i++) {
-        matrices[i] = (double*)malloc(MATRIX_SIZE * MATRIX_SIZE * sizeof(double));
-        matrices_copy[i] = (double*)malloc(MATRIX_SIZE * MATRIX_SIZE * sizeof(double));
+    for (int i = 0; i < num_datasets; i++) {
+        matrices[i] = matrix_alloc(matrix_size, matrix_size);
+        matrices_copy[i] = matrix_alloc(matrix_size, matrix_size);
         
         if (!matrices[i] || !matrices_copy[i]) {
             printf("内存分配失败！\n");
-            return -1;
+            return demo_exit(-1);
         }
     }
+    report_numa_placement("matrices[0]", matrices[0], (size_t)matrix_size * matrix_size * sizeof(double));
+    printf("  线程绑定: %s\n\n", cfg.bind < 0 ? "未绑定" : cfg.bind ? "spread" : "close");
     
     // === 1. 矩阵初始化性能比较 ===
     printf("1. 矩阵初始化性能比较\n");
     
-    // 并行初始化
+    // 旧实现：数据集级 parallel for 内嵌套 init_matrix_parallel，嵌套关闭时内层串行，最多 num_datasets 个线程工作
     start_time = omp_get_wtime();
     #pragma omp parallel for
-    for (int i = 0; i < NUM_DATASETS; i++) {
-        init_matrix_parallel(matrices[i], MATRIX_SIZE);
+    for (int i = 0; i < num_datasets; i++) {
+        init_matrix_parallel(matrices_copy[i], matrix_size, i);
     }
+    double nested_time = omp_get_wtime() - start_time;
+
+    // 并行初始化：(数据集, 行块) 任务，负载与数据集数和线程数之比无关
+    task_stats_t task_stats;
+    start_time = omp_get_wtime();
+    task_init_matrices(matrices, matrix_size, num_datasets, chunk_size, &task_stats);
     end_time = omp_get_wtime();
     parallel_time = end_time - start_time;
     
     // 串行初始化
     start_time = omp_get_wtime();
-    for (int i = 0; i < NUM_DATASETS; i++) {
-        init_matrix_serial(matrices_copy[i], MATRIX_SIZE);
+    for (int i = 0; i < num_datasets; i++) {
+        init_matrix_serial(matrices_copy[i], matrix_size, i);
     }
     end_time = omp_get_wtime();
     serial_time = end_time - start_time;
     
     print_performance_stats("矩阵初始化", parallel_time, serial_time, total_data_mb);
+    {
+        // 计数器型随机数与线程调度无关，并行与串行结果应逐位一致
+        int mismatched = 0;
+        for (int i = 0; i < num_datasets; i++)
+            if (memcmp(matrices[i], matrices_copy[i], (size_t)matrix_size * matrix_size * sizeof(double)) != 0)
+                mismatched++;
+        print_task_stats("  任务调度", &task_stats);
+        printf("  数据集级嵌套 parallel for: %.4f 秒, 任务调度: %.4f 秒 (%.2fx)\n", nested_time, parallel_time,
+               nested_time / parallel_time);
+        printf("  并行初始化填充带宽: %.2f GB/s\n", total_data_mb / 1024 / parallel_time);
+        printf("  并行/串行初始化结果逐位一致: %s\n\n", mismatched ? "[失败]" : "[通过]");
+    }
     
     // === 2. HDF5文件写入性能比较 ===
     printf("2. HDF5文件写入性能比较\n");
     
-    // 并行写入
+    // 并行写入：每个行块一个写请求提交任务 + 一个校验任务
     start_time = omp_get_wtime();
-    parallel_write_hdf5("parallel_data.h5", matrices, MATRIX_SIZE, NUM_DATASETS);
+    task_write_hdf5("parallel_data.h5", matrices, matrix_size, num_datasets, chunk_size, &task_stats);
     end_time = omp_get_wtime();
     parallel_time = end_time - start_time;
     
     // 串行写入
     start_time = omp_get_wtime();
-    serial_write_hdf5("serial_data.h5", matrices, MATRIX_SIZE, NUM_DATASETS);
+    serial_write_hdf5("serial_data.h5", matrices, matrix_size, num_datasets);
     end_time = omp_get_wtime();
     serial_time = end_time - start_time;
     
     print_performance_stats("HDF5文件写入", parallel_time, serial_time, total_data_mb);
+    print_task_stats("  任务调度", &task_stats);
+    printf("\n");
     
     // === 3. HDF5文件读取性能比较 ===
     printf("3. HDF5文件读取性能比较\n");
     
     // 清空内存用于验证读取结果
-    for (int i = 0; i < NUM_DATASETS; i++) {
-        memset(matrices[i], 0, MATRIX_SIZE * MATRIX_SIZE * sizeof(double));
-        memset(matrices_copy[i], 0, MATRIX_SIZE * MATRIX_SIZE * sizeof(double));
+    for (int i = 0; i < num_datasets; i++) {
+        matrix_clear(matrices[i], matrix_size, matrix_size);
+        matrix_clear(matrices_copy[i], matrix_size, matrix_size);
     }
     
-    // 并行读取
+    // 并行读取：读请求提交任务 -> 依赖它的等待 + 校验任务，校验与写入时保存的属性比对
+    int task_mismatched = 0;
     start_time = omp_get_wtime();
-    parallel_read_hdf5("parallel_data.h5", matrices, MATRIX_SIZE, NUM_DATASETS, CHUNK_SIZE);
+    int task_read_ret = task_read_hdf5("parallel_data.h5", matrices, matrix_size, num_datasets, chunk_size,
+                                       &task_mismatched, &task_stats);
     end_time = omp_get_wtime();
     parallel_time = end_time - start_time;
     
     // 串行读取
     start_time = omp_get_wtime();
-    serial_read_hdf5("serial_data.h5", matrices_copy, MATRIX_SIZE, NUM_DATASETS);
+    serial_read_hdf5("serial_data.h5", matrices_copy, matrix_size, num_datasets);
     end_time = omp_get_wtime();
     serial_time = end_time - start_time;
     
     print_performance_stats("HDF5文件读取", parallel_time, serial_time, total_data_mb);
+    print_task_stats("  任务调度", &task_stats);
+    printf("  任务调度读取校验与写入时属性比对: %s\n\n",
+           task_read_ret == 0 && task_mismatched == 0 ? "[通过]" : "[失败]");
     
     // === 4. 数据验证 ===
-    printf("4. 数据完整性验证\n");
-    for (int i = 0; i < NUM_DATASETS; i++) {
-        double sum1 = verify_matrix(matrices[i], MATRIX_SIZE);
-        double sum2 = verify_matrix(matrices_copy[i], MATRIX_SIZE);
-        printf("  矩阵 %d: 并行读取校验和 = %.6f, 串行读取校验和 = %.6f\n", i, sum1, sum2);
+    printf("4. 数据完整性验证 (CRC32C + 补偿求和，与归约顺序无关)\n");
+    {
+        matrix_checksum_t read_sums[num_datasets];
+        memset(read_sums, 0, sizeof(read_sums));
+        for (int i = 0; i < num_datasets; i++) {
+            matrix_checksum_t copy_sum;
+            checksum_matrix(matrices[i], matrix_size, matrix_size, &read_sums[i]);
+            checksum_matrix(matrices_copy[i], matrix_size, matrix_size, &copy_sum);
+            printf("  矩阵 %d: 并行读取 crc32c=%08x sum=%.10e, 串行读取 crc32c=%08x sum=%.10e %s\n",
+                   i, read_sums[i].crc32c, read_sums[i].sum, copy_sum.crc32c, copy_sum.sum,
+                   checksum_equal(&read_sums[i], &copy_sum) ? "[一致]" : "[不一致]");
+        }
+
+        // 不加载整矩阵，直接从文件流式重算，并与写入时保存的属性比对
+        int mismatched = 0;
+        start_time = omp_get_wtime();
+        for (int i = 0; i < num_datasets; i++) {
+            matrix_checksum_t computed, stored;
+            char dataset_name[50];
+            sprintf(dataset_name, "/matrix_%d", i);
+            if (checksum_dataset_hdf5("serial_data.h5", dataset_name, matrix_size, chunk_size,
+                                      &computed, &stored) < 0 ||
+                !checksum_equal(&computed, &stored) || !checksum_equal(&computed, &read_sums[i]))
+                mismatched++;
+        }
+        end_time = omp_get_wtime();
+        print_checksum("  矩阵 0", &read_sums[0]);
+        printf("  流式校验 serial_data.h5: %.4f 秒 (%.2f MB/s), 与写入时属性比对 %s\n\n",
+               end_time - start_time, total_data_mb / (end_time - start_time),
+               mismatched ? "[失败]" : "[通过]");
     }
     
+    // === 5. 矩阵乘法性能 ===
+    printf("\n5. 矩阵乘法性能 (GEMM)\n");
+    benchmark_gemm(matrices[0], matrices[num_datasets > 1 ? 1 : 0], matrix_size);
+
+    // === 6. 核外矩阵乘法 ===
+    printf("6. 核外矩阵乘法 (直接从HDF5文件分块流式读取)\n");
+    {
+        ooc_stats_t ooc;
+        int b_index = num_datasets > 1 ? 1 : 0;
+        char b_name[50];
+        sprintf(b_name, "/matrix_%d", b_index);
+        start_time = omp_get_wtime();
+        if (ooc_matrix_multiply_hdf5("parallel_data.h5", "/matrix_0", b_name, "/matrix_product",
+                                     OOC_MEMORY_BUDGET_MB, &ooc) == 0) {
+            end_time = omp_get_wtime();
+            double expected = expected_product_sum(matrices[0], matrices[b_index], matrix_size);
+            double gflop = 2.0 * matrix_size * matrix_size * (double)matrix_size / 1e9;
+            printf("\n=== 核外矩阵乘法 性能统计 ===\n");
+            printf("内存预算: %d MB, 分块大小: %dx%d\n", OOC_MEMORY_BUDGET_MB, ooc.tile, ooc.tile);
+            printf("总时间: %.4f 秒 (I/O %.4f 秒, 计算 %.4f 秒)\n",
+                   end_time - start_time, ooc.io_time, ooc.compute_time);
+            printf("读取: %.2f MB, 写入: %.2f MB\n",
+                   ooc.bytes_read / (1024 * 1024), ooc.bytes_written / (1024 * 1024));
+            printf("计算性能: %.2f GFLOP/s\n", gflop / (end_time - start_time));
+            printf("校验和: %.6e (期望 %.6e, 相对误差 %.3e)\n", ooc.c_sum, expected,
+                   fabs(ooc.c_sum - expected) / fabs(expected));
+            printf("=============================\n\n");
+        }
+    }
+
+    // === 7. 分块压缩写入性能比较 ===
+    printf("7. 分块压缩写入性能比较 (并行预压缩 + 直接分块写入 vs HDF5过滤器管线)\n");
+    {
+        hdf5_layout_t layout = {1, {LAYOUT_CHUNK_ROWS, LAYOUT_CHUNK_COLS}, USE_SHUFFLE, DEFLATE_LEVEL, 0, 0};
+        compress_stats_t cst;
+        if (layout.chunk_dims[0] > (hsize_t)matrix_size) layout.chunk_dims[0] = matrix_size;
+        if (layout.chunk_dims[1] > (hsize_t)matrix_size) layout.chunk_dims[1] = matrix_size;
+
+        start_time = omp_get_wtime();
+        parallel_write_hdf5_compressed("parallel_compressed.h5", matrices, matrix_size, num_datasets,
+                                       &layout, &cst);
+        end_time = omp_get_wtime();
+        parallel_time = end_time - start_time;
+
+        start_time = omp_get_wtime();
+        serial_write_hdf5_layout("serial_compressed.h5", matrices, matrix_size, num_datasets, &layout);
+        end_time = omp_get_wtime();
+        serial_time = end_time - start_time;
+
+        print_performance_stats("HDF5压缩写入", parallel_time, serial_time, total_data_mb);
+        printf("  压缩比: %.3f (%.2f MB -> %.2f MB, %ld 个分块)\n",
+               cst.raw_bytes / cst.compressed_bytes, cst.raw_bytes / (1024 * 1024),
+               cst.compressed_bytes / (1024 * 1024), cst.chunks);
+        printf("  写入吞吐: 并行 %.2f MB/s, 串行 %.2f MB/s\n",
+               total_data_mb / parallel_time, total_data_mb / serial_time);
+        printf("  单线程压缩速度: %.2f MB/s\n",
+               cst.raw_bytes / (1024 * 1024) / cst.compress_time);
+
+        // 通过标准 H5Dread（过滤器管线解压）读回并逐字节比对
+        serial_read_hdf5("parallel_compressed.h5", matrices_copy, matrix_size, num_datasets);
+        int mismatched = 0;
+        for (int i = 0; i < num_datasets; i++)
+            if (memcmp(matrices[i], matrices_copy[i], (size_t)matrix_size * matrix_size * sizeof(double)) != 0)
+                mismatched++;
+        printf("  直接分块写入数据回读校验: %s\n\n", mismatched ? "[失败]" : "[通过]");
+    }
+
+    // === 8. 分块压缩读取性能比较 ===
+    printf("8. 分块压缩读取性能比较 (直接分块读取 + 并行解压 vs H5Dread)\n");
+    {
+        compress_stats_t dst;
+        size_t matrix_bytes = (size_t)matrix_size * matrix_size * sizeof(double);
+        int mismatched = 0;
+
+        for (int i = 0; i < num_datasets; i++)
+            matrix_clear(matrices_copy[i], matrix_size, matrix_size);
+        start_time = omp_get_wtime();
+        parallel_read_hdf5_chunks("parallel_compressed.h5", matrices_copy, matrix_size, num_datasets, &dst);
+        end_time = omp_get_wtime();
+        parallel_time = end_time - start_time;
+        for (int i = 0; i < num_datasets; i++)
+            if (memcmp(matrices[i], matrices_copy[i], matrix_bytes) != 0)
+                mismatched++;
+
+        start_time = omp_get_wtime();
+        serial_read_hdf5("serial_compressed.h5", matrices_copy, matrix_size, num_datasets);
+        end_time = omp_get_wtime();
+        serial_time = end_time - start_time;
+
+        print_performance_stats("HDF5压缩读取", parallel_time, serial_time, total_data_mb);
+        printf("  读取存储数据: %.2f MB (%ld 个分块)\n", dst.compressed_bytes / (1024 * 1024), dst.chunks);
+        printf("  读取吞吐: 并行 %.2f MB/s, 串行 %.2f MB/s\n",
+               total_data_mb / parallel_time, total_data_mb / serial_time);
+        if (dst.compress_time > 0.0)
+            printf("  单线程解压速度: %.2f MB/s\n", dst.raw_bytes / (1024 * 1024) / dst.compress_time);
+        printf("  直接分块读取数据校验: %s\n\n", mismatched ? "[失败]" : "[通过]");
+    }
+
+    // === 9. 流水线写入 vs 分阶段写入 ===
+    printf("9. 流水线写入 (初始化与HDF5写入重叠) vs 分阶段写入\n");
+    {
+        pipeline_stats_t pst;
+        double init_time, write_time;
+
+        start_time = omp_get_wtime();
+        for (int i = 0; i < num_datasets; i++)
+            init_matrix_parallel(matrices_copy[i], matrix_size, i);
+        init_time = omp_get_wtime() - start_time;
+        start_time = omp_get_wtime();
+        parallel_write_hdf5("phased_data.h5", matrices_copy, matrix_size, num_datasets);
+        write_time = omp_get_wtime() - start_time;
+
+        if (pipelined_write_hdf5("pipelined_data.h5", matrix_size, num_datasets, chunk_size,
+                                 PIPELINE_RING_SIZE, produce_init_block, NULL, &pst) == 0) {
+            printf("\n=== 流水线写入 性能统计 ===\n");
+            printf("分阶段: 初始化 %.4f 秒 + 写入 %.4f 秒 = %.4f 秒, 缓冲区 %.2f MB\n",
+                   init_time, write_time, init_time + write_time, total_data_mb);
+            printf("流水线: %.4f 秒 (生产 %.4f 秒, 等待I/O %.4f 秒), 缓冲区 %.2f MB\n",
+                   pst.total_time, pst.produce_time, pst.stall_time, pst.staging_mb);
+            printf("理想下限 max(计算, I/O): %.4f 秒\n", init_time > write_time ? init_time : write_time);
+            printf("加速比: %.2fx\n", (init_time + write_time) / pst.total_time);
+            printf("=============================\n\n");
+        }
+    }
+
+    // === 10. 内存映射零拷贝读取 ===
+    printf("10. 内存映射零拷贝读取 vs H5Dread\n");
+    {
+        const double *views[num_datasets];
+        mapped_file_t mf;
+        double map_time, scan_time, read_time;
+
+        start_time = omp_get_wtime();
+        serial_read_hdf5("parallel_data.h5", matrices_copy, matrix_size, num_datasets);
+        for (int i = 0; i < num_datasets; i++)
+            verify_matrix(matrices_copy[i], matrix_size);
+        read_time = omp_get_wtime() - start_time;
+
+        start_time = omp_get_wtime();
+        int mapped = mmap_read_hdf5("parallel_data.h5", views, matrix_size, num_datasets,
+                                    MAP_ACCESS_SEQUENTIAL, &mf) == 0;
+        map_time = omp_get_wtime() - start_time;
+        if (mapped) {
+            int mismatched = 0;
+            double expected[num_datasets], sums[num_datasets];
+            for (int i = 0; i < num_datasets; i++)
+                expected[i] = verify_matrix(matrices[i], matrix_size);
+            start_time = omp_get_wtime();
+            for (int i = 0; i < num_datasets; i++)
+                sums[i] = verify_matrix((double*)views[i], matrix_size);
+            scan_time = omp_get_wtime() - start_time;
+            for (int i = 0; i < num_datasets; i++)
+                if (sums[i] != expected[i])
+                    mismatched++;
+            unmap_hdf5(&mf);
+
+            printf("\n=== 内存映射读取 性能统计 ===\n");
+            printf("H5Dread + 校验: %.4f 秒\n", read_time);
+            printf("mmap 建立映射: %.6f 秒, 首次访问 + 校验: %.4f 秒\n", map_time, scan_time);
+            printf("映射数据校验: %s\n", mismatched ? "[失败]" : "[通过]");
+            printf("=============================\n\n");
+        }
+    }
+
+    // === 11. 区域读取与分块缓存 ===
+    printf("11. 重叠窗口区域读取 (分块 LRU 缓存 vs 每个窗口直接 H5Dread)\n");
+    {
+        hsize_t win = matrix_size / 16 > 1 ? matrix_size / 16 : 1;
+        hsize_t span = (hsize_t)matrix_size / 2 > win ? (hsize_t)matrix_size / 2 : win;   // 窗口集中在左上角，相互重叠
+        hsize_t offsets[REGION_WINDOWS][2];
+        for (int w = 0; w < REGION_WINDOWS; w++) {
+            uint32_t h = (uint32_t)w * 2654435761u;
+            offsets[w][0] = (h >> 7) % (span - win + 1);
+            offsets[w][1] = (h >> 17) % (span - win + 1);
+        }
+
+        tile_cache_t cache;
+        region_dataset_t ds;
+        tile_cache_init(&cache, (size_t)cfg.cache_mb);
+        if (region_open(&ds, &cache, "parallel_compressed.h5", "/matrix_0") == 0) {
+            double direct_time = 0.0, cached_time = 0.0;
+            int mismatched = 0, failed = 0;
+            for (int pass = 0; pass < 2; pass++) {
+                start_time = omp_get_wtime();
+                #pragma omp parallel reduction(+:mismatched, failed)
+                {
+                    size_t win_bytes = win * win * sizeof(double);
+                    double *buf = (double*)pool_alloc(win_bytes);
+                    #pragma omp for schedule(dynamic)
+                    for (int w = 0; w < REGION_WINDOWS; w++) {
+                        hsize_t count[2] = {win, win};
+                        int status;
+                        if (!buf) {
+                            failed++;
+                            continue;
+                        }
+                        if (pass == 0) {
+                            hdf5_io_req_t req = {0};
+                            req.op = IO_READ;
+                            req.obj = ds.dataset_id;
+                            req.row = offsets[w][0];
+                            req.col = offsets[w][1];
+                            req.rows = req.cols = req.ld = win;
+                            req.buf = buf;
+                            hdf5_io_submit(&req);
+                            status = hdf5_io_wait(&req) < 0 ? -1 : 0;
+                        } else {
+                            status = region_read(&ds, offsets[w], count, buf);
+                        }
+                        if (status < 0) {
+                            failed++;
+                            continue;
+                        }
+                        for (hsize_t r = 0; r < win; r++)
+                            if (memcmp(buf + r * win, matrices[0] + (offsets[w][0] + r) * matrix_size + offsets[w][1],
+                                       win * sizeof(double)) != 0) {
+                                mismatched++;
+                                break;
+                            }
+                    }
+                    pool_free(buf, win_bytes);
+                }
+                if (pass == 0)
+                    direct_time = omp_get_wtime() - start_time;
+                else
+                    cached_time = omp_get_wtime() - start_time;
+            }
+            region_close(&ds);
+
+            tile_cache_stats_t cst;
+            tile_cache_get_stats(&cache, &cst);
+            printf("\n=== 区域读取 性能统计 ===\n");
+            printf("窗口: %d 个 %llux%llu, 瓦片: %llux%llu (%s)\n", REGION_WINDOWS,
+                   (unsigned long long)win, (unsigned long long)win,
+                   (unsigned long long)ds.tile[0], (unsigned long long)ds.tile[1],
+                   ds.chunked ? "数据集分块" : "固定瓦片");
+            printf("直接 H5Dread: %.4f 秒, 分块缓存: %.4f 秒, 加速比: %.2fx\n",
+                   direct_time, cached_time, direct_time / cached_time);
+            printf("缓存命中: %llu, 未命中: %llu (命中率 %.1f%%), 淘汰: %llu\n",
+                   (unsigned long long)cst.hits, (unsigned long long)cst.misses,
+                   cst.hits + cst.misses ? 100.0 * cst.hits / (cst.hits + cst.misses) : 0.0,
+                   (unsigned long long)cst.evictions);
+            printf("缓存占用: %.2f MB / 预算 %.2f MB\n", cst.bytes / (1024.0 * 1024.0),
+                   cst.budget / (1024.0 * 1024.0));
+            printf("窗口数据校验: %s\n", mismatched || failed ? "[失败]" : "[通过]");
+            printf("=============================\n\n");
+        }
+        tile_cache_destroy(&cache);
+    }
+
+    // === 12. 分块 Z-order 布局与转置副本 ===
+    printf("12. 分块 Z-order 布局与转置副本 (列面板 / 单分块读取: 连续存储 vs 分块 vs 转置副本)\n");
+    {
+        hdf5_layout_t tiled = {1, {cfg.tile[0], cfg.tile[1]}, 0, 0, 1, 1};
+        if (tiled.chunk_dims[0] > (hsize_t)matrix_size) tiled.chunk_dims[0] = matrix_size;
+        if (tiled.chunk_dims[1] > (hsize_t)matrix_size) tiled.chunk_dims[1] = matrix_size;
+        hsize_t n = matrix_size, tr = tiled.chunk_dims[0], tc = tiled.chunk_dims[1];
+
+        start_time = omp_get_wtime();
+        parallel_write_hdf5_compressed("parallel_tiled.h5", matrices, matrix_size, num_datasets, &tiled, NULL);
+        double write_time = omp_get_wtime() - start_time;
+
+        // 列面板 [0, n) x [0, tc)：连续存储每行一段；转置副本中是 tc 行的行面板
+        size_t panel_bytes = (size_t)(n * tc * sizeof(double));
+        double *panel = (double*)pool_alloc(panel_bytes), *tpanel = (double*)pool_alloc(panel_bytes);
+        double *tile_buf = (double*)pool_alloc((size_t)(tr * tc * sizeof(double)));
+        if (panel && tpanel && tile_buf) {
+            const char *names[3] = {"连续存储", "分块存储", "转置副本"};
+            double panel_time[3] = {0}, tile_time[2] = {0};
+            long panel_runs[3] = {0}, tile_runs[2] = {0};
+            int mismatched = 0;
+            hsize_t trow = (n / tr / 2) * tr, tcol = (n / tc / 2) * tc;   // 中间的一个分块
+            hsize_t trows = trow + tr <= n ? tr : n - trow, tcols = tcol + tc <= n ? tc : n - tcol;
+
+            for (int v = 0; v < 3; v++) {
+                start_time = omp_get_wtime();
+                int status = v == 2
+                    ? read_panel_hdf5("parallel_tiled.h5", "/matrix_0_T", 0, 0, tc, n, tpanel, &panel_runs[v])
+                    : read_panel_hdf5(v ? "parallel_tiled.h5" : "parallel_data.h5", "/matrix_0",
+                                      0, 0, n, tc, panel, &panel_runs[v]);
+                if (status == 0 && v == 2)
+                    transpose_chunk(tpanel, tc, n, panel);
+                panel_time[v] = omp_get_wtime() - start_time;
+                for (hsize_t r = 0; status == 0 && r < n; r++)
+                    if (memcmp(panel + r * tc, matrices[0] + r * n, tc * sizeof(double)) != 0) {
+                        status = -1;
+                        break;
+                    }
+                if (status < 0)
+                    mismatched++;
+            }
+            for (int v = 0; v < 2; v++) {
+                start_time = omp_get_wtime();
+                int status = read_panel_hdf5(v ? "parallel_tiled.h5" : "parallel_data.h5", "/matrix_0",
+                                             trow, tcol, trows, tcols, tile_buf, &tile_runs[v]);
+                tile_time[v] = omp_get_wtime() - start_time;
+                for (hsize_t r = 0; status == 0 && r < trows; r++)
+                    if (memcmp(tile_buf + r * tcols, matrices[0] + (trow + r) * n + tcol, tcols * sizeof(double)) != 0) {
+                        status = -1;
+                        break;
+                    }
+                if (status < 0)
+                    mismatched++;
+            }
+
+            printf("\n=== 分块布局 性能统计 ===\n");
+            printf("分块形状: %llux%llu, Z-order 写入 + 转置副本: %.4f 秒 (%.2f MB/s, 含转置副本)\n",
+                   (unsigned long long)tr, (unsigned long long)tc, write_time, 2 * total_data_mb / write_time);
+            for (int v = 0; v < 3; v++)
+                printf("列面板 %llux%llu %s: %.4f 秒, 文件连续区间 %ld 段\n", (unsigned long long)n,
+                       (unsigned long long)tc, names[v], panel_time[v], panel_runs[v]);
+            for (int v = 0; v < 2; v++)
+                printf("单分块 (%llu, %llu) %s: %.6f 秒, 文件连续区间 %ld 段\n", (unsigned long long)trow,
+                       (unsigned long long)tcol, names[v], tile_time[v], tile_runs[v]);
+            printf("分块布局读取校验: %s\n", mismatched ? "[失败]" : "[通过]");
+            printf("=============================\n\n");
+        } else {
+            printf("Error: Failed to allocate panel buffers\n");
+        }
+        pool_free(panel, panel_bytes);
+        pool_free(tpanel, panel_bytes);
+        pool_free(tile_buf, (size_t)(tr * tc * sizeof(double)));
+    }
+
+    // === 13. 海量小数据集 ===
+    printf("13. 海量小数据集 (默认文件配置 + 逐个请求 vs 多数据集配置 + 批量创建/打开)\n");
+    {
+        int many_count = cfg.many[0], mismatched = 0;
+        many_stats_t ws[NUM_FILE_PROFILES], rs[NUM_FILE_PROFILES];
+        char filename[64];
+        for (int p = 0; p < NUM_FILE_PROFILES; p++) {
+            snprintf(filename, sizeof(filename), "many_%s.h5", file_profiles[p].name);
+            if (many_write_hdf5(filename, many_count, cfg.many_size, &file_profiles[p], &ws[p]) < 0 ||
+                many_read_hdf5(filename, cfg.many_size, &file_profiles[p], &rs[p]) < 0 ||
+                rs[p].mismatched || rs[p].datasets != many_count) {
+                mismatched++;
+                memset(&rs[p], 0, sizeof(rs[p]));
+            }
+        }
+
+        printf("\n=== 海量小数据集 性能统计 ===\n");
+        printf("数据集: %d 个 %dx%d\n", many_count, cfg.many_size, cfg.many_size);
+        for (int p = 0; p < NUM_FILE_PROFILES; p++) {
+            char label[64];
+            snprintf(label, sizeof(label), "%s (批大小 %d)", file_profiles[p].name, file_profiles[p].batch);
+            print_many_stats(label, &ws[p], &rs[p]);
+        }
+        if (mismatched == 0)
+            printf("加速比 (many vs default): 写 %.2fx, 读 %.2fx\n", ws[0].total_time / ws[1].total_time,
+                   rs[0].total_time / rs[1].total_time);
+        printf("按索引表读取数据校验: %s\n", mismatched ? "[失败]" : "[通过]");
+        printf("=============================\n\n");
+    }
+
+    // === 14. 混合精度存储 ===
+    printf("14. 混合精度存储 (double 计算, 磁盘 f32/f16/bf16: 并行 SIMD 转换 vs 串行标量转换)\n");
+    {
+        // 读回误差上限：相对于最大元素的一个存储精度 ulp（f64 无损）
+        static const double ulp[PRECISION_COUNT] = {0.0, 0x1p-24, 0x1p-11, 0x1p-8};
+        precision_stats_t ws[PRECISION_COUNT], rs[PRECISION_COUNT];
+        double serial_write[PRECISION_COUNT], serial_read[PRECISION_COUNT];
+        double serial_err[PRECISION_COUNT];
+        int failed = 0;
+        double max_value = 0.0;
+        for (int i = 0; i < num_datasets; i++) {
+            matrix_checksum_t cs;
+            checksum_matrix(matrices[i], matrix_size, matrix_size, &cs);
+            max_value = fmax(max_value, fmax(fabs(cs.min), fabs(cs.max)));
+        }
+
+        for (int p = 0; p < PRECISION_COUNT; p++) {
+            char parallel_name[64], serial_name[64];
+            storage_precision_t detected = PRECISION_F64;
+            snprintf(parallel_name, sizeof(parallel_name), "precision_%s.h5", precision_info[p].name);
+            snprintf(serial_name, sizeof(serial_name), "precision_%s_serial.h5", precision_info[p].name);
+
+            start_time = omp_get_wtime();
+            serial_write_hdf5_precision(serial_name, matrices, matrix_size, num_datasets, (storage_precision_t)p);
+            serial_write[p] = omp_get_wtime() - start_time;
+            start_time = omp_get_wtime();
+            serial_read_hdf5(serial_name, matrices_copy, matrix_size, num_datasets);
+            serial_read[p] = omp_get_wtime() - start_time;
+            serial_err[p] = 0.0;
+            for (int i = 0; i < num_datasets; i++)
+                for (size_t k = 0; k < (size_t)matrix_size * matrix_size; k++)
+                    serial_err[p] = fmax(serial_err[p], fabs(matrices_copy[i][k] - matrices[i][k]));
+
+            if (parallel_write_hdf5_precision(parallel_name, matrices, matrix_size, num_datasets, chunk_size,
+                                              (storage_precision_t)p, &ws[p]) < 0 ||
+                parallel_read_hdf5_precision(parallel_name, matrices_copy, matrix_size, num_datasets, chunk_size,
+                                             matrices, &detected, &rs[p]) < 0 ||
+                detected != (storage_precision_t)p || rs[p].err.max_abs_err > ulp[p] * max_value ||
+                serial_err[p] > ulp[p] * max_value)
+                failed++;
+        }
+
+        printf("\n=== 混合精度存储 性能统计 ===\n");
+        printf("%-5s %10s %12s %12s %12s %12s %11s %11s %10s %11s\n", "精度", "存储(MB)", "并行写(s)",
+               "串行写(s)", "并行读(s)", "串行读(s)", "最大绝对误差", "最大相对误差", "RMS误差", "串行读误差");
+        for (int p = 0; p < PRECISION_COUNT && !failed; p++)
+            printf("%-5s %10.2f %12.4f %12.4f %12.4f %12.4f %11.3e %11.3e %10.3e %11.3e\n", precision_info[p].name,
+                   ws[p].stored_mb, ws[p].total_time, serial_write[p], rs[p].total_time, serial_read[p],
+                   rs[p].err.max_abs_err, rs[p].err.max_rel_err,
+                   rs[p].err.count > 0 ? sqrt(rs[p].err.sum_sq_err / rs[p].err.count) : 0.0, serial_err[p]);
+        if (!failed)
+            printf("SIMD 转换耗时: f32 写 %.4f / 读 %.4f 秒, f16 写 %.4f / 读 %.4f 秒 (%s)\n",
+                   ws[PRECISION_F32].convert_time, rs[PRECISION_F32].convert_time,
+                   ws[PRECISION_F16].convert_time, rs[PRECISION_F16].convert_time,
+                   f16c_supported() ? "F16C" : "软件转换");
+        printf("读回误差在存储精度范围内: %s\n", failed ? "[失败]" : "[通过]");
+        printf("=============================\n\n");
+    }
+
+    // === 15. 增量追加 ===
+    printf("15. 增量追加 (可扩展数据集: 生产者线程 -> 合并缓冲区 -> H5Dset_extent + 超平面写入)\n");
+    {
+        static const int batches[] = {APPEND_PRODUCER_ROWS, 256, APPEND_BATCH_ROWS};
+        long total_rows = (long)matrix_size * num_datasets;
+        long mismatched = 0;
+        int failed = 0;
+        append_stats_t ps[3], ss[3], sw;
+        for (int b = 0; b < 3; b++) {
+            long bad = 0;
+            if (parallel_append_hdf5("append_parallel.h5", matrices, matrix_size, num_datasets, batches[b], 0, &ps[b]) < 0 ||
+                verify_append_hdf5("append_parallel.h5", matrices, matrix_size, num_datasets, &bad) < 0 ||
+                serial_append_hdf5("append_serial.h5", matrices, matrix_size, num_datasets, batches[b], &ss[b]) < 0)
+                failed++;
+            mismatched += bad;
+        }
+
+        // SWMR：子进程作为读取方，在写入过程中以 H5F_ACC_SWMR_READ 追踪行数增长
+        char rows_arg[32];
+        snprintf(rows_arg, sizeof(rows_arg), "%ld", total_rows);
+        unlink("append_swmr.h5");
+        fflush(stdout);
+        pid_t tail_pid = fork();
+        if (tail_pid == 0) {
+            execl("/proc/self/exe", argv[0], "--tail", "append_swmr.h5", "--tail-rows", rows_arg, (char*)NULL);
+            _exit(127);
+        }
+        int tail_status = -1;
+        if (parallel_append_hdf5("append_swmr.h5", matrices, matrix_size, num_datasets, APPEND_CHUNK_ROWS, 1, &sw) < 0)
+            failed++;
+        if (tail_pid < 0 || waitpid(tail_pid, &tail_status, 0) < 0 ||
+            !WIFEXITED(tail_status) || WEXITSTATUS(tail_status) != 0) {
+            printf("Error: SWMR tail reader failed\n");
+            failed++;
+        }
+
+        printf("\n=== 增量追加 性能统计 (%ld 行 x %d 列, 生产者每次提交 %d 行) ===\n",
+               total_rows, matrix_size, APPEND_PRODUCER_ROWS);
+        for (int b = 0; b < 3 && !failed; b++) {
+            print_append_stats("并行 (合并缓冲区)", &ps[b]);
+            print_append_stats("串行 (直接扩展+写入)", &ss[b]);
+        }
+        if (!failed)
+            print_append_stats("并行 + SWMR", &sw);
+        printf("追加行与源数据一致 (与顺序无关), SWMR 读取方跟踪到全部行: %s\n",
+               !failed && mismatched == 0 ? "[通过]" : "[失败]");
+        printf("=============================\n\n");
+    }
+
+    // === 16. 分片写入 + 虚拟数据集 ===
+    printf("16. 分片写入 (每个分片独立文件/进程, 主文件用虚拟数据集拼接)\n");
+    {
+        shard_stats_t sst[2];
+        int failed = 0;
+        start_time = omp_get_wtime();
+        parallel_write_hdf5("shard_baseline.h5", matrices, matrix_size, num_datasets);
+        double single_time = omp_get_wtime() - start_time;
+        for (int m = 0; m < 2; m++) {
+            const char *name = m == SHARD_THREADS ? "sharded_threads.h5" : "sharded_data.h5";
+            if (sharded_write_hdf5(name, matrices, matrix_size, num_datasets, 0, chunk_size,
+                                   (shard_mode_t)m, &sst[m]) < 0)
+                failed++;
+        }
+
+        // 读取方不需要知道分片：serial_read_hdf5 / 流式校验直接读虚拟数据集
+        int mismatched = 0;
+        for (int i = 0; i < num_datasets; i++)
+            matrix_clear(matrices_copy[i], matrix_size, matrix_size);
+        start_time = omp_get_wtime();
+        serial_read_hdf5("sharded_data.h5", matrices_copy, matrix_size, num_datasets);
+        double read_time = omp_get_wtime() - start_time;
+        for (int i = 0; i < num_datasets; i++) {
+            matrix_checksum_t computed, stored;
+            char dataset_name[50];
+            sprintf(dataset_name, "/matrix_%d", i);
+            if (memcmp(matrices[i], matrices_copy[i], (size_t)matrix_size * matrix_size * sizeof(double)) != 0 ||
+                checksum_dataset_hdf5("sharded_threads.h5", dataset_name, matrix_size, chunk_size,
+                                      &computed, &stored) < 0 || !checksum_equal(&computed, &stored))
+                mismatched++;
+        }
+
+        printf("\n=== 分片写入 性能统计 (%.2f MB) ===\n", total_data_mb);
+        printf("单文件并行写入: %.4f 秒 (%.2f MB/s)\n", single_time, total_data_mb / single_time);
+        if (!failed) {
+            print_shard_stats("分片写入 (线程)", &sst[SHARD_THREADS]);
+            print_shard_stats("分片写入 (进程)", &sst[SHARD_PROCESSES]);
+        }
+        printf("串行读取虚拟数据集: %.4f 秒 (%.2f MB/s)\n", read_time, total_data_mb / read_time);
+        printf("虚拟数据集读回与源矩阵逐位一致, 校验和属性一致: %s\n",
+               !failed && mismatched == 0 ? "[通过]" : "[失败]");
+        printf("=============================\n\n");
+    }
+
+    // === 17. 惰性表达式融合求值 ===
+    printf("17. 惰性表达式 (逐块融合求值 vs 逐算子物化中间结果)\n");
+    {
+        static const char *input_names[3] = {"/matrix_0", "/matrix_1", "/matrix_2"};
+        static const char *result_names[EXPR_DEMO_COUNT][2] = {
+            {"/expr_axpy", "/expr_axpy_unfused"}, {"/expr_colnorm", "/expr_colnorm_unfused"}
+        };
+        const double alpha = 2.5;
+        int b_index = num_datasets > 1 ? 1 : 0, c_index = num_datasets > 2 ? 2 : 0;
+        expr_stats_t est[EXPR_DEMO_COUNT][2];
+        double max_err[EXPR_DEMO_COUNT] = {0};
+        double *result = matrix_alloc(matrix_size, matrix_size);
+        int failed = result ? 0 : 1;
+        for (int x = 0; !failed && x < EXPR_DEMO_COUNT; x++) {
+            expr_t e;
+            int root = expr_build_demo(&e, (expr_demo_t)x, input_names[0], input_names[b_index],
+                                       input_names[c_index], alpha);
+            if (expr_eval_hdf5("parallel_data.h5", &e, root, result_names[x][0], chunk_size, &est[x][0]) < 0 ||
+                expr_eval_unfused_hdf5("parallel_data.h5", &e, root, result_names[x][1], &est[x][1]) < 0) {
+                failed++;
+                continue;
+            }
+            // 两种求值结果都与内存中直接计算的结果比对
+            expr_reference_demo((expr_demo_t)x, matrices[0], matrices[b_index], matrices[c_index],
+                                matrix_size, alpha, matrices_copy[0]);
+            for (int v = 0; v < 2; v++) {
+                if (expr_read_result("parallel_data.h5", result_names[x][v], result, matrix_size, matrix_size) < 0) {
+                    failed++;
+                    break;
+                }
+                for (size_t k = 0; k < (size_t)matrix_size * matrix_size; k++)
+                    max_err[x] = fmax(max_err[x], fabs(result[k] - matrices_copy[0][k]));
+            }
+        }
+        matrix_free(result, matrix_size, matrix_size);
+
+        printf("\n=== 惰性表达式 性能统计 ===\n");
+        for (int x = 0; !failed && x < EXPR_DEMO_COUNT; x++) {
+            printf("%s: %s\n", expr_demo_names[x],
+                   x == EXPR_DEMO_AXPY ? "alpha * A + B .* C" : "A ./ sqrt(col_sum(A .* A))");
+            print_expr_stats("  融合求值", &est[x][0]);
+            print_expr_stats("  逐算子求值", &est[x][1]);
+            printf("  搬运量降低: %.2fx, 加速比: %.2fx, 与直接计算的最大绝对误差: %.3e\n",
+                   est[x][1].bytes_moved / est[x][0].bytes_moved, est[x][1].total_time / est[x][0].total_time,
+                   max_err[x]);
+        }
+        printf("表达式结果校验: %s\n", !failed && max_err[0] <= 1e-12 && max_err[1] <= 1e-12 ? "[通过]" : "[失败]");
+        printf("=============================\n\n");
+    }
+
+    // === 18. 稀疏矩阵 CSR 存储 ===
+    printf("18. 稀疏矩阵 (CSR 存储 %s/matrix_i/{indptr,indices,values} vs 稠密存储, 密度 %.2f%%)\n",
+           CSR_GROUP, CSR_DENSITY * 100);
+    {
+        int k = matrix_size < SPMM_COLS ? matrix_size : SPMM_COLS;
+        double *sparse = matrix_alloc(matrix_size, matrix_size);
+        double *x = (double*)malloc((size_t)matrix_size * sizeof(double));
+        double *y[2] = {(double*)malloc((size_t)matrix_size * sizeof(double)),
+                        (double*)malloc((size_t)matrix_size * sizeof(double))};
+        double *C[2] = {matrix_alloc(matrix_size, k), matrix_alloc(matrix_size, k)};
+        csr_matrix_t csr = {0}, csr_serial, csr_read;
+        csr_stats_t wst, rst;
+        struct stat sb;
+        int failed = !sparse || !x || !y[0] || !y[1] || !C[0] || !C[1];
+        double t_conv[2] = {0}, t_write[2] = {0}, t_read[2] = {0}, t_spmv[3] = {0}, t_spmm[2] = {0};
+        double size_mb[2] = {0}, max_err[2] = {0};
+        int csr_ok = 0, gemm_ok = 1;
+        long long nnz = 0;
+
+        if (!failed) {
+            init_matrix_sparse(sparse, matrix_size, 0, CSR_DENSITY);
+            philox_fill_row(x, RNG_SEED, 0x7fffffffu, 0, matrix_size);
+
+            start_time = omp_get_wtime();
+            failed = dense_to_csr_parallel(sparse, matrix_size, matrix_size, &csr) < 0;
+            t_conv[0] = omp_get_wtime() - start_time;
+            nnz = csr.nnz;
+            start_time = omp_get_wtime();
+            if (!failed && dense_to_csr_serial(sparse, matrix_size, matrix_size, &csr_serial) == 0) {
+                t_conv[1] = omp_get_wtime() - start_time;
+                csr_ok = csr_equal(&csr, &csr_serial);
+                csr_free(&csr_serial);
+            }
+        }
+        if (!failed) {
+            // 存储与 I/O：同一个矩阵分别以稠密和 CSR 形式写入、读回
+            start_time = omp_get_wtime();
+            parallel_write_hdf5("sparse_dense.h5", &sparse, matrix_size, 1);
+            t_write[0] = omp_get_wtime() - start_time;
+            failed = csr_write_hdf5("sparse_csr.h5", &csr, 1, &wst) < 0;
+            t_write[1] = wst.total_time;
+            size_mb[0] = stat("sparse_dense.h5", &sb) == 0 ? sb.st_size / (1024.0 * 1024) : 0.0;
+            size_mb[1] = stat("sparse_csr.h5", &sb) == 0 ? sb.st_size / (1024.0 * 1024) : 0.0;
+
+            start_time = omp_get_wtime();
+            parallel_read_hdf5("sparse_dense.h5", matrices_copy, matrix_size, 1, chunk_size);
+            t_read[0] = omp_get_wtime() - start_time;
+            if (!failed && csr_read_hdf5("sparse_csr.h5", 0, &csr_read, 0, &rst) == 0) {
+                t_read[1] = rst.total_time;
+                csr_ok = csr_ok && csr_equal(&csr, &csr_read) &&
+                         memcmp(sparse, matrices_copy[0], (size_t)matrix_size * matrix_size * sizeof(double)) == 0;
+                csr_free(&csr_read);
+            } else {
+                failed = 1;
+            }
+        }
+        if (!failed) {
+            // 乘法：稠密 GEMV / GEMM 与 CSR SpMV / SpMM 对比，右端取第一个矩阵的前 k 列数据
+            start_time = omp_get_wtime();
+            dense_matvec_parallel(sparse, matrix_size, matrix_size, x, y[0]);
+            t_spmv[0] = omp_get_wtime() - start_time;
+            start_time = omp_get_wtime();
+            spmv_csr_parallel(&csr, x, y[1]);
+            t_spmv[1] = omp_get_wtime() - start_time;
+            for (int i = 0; i < matrix_size; i++)
+                max_err[0] = fmax(max_err[0], fabs(y[0][i] - y[1][i]));
+            start_time = omp_get_wtime();
+            spmv_csr_serial(&csr, x, y[1]);
+            t_spmv[2] = omp_get_wtime() - start_time;
+            for (int i = 0; i < matrix_size; i++)
+                max_err[0] = fmax(max_err[0], fabs(y[0][i] - y[1][i]));
+
+            matrix_zero(C[0], matrix_size, k);
+            start_time = omp_get_wtime();
+            gemm_ok = gemm_blocked(matrix_size, k, matrix_size, sparse, matrix_size, matrices[0], k, C[0], k) == 0;
+            t_spmm[0] = omp_get_wtime() - start_time;
+            start_time = omp_get_wtime();
+            spmm_csr_parallel(&csr, matrices[0], k, C[1]);
+            t_spmm[1] = omp_get_wtime() - start_time;
+            for (size_t i = 0; i < (size_t)matrix_size * k; i++)
+                max_err[1] = fmax(max_err[1], fabs(C[0][i] - C[1][i]));
+        }
+        csr_free(&csr);
+
+        printf("\n=== 稀疏矩阵 性能统计 ===\n");
+        if (!failed) {
+            double dense_mb = (double)matrix_size * matrix_size * sizeof(double) / (1024 * 1024);
+            printf("非零元素: %lld (实际密度 %.3f%%), CSR 数组 %.2f MB, 稠密 %.2f MB\n", nnz,
+                   100.0 * nnz / ((double)matrix_size * matrix_size), wst.stored_bytes / (1024 * 1024), dense_mb);
+            printf("稠密 -> CSR 转换: 并行 %.4f 秒, 串行 %.4f 秒, 加速比 %.2fx\n", t_conv[0], t_conv[1],
+                   t_conv[1] / t_conv[0]);
+            printf("文件大小: 稠密 %.2f MB, CSR %.2f MB (%.1fx)\n", size_mb[0], size_mb[1], size_mb[0] / size_mb[1]);
+            printf("写入: 稠密 %.4f 秒, CSR %.4f 秒 (%.1fx)\n", t_write[0], t_write[1], t_write[0] / t_write[1]);
+            printf("读取: 稠密 %.4f 秒, CSR %.4f 秒 (%.1fx, 按非零数划分行并行读取)\n", t_read[0], t_read[1],
+                   t_read[0] / t_read[1]);
+            printf("SpMV: 稠密 %.4f 秒, CSR 并行 %.4f 秒 (%.1fx), CSR 串行 %.4f 秒\n", t_spmv[0], t_spmv[1],
+                   t_spmv[0] / t_spmv[1], t_spmv[2]);
+            printf("SpMM (%d 列): 稠密 GEMM %.4f 秒, CSR %.4f 秒 (%.1fx)\n", k, t_spmm[0], t_spmm[1],
+                   t_spmm[0] / t_spmm[1]);
+            printf("最大绝对误差: SpMV %.3e, SpMM %.3e\n", max_err[0], max_err[1]);
+        }
+        printf("CSR 转换/读回逐位一致, 乘法结果与稠密计算一致: %s\n",
+               !failed && csr_ok && gemm_ok && max_err[0] <= 1e-9 && max_err[1] <= 1e-9 ? "[通过]" : "[失败]");
+        printf("=============================\n\n");
+        matrix_free(sparse, matrix_size, matrix_size);
+        matrix_free(C[0], matrix_size, k);
+        matrix_free(C[1], matrix_size, k);
+        free(x);
+        free(y[0]);
+        free(y[1]);
+    }
+
+    // === 19. 文件驱动：sec2 vs io_uring（带缓存 / O_DIRECT） ===
+    printf("19. 文件驱动 (sec2 vs io_uring vs io_uring + O_DIRECT, 队列深度 %u, 段 %u KB, 对齐 %d 字节)\n",
+           cfg.queue_depth, URING_SEGMENT >> 10, URING_ALIGN);
+    {
+        static const char *vfd_files[VFD_COUNT] = {"vfd_sec2.h5", "vfd_uring.h5", "vfd_uring-direct.h5"};
+        double t_write[VFD_COUNT] = {0}, t_sync[VFD_COUNT] = {0}, t_read[VFD_COUNT] = {0};
+        double cached[VFD_COUNT][2] = {{0}};
+        uring_stats_t vst[VFD_COUNT];
+        int vfd_ok[VFD_COUNT] = {0};
+
+        for (int v = 0; v < VFD_COUNT; v++) {
+            if (set_file_driver((vfd_mode_t)v, cfg.queue_depth) < 0)
+                continue;
+            uring_stats_reset();
+            start_time = omp_get_wtime();
+            parallel_write_hdf5(vfd_files[v], matrices, matrix_size, num_datasets);
+            t_write[v] = omp_get_wtime() - start_time;
+            cached[v][0] = file_cached_fraction(vfd_files[v]);
+            // 落盘并逐出页缓存，读取阶段对三种驱动都是冷读
+            start_time = omp_get_wtime();
+            file_drop_cache(vfd_files[v]);
+            t_sync[v] = omp_get_wtime() - start_time;
+
+            for (int i = 0; i < num_datasets; i++)
+                matrix_clear(matrices_copy[i], matrix_size, matrix_size);
+            start_time = omp_get_wtime();
+            parallel_read_hdf5(vfd_files[v], matrices_copy, matrix_size, num_datasets, chunk_size);
+            t_read[v] = omp_get_wtime() - start_time;
+            cached[v][1] = file_cached_fraction(vfd_files[v]);
+            vst[v] = uring_stats;
+
+            vfd_ok[v] = 1;
+            for (int i = 0; i < num_datasets; i++)
+                vfd_ok[v] = vfd_ok[v] && memcmp(matrices[i], matrices_copy[i],
+                                                (size_t)matrix_size * matrix_size * sizeof(double)) == 0;
+        }
+        set_file_driver(cfg.vfds[0], cfg.queue_depth);
+
+        printf("\n=== 文件驱动 性能统计 ===\n");
+        for (int v = 0; v < VFD_COUNT; v++) {
+            printf("%-12s: 写入 %.4f 秒 (%.2f MB/s), 落盘 %.4f 秒, 冷读 %.4f 秒 (%.2f MB/s), "
+                   "页缓存驻留 写后 %.0f%% / 读后 %.0f%% %s\n", vfd_names[v], t_write[v], total_data_mb / t_write[v],
+                   t_sync[v], t_read[v], total_data_mb / t_read[v], cached[v][0] * 100, cached[v][1] * 100,
+                   vfd_ok[v] ? "[一致]" : "[不一致]");
+            if (v != VFD_SEC2 && vfd_ok[v])
+                printf("%-12s  请求 %ld 个 (io_uring_enter %ld 次, 同步 %ld 次), 最大在途 %u, "
+                       "读 %.2f MB, 写 %.2f MB, 中转复制 %.2f MB\n", "", vst[v].requests, vst[v].enters,
+                       vst[v].sync_ops, vst[v].max_inflight, vst[v].bytes_read / (1024 * 1024),
+                       vst[v].bytes_written / (1024 * 1024), vst[v].bounce_bytes / (1024 * 1024));
+        }
+        printf("=============================\n\n");
+    }
+
     // 释放内存
     printf("\n清理内存资源...\n");
-    for (int i = 0; i < NUM_DATASETS; i++) {
-        free(matrices[i]);
-        free(matrices_copy[i]);
+    hdf5_io_stop();
+    set_file_driver(VFD_SEC2, 0);
+    if (cfg.trace) {
+        trace_report();
+        trace_export(cfg.trace);
+    }
+    for (int i = 0; i < num_datasets; i++) {
+        matrix_free(matrices[i], matrix_size, matrix_size);
+        matrix_free(matrices_copy[i], matrix_size, matrix_size);
     }
     free(matrices);
     free(matrices_copy);
+    print_pool_stats();
+    pool_trim();
     
     printf("程序执行完成！生成的文件：\n");
-    printf("  - parallel_data.h5 (并行写入)\n");
+    printf("  - parallel_data.h5 (并行写入，含核外乘法结果 /matrix_product 与表达式结果 /expr_*)\n");
     printf("  - serial_data.h5 (串行写入)\n");
+    printf("  - parallel_compressed.h5 / serial_compressed.h5 (分块压缩布局)\n");
+    printf("  - phased_data.h5 / pipelined_data.h5 (分阶段/流水线写入)\n");
+    printf("  - many_default.h5 / many_many.h5 / many_many-latest.h5 (海量小数据集，索引表 /many_index)\n");
+    printf("  - precision_{f64,f32,f16,bf16}[_serial].h5 (混合精度存储)\n");
+    printf("  - append_parallel.h5 / append_serial.h5 / append_swmr.h5 (可扩展数据集追加)\n");
+    printf("  - sharded_data.h5 / sharded_threads.h5 + *_shard<N>.h5 (虚拟数据集与分片文件), shard_baseline.h5\n");
+    printf("  - sparse_dense.h5 / sparse_csr.h5 (稀疏矩阵的稠密存储与 CSR 存储 /csr/matrix_0)\n");
+    printf("  - vfd_sec2.h5 / vfd_uring.h5 / vfd_uring-direct.h5 (不同文件驱动写入的同一组矩阵)\n");
+    printf("  - parallel_tiled.h5 (Z-order 分块 + 转置副本 /matrix_i_T + 分块索引 /matrix_i_tile_index)\n");
     printf("建议使用 'h5ls -v filename.h5' 查看文件结构\n");
     
-    return 0;
+    return demo_exit(0);
 }
\ No newline at end of file